@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// ----------------------------------------------------
+// Counts every heap allocation of the program by replacing the global
+// operator new/delete. Include it from the tool's main .cpp only: the
+// replacement must exist once per executable.
+// ----------------------------------------------------
+inline std::atomic<uint64_t>& heapAllocations() {
+    static std::atomic<uint64_t> count{0};
+    return count;
+}
+
+// Kept out of line: once inlined, GCC sees malloc()/free() paired with
+// operator new/delete and reports a mismatched new/delete
+#if defined(__GNUC__)
+#define ALLOC_COUNTER_NOINLINE __attribute__((noinline))
+#else
+#define ALLOC_COUNTER_NOINLINE
+#endif
+
+ALLOC_COUNTER_NOINLINE void* operator new(std::size_t size) {
+    heapAllocations().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+ALLOC_COUNTER_NOINLINE void* operator new[](std::size_t size) {
+    heapAllocations().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+ALLOC_COUNTER_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+ALLOC_COUNTER_NOINLINE void operator delete[](void* p) noexcept { std::free(p); }
+ALLOC_COUNTER_NOINLINE void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+ALLOC_COUNTER_NOINLINE void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "memory_usage.h"
+#include "unicode_text.h"
+
+// Prefix trie behind auto_complete, shared with the benchmark suite
+
+// --- 1. The Building Block: A Node in the Tree ---
+struct TrieNode {
+    std::unordered_map<char, TrieNode*> next_letters;
+    bool marks_end_of_a_word; 
+    TrieNode() : marks_end_of_a_word(false) {}
+    ~TrieNode() {
+        for (auto const& [character, pointer_to_child] : next_letters) {
+            delete pointer_to_child; 
+        }
+    }
+};
+
+// --- 2. The Autocomplete Engine (Trie Class) ---
+class AutocompleteEngine {
+private:
+    TrieNode* root_node;
+    bool strip_accents;     // the lexicon's, so prefixes fold like its words
+
+    void collectAllWords(TrieNode* start_node, std::string current_word_so_far, std::vector<std::string>& found_results, size_t max_limit) const {
+        if (found_results.size() >= max_limit) {
+            return;
+        }
+        
+        if (start_node->marks_end_of_a_word) {
+            found_results.push_back(current_word_so_far);
+        }
+
+        // Use map to ensure alphabetical order in suggestions (nice feature, not essential for speed)
+        std::map<char, TrieNode*> sorted_children(start_node->next_letters.begin(), start_node->next_letters.end());
+
+        for (auto const& [next_char, child_node] : sorted_children) {
+            collectAllWords(
+                child_node, 
+                current_word_so_far + next_char, 
+                found_results, 
+                max_limit
+            );
+        }
+    }
+
+public:
+    explicit AutocompleteEngine(bool stripAccents = false) : strip_accents(stripAccents) {
+        root_node = new TrieNode();
+    }
+
+    ~AutocompleteEngine() {
+        delete root_node;
+    }
+
+    // Every node with its child map; the trie is walked, so this is O(nodes)
+    uint64_t memoryBytes() const {
+        uint64_t total = 0;
+        std::vector<const TrieNode*> pending{root_node};
+        while (!pending.empty()) {
+            const TrieNode* node = pending.back();
+            pending.pop_back();
+            total += sizeof(TrieNode) + heapBytes(node->next_letters);
+            for (auto const& [character, child] : node->next_letters) pending.push_back(child);
+        }
+        return total;
+    }
+
+    void addWordToLexicon(const std::string& word) {
+        TrieNode* current_position = root_node;
+        
+        // Folded like the tokenizer folds words, byte by byte down the trie
+        for (char character : foldText(word, strip_accents)) {
+            if (current_position->next_letters.find(character) == current_position->next_letters.end()) {
+                current_position->next_letters[character] = new TrieNode();
+            }
+            
+            current_position = current_position->next_letters[character];
+        }
+        
+        current_position->marks_end_of_a_word = true;
+    }
+
+    // const, so any number of threads may ask at once once the words are in
+    std::vector<std::string> getSuggestions(const std::string& user_prefix, size_t max_suggestions = 5) const {
+        std::vector<std::string> results;
+        std::string normalized_prefix = foldText(user_prefix, strip_accents);
+
+        TrieNode* current_position = root_node;
+
+        // 1. Traverse to the prefix node
+        for (char character : normalized_prefix) {
+            auto next = current_position->next_letters.find(character);
+            if (next == current_position->next_letters.end()) {
+                return results; // Prefix not found
+            }
+            current_position = next->second;
+        }
+
+        // 2. Collect all words below the prefix node
+        collectAllWords(
+            current_position, 
+            normalized_prefix, 
+            results, 
+            max_suggestions
+        );
+        
+        return results;
+    }
+};
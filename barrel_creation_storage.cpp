@@ -4,7 +4,17 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
 #include "nlohmann/json.hpp"
+#include "index_files.h"
+#include "bounded_queue.h"
+#include "stream_writer.h"
+#include "mapped_file.h"
+#include "inverted_index_sax.h"
+#include "memory_usage.h"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
@@ -12,89 +22,122 @@ namespace fs = std::filesystem;
 // -------------------- Load Barrel Mapping --------------------
 std::unordered_map<int,int> loadBarrelMapping(const std::string& mapFile)
 {
-    std::ifstream fin(mapFile);
-    if(!fin){
-        std::cerr << "ERROR: Cannot open barrel mapping file\n";
+    std::unordered_map<int,int> barrelMap;
+    std::string error;
+    if(!loadBarrelMapping(mapFile, barrelMap, error)){
+        std::cerr << "ERROR: " << error << "\n";
         exit(1);
     }
-
-    json mapJson;
-    fin >> mapJson;
-    fin.close();
-
-    std::unordered_map<int,int> barrelMap;
-
-    for(auto& [lexID, barrelID] : mapJson.items())
-        barrelMap[std::stoi(lexID)] = barrelID;
-
     return barrelMap;
 }
 
 
-// -------------------- Load Inverted Index --------------------
-json loadInvertedIndex(const std::string& invFile)
-{
-    std::ifstream fin(invFile);
-
-    if(!fin){
-        std::cerr << "ERROR: Cannot open inverted index file\n";
-        exit(1);
-    }
-
-    json invJson;
-    fin >> invJson;
-    fin.close();
-
-    return invJson;
-}
-
+static const size_t BARREL_WRITE_BUFFER = 256 * 1024;
 
 // -------------------- Create Barrel Files --------------------
-void buildBarrels(
-    const json& invertedIndex,
+// The reader routes every term to its barrel's bounded queue; one writer
+// thread per barrel encodes and flushes that barrel on its own. Memory is
+// bounded by the queues (queueTerms records per barrel) plus one write
+// buffer per barrel, not by the size of the index.
+bool buildBarrels(
+    const std::string& invertedFile,
     const std::unordered_map<int,int>& barrelMap,
-    const std::string& outDir)
+    const std::string& outDir,
+    OutputFormat format,
+    size_t queueTerms)
 {
     fs::create_directories(outDir);
 
-    std::vector<json> barrels(32);   // 32 total barrels
-
-    // Iterate through inverted index
-    for(auto& [lexIDstr, docList] : invertedIndex.items())
-    {
-        int lexID = std::stoi(lexIDstr);
-
-        auto it = barrelMap.find(lexID);
-        if(it == barrelMap.end())
-            continue;
-
-        int barrelID = it->second;
-
-        // Store word's posting list inside its barrel
-        barrels[barrelID][lexIDstr] = docList;
+    // Mapped, so the parser reads straight from the page cache; pages it
+    // has passed are clean and cost no heap
+    MappedFile in;
+    if(!in.open(invertedFile)){
+        std::cerr << "ERROR: Cannot open inverted index file\n";
+        return false;
     }
+    // build_inverted_index --binary writes a MessagePack map
+    unsigned char first = in.size() ? static_cast<unsigned char>(in.data()[0]) : 0;
+    bool msgpack = (first & 0xF0) == 0x80 || first == 0xde || first == 0xdf;
+
+    struct Barrel {
+        BoundedQueue<TermRecord> queue;
+        uint64_t terms = 0;
+        uint64_t bytes = 0;
+        bool ok = true;
+        explicit Barrel(size_t capacity) : queue(capacity) {}
+    };
+    std::vector<std::unique_ptr<Barrel>> barrels;
+    for(int i = 0; i < BARREL_COUNT; i++) barrels.push_back(std::make_unique<Barrel>(queueTerms));
+
+    auto writeBarrel = [&](int i) {
+        Barrel& barrel = *barrels[i];
+        std::string filename = outDir + "/barrel_" + std::to_string(i) + ".json";
+        BufferedWriter out(BARREL_WRITE_BUFFER);
+        barrel.ok = out.open(filename);
+
+        RecordWriter writer(out, format);
+        writer.beginObject();
+        TermRecord term;
+        while(barrel.queue.pop(term)){
+            if(!barrel.ok) continue; // keep draining so the reader never blocks
+            writer.key(term.lexID);
+            writer.beginObject();
+            for(auto& [docID, freq] : term.postings){
+                writer.key(docID);
+                writer.value(freq);
+            }
+            writer.endObject();
+            barrel.terms++;
+        }
+        writer.endObject();
+        barrel.bytes = out.bytesWritten();
+        barrel.ok = out.close() && barrel.ok;
+    };
+
+    std::vector<std::thread> writers;
+    for(int i = 0; i < BARREL_COUNT; i++) writers.emplace_back(writeBarrel, i);
+
+    uint64_t unmapped = 0;
+    auto route = [&](TermRecord& term) {
+        auto it = barrelMap.find(term.lexID);
+        if(it == barrelMap.end() || it->second < 0 || it->second >= BARREL_COUNT){
+            unmapped++;
+            return true;
+        }
+        barrels[it->second]->queue.push(std::move(term));
+        term = TermRecord();
+        return true;
+    };
+    InvertedIndexSax<decltype(route)> sax(route);
+    bool parsed = json::sax_parse(in.data(), in.data() + in.size(), &sax,
+                                  msgpack ? json::input_format_t::msgpack : json::input_format_t::json);
+
+    for(auto& b : barrels) b->queue.close();
+    for(auto& t : writers) t.join();
+
+    if(!parsed){
+        std::cerr << "ERROR: " << (sax.error.empty() ? "Cannot parse " + invertedFile : sax.error) << "\n";
+        return false;
+    }
+    std::cout << "Streamed inverted index: " << sax.terms << " terms, "
+              << sax.postings << " postings"
+              << (unmapped ? " (" + std::to_string(unmapped) + " terms without a barrel skipped)" : "")
+              << "\n";
 
-    // Save barrel files
-    for(int i = 0; i < 32; i++)
+    bool ok = true;
+    for(int i = 0; i < BARREL_COUNT; i++)
     {
-        std::string filename =
-            outDir + "/barrel_" + std::to_string(i) + ".json";
-
-        std::ofstream fout(filename);
-
-        if(!fout){
-            std::cerr << "ERROR: Cannot write " << filename << "\n";
+        if(!barrels[i]->ok){
+            std::cerr << "ERROR: Cannot write " << outDir << "/barrel_" << i << ".json\n";
+            ok = false;
             continue;
         }
-
-        fout << barrels[i].dump(4);
-        fout.close();
-
         std::cout << "✓ Barrel " << i
                   << " saved with "
-                  << barrels[i].size()
-                  << " terms\n";
+                  << barrels[i]->terms
+                  << " terms (" << barrels[i]->bytes << " bytes)\n";
     }
+    return ok;
 }
 
 
@@ -105,30 +148,70 @@ int main(int argc, char* argv[])
         std::cout << "Usage: member2_barrel_builder "
                   << "<inverted_index.json> "
                   << "<barrel_mapping.json> "
-                  << "<output_dir>\n";
+                  << "<output_dir> [--compact] [--queue <terms per barrel>]\n"
+                  << "       [--memory-budget <MB>] [--memory-report]\n";
         return 1;
     }
 
     std::string invertedFile = argv[1];
     std::string mapFile      = argv[2];
     std::string outputDir   = argv[3];
+    OutputFormat format      = parseOutputFormat(argc, argv, 4);
+    size_t queueTerms        = 256;
+    uint64_t memoryBudget    = 0;
+    bool memoryReport        = false;
+    for(int i = 4; i < argc; i++){
+        std::string opt = argv[i];
+        if(opt == "--queue" && i + 1 < argc) queueTerms = std::max(1, std::stoi(argv[++i]));
+        else if(opt == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if(opt == "--memory-report") memoryReport = true;
+    }
+    MemoryReport memory(memoryReport, memoryBudget);
+    // Barrels are read back with json::parse
+    if(format == OutputFormat::MsgPack){
+        std::cerr << "ERROR: Barrels are JSON; use --compact for the smaller encoding\n";
+        return 1;
+    }
 
-    // Load data
-    json invertedIndex = loadInvertedIndex(invertedFile);
-    auto barrelMap     = loadBarrelMapping(mapFile);
-
-    std::cout << "Loaded inverted index: "
-              << invertedIndex.size()
-              << " terms\n";
+    auto barrelMap = loadBarrelMapping(mapFile);
 
     std::cout << "Loaded barrel mapping: "
               << barrelMap.size()
               << " terms\n";
+    memory.structure("barrel mapping (unordered_map)", heapBytes(barrelMap));
+    memory.stage("load_mapping");
+
+    // -------------------- Queue depth under --memory-budget --------------------
+    // A queued term holds its postings, which take about as many bytes in
+    // memory as in the input text. The queues get what the budget leaves
+    // after the write buffers, shared by all barrels.
+    std::error_code ec;
+    uint64_t inputBytes = fs::file_size(invertedFile, ec);
+    uint64_t termBytes = sizeof(TermRecord) + (ec || barrelMap.empty() ? 0 : inputBytes / barrelMap.size());
+    uint64_t buffers = uint64_t(BARREL_COUNT) * BARREL_WRITE_BUFFER;
+    if(memoryBudget){
+        uint64_t headroom = memoryHeadroom(memoryBudget);
+        size_t fits = headroom > buffers ? (headroom - buffers) / (BARREL_COUNT * termBytes) : 0;
+        if(fits < queueTerms){
+            queueTerms = std::max<size_t>(1, fits);
+            std::cout << "Memory budget " << formatBytes(memoryBudget) << ": queues hold "
+                      << queueTerms << " terms per barrel\n";
+        }
+    }
+    memory.structure("write buffers (" + std::to_string(BARREL_COUNT) + " barrels)", buffers);
+    memory.structure("queued terms (bound, average term)", uint64_t(BARREL_COUNT) * queueTerms * termBytes);
 
     // Build barrels
-    buildBarrels(invertedIndex, barrelMap, outputDir);
-
-    std::cout << "✅ Barrel generation complete.\n";
+    auto t0 = std::chrono::steady_clock::now();
+    if(!buildBarrels(invertedFile, barrelMap, outputDir, format, queueTerms)) return 1;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "✅ Barrel generation complete (" << ms << " ms, "
+              << BARREL_COUNT << " writer threads).\n";
+    memory.stage("build_barrels");
+    memory.print(std::cout);
+    memory.warnOverBudget();
 
     return 0;
 }
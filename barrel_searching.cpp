@@ -4,163 +4,429 @@
 #include <string>
 #include "nlohmann/json.hpp"
 #include <chrono> // Required for timing
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include "search_engine.h"
+#include "doc_store.h"
+#include "posting_containers.h"
+#include "ranking.h"
+#include "query_cache.h"
+#include "posting_io.h"
+#include "doc_attributes.h"
+#include "metrics.h"
+#include "local_socket.h"
+#include "index_files.h"
+#include "memory_usage.h"
 
 using json = nlohmann::json;
 
+// -------------------- Query path metrics --------------------
+// The per-stage lookup, barrel, parse, intersect and rank metrics are
+// registered by search_engine.h, where those stages run; these cover
+// what the tool adds around them
+static Counter& queriesTotal     = metrics().counter("search_queries_total", "Queries answered");
+static Counter& cacheHitsTotal   = metrics().counter("search_cache_hits_total", "Queries answered from the result cache");
+static Histogram& queryLatency   = metrics().histogram("search_query_seconds", "Whole query, printing included");
+static Histogram& formatLatency  = metrics().histogram("search_format_seconds", "Printing the results of a query");
+
 
 // ----------------------------------------------------
-// Load lexicon: word → lexID
+// Title, path and snippet of one result, when a document store is loaded
 // ----------------------------------------------------
-std::unordered_map<std::string, int> loadLexicon(const std::string& lexFile) {
-    std::ifstream fin(lexFile);
-    if(!fin) {
-        std::cerr << "ERROR: Cannot open lexicon file\n";
-        exit(1);
-    }
+void printDocument(uint32_t docID, const std::vector<std::string>& words, const DocStore* docs,
+                   bool stripAccents) {
+    if (!docs) return;
 
-    json lexJson;
-    fin >> lexJson;
-    fin.close();
+    // One path block and one text block per result
+    StoredDocument doc;
+    docs->fetch(docID, doc);
+    if (!doc.title.empty()) std::cout << "    Title:   " << doc.title << "\n";
+    std::cout << "    Path:    " << doc.path << "\n";
+    if (!doc.text.empty()) std::cout << "    Snippet: " << makeSnippet(doc.text, words, 200, stripAccents) << "\n";
+}
 
-    std::unordered_map<std::string, int> lexMap;
-    int id = 1;
+// ----------------------------------------------------
+// Print results; with a top-k limit the most frequent docs come first,
+// and with a document store each result gets its title, path and snippet
+// ----------------------------------------------------
+void printResults(
+    const std::vector<std::string>& words,
+    std::vector<Posting> results,
+    const DocStore* docs,
+    int topK,
+    bool stripAccents)
+{
+    if (topK > 0) {
+        std::stable_sort(results.begin(), results.end(),
+                         [](const Posting& a, const Posting& b) { return a.freq > b.freq; });
+        if ((int)results.size() > topK) results.resize(topK);
+    }
 
-    for (const auto& w : lexJson["lexicon"]) {
-        lexMap[w.get<std::string>()] = id++;
+    std::cout << "\n=== RESULTS ===\n";
+    for (const Posting& r : results) {
+        std::cout << "Doc " << r.docID << " (freq: " << r.freq << ")\n";
+        printDocument(r.docID, words, docs, stripAccents);
     }
-    return lexMap;
 }
 
 // ----------------------------------------------------
-// Load barrel mapping: lexID → barrelID
+// Print BM25-ranked results, best first
 // ----------------------------------------------------
-std::unordered_map<int, int> loadBarrelMapping(const std::string& mapFile) {
-    std::ifstream fin(mapFile);
-    if(!fin) {
-        std::cerr << "ERROR: Cannot open barrel mapping file\n";
-        exit(1);
+void printRanked(
+    const std::vector<std::string>& words,
+    const std::vector<ScoredDoc>& results,
+    const DocStore* docs,
+    bool stripAccents)
+{
+    std::cout << "\n=== RANKED RESULTS ===\n";
+    for (const ScoredDoc& r : results) {
+        std::cout << "Doc " << r.docID << " (score: " << r.score << ")\n";
+        printDocument(r.docID, words, docs, stripAccents);
     }
+}
 
-    json mapJson;
-    fin >> mapJson;
-    fin.close();
+// ----------------------------------------------------
+// One answered query, as kept in the result cache
+// ----------------------------------------------------
+struct SearchResult {
+    std::vector<Posting> matches;   // word / AND queries
+    std::vector<ScoredDoc> ranked;  // --ranked queries
+};
 
-    std::unordered_map<int, int> barrelMap;
-    for (auto& [lexID, barrelID] : mapJson.items())
-        barrelMap[std::stoi(lexID)] = barrelID;
+size_t resultBytes(const SearchResult& r) {
+    return sizeof(SearchResult) + r.matches.size() * sizeof(Posting) + r.ranked.size() * sizeof(ScoredDoc);
+}
+
+// Last modification time of a file, 0 if it cannot be read
+int64_t fileStamp(const std::string& path) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(path, ec);
+    return ec ? 0 : static_cast<int64_t>(t.time_since_epoch().count());
+}
 
-    return barrelMap;
+// Stamp of a JSON barrel index: the mapping and every barrel_N.json.
+// Barrels are rewritten in place, which leaves the directory's own mtime
+// alone, so each file's mtime (and name, for added or removed barrels)
+// is folded in. One stat per barrel, taken before each served query.
+int64_t barrelIndexStamp(const std::string& mappingFile, const std::string& barrelsDir) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+    mix(fileStamp(mappingFile));
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(barrelsDir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (name.compare(0, 7, "barrel_") != 0) continue;
+        mix(std::hash<std::string>()(name));
+        auto t = it->last_write_time(ec);
+        mix(ec ? 0 : t.time_since_epoch().count());
+        ec.clear();
+    }
+    return static_cast<int64_t>(h);
 }
 
 // ----------------------------------------------------
-// Load only ONE required barrel file
+// MAIN
 // ----------------------------------------------------
-json loadBarrel(const std::string& barrelsDir, int barrelID) {
-    std::string path = barrelsDir + "/barrel_" + std::to_string(barrelID) + ".json";
 
-    std::ifstream fin(path);
-    if(!fin) {
-        std::cerr << "ERROR: Cannot open barrel file " << path << "\n";
-        exit(1);
+int main(int argc, char* argv[]) {
+
+    // Options may appear anywhere after the word
+    std::vector<std::string> args;
+    std::string sharedFile, docStoreFile, attributesFile;
+    AttributeFilter attributeFilter;
+    int topK = 0;
+    bool ranked = false;
+    bool serve = false;
+    size_t cacheMB = 64;
+    uint64_t memoryBudget = 0;
+    bool memoryReport = false;
+    std::string metricsFile, listenSocket, filterError;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shared" && i + 1 < argc) sharedFile = argv[++i];
+        else if (arg == "--docs" && i + 1 < argc) docStoreFile = argv[++i];
+        else if (arg == "--top" && i + 1 < argc) topK = std::stoi(argv[++i]);
+        else if (arg == "--ranked") ranked = true;
+        else if (arg == "--serve") serve = true;
+        else if (arg == "--listen" && i + 1 < argc) { listenSocket = argv[++i]; serve = true; }
+        else if (arg == "--cache-mb" && i + 1 < argc) cacheMB = std::stoul(argv[++i]);
+        else if (arg == "--attrs" && i + 1 < argc) attributesFile = argv[++i];
+        else if (arg == "--metrics" && i + 1 < argc) metricsFile = argv[++i];
+        else if (arg == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if (arg == "--memory-report") memoryReport = true;
+        else if (attributeFilter.parse(argc, argv, i, filterError)) continue;
+        else args.push_back(arg);
     }
 
-    json barrel;
-    fin >> barrel;
-    fin.close();
-    return barrel;
-}
+    // In --serve mode queries come from stdin, so there is no word argument
+    size_t first = serve ? 0 : 1;
+    if (!filterError.empty()) std::cerr << "ERROR: " << filterError << "\n";
+    if (!filterError.empty() || (!serve && args.empty()) || (sharedFile.empty() && args.size() < first + 3)) {
+        std::cout << "Usage: search <word|\"word word ...\"> <lexicon.json> <barrel_mapping.json> <barrels_directory>\n";
+        std::cout << "       search <word|\"word word ...\"> --shared <search_index.bin> [--ranked]\n";
+        std::cout << "       search --serve [--cache-mb <n>] (<lexicon.json> <barrel_mapping.json> <barrels_directory> | --shared <search_index.bin>)\n";
+        std::cout << "       search --listen <socket> ...   as --serve, answering one query per line on a local socket\n";
+        std::cout << "       options: [--docs <docstore.bin>] [--top <k>] [--metrics <metrics.json|metrics.prom>]\n";
+        std::cout << "                [--memory-budget <MB>] [--memory-report]\n";
+        std::cout << "       filters: --attrs <docattrs.bin> [--ext <json|txt>] [--dir <subset>] [--year <y|from-to|from-|-to>]\n";
+        return 1;
+    }
 
-// ----------------------------------------------------
-// Search for a word
-// ----------------------------------------------------
-void searchWord(
-    const std::string& query,
-    const std::unordered_map<std::string, int>& lexMap,
-    const std::unordered_map<int, int>& barrelMap,
-    const std::string& barrelsDir)
-{
-    // STEP 1: map word → lexID
-    auto it = lexMap.find(query);
-    if (it == lexMap.end()) {
-        std::cout << "No results found. Word not in lexicon.\n";
-        return;
+    // -------------------- Attribute filter --------------------
+    // Built once as a bitset; the search kernels probe it while intersecting
+    DocAttributes attributes;
+    DocFilter docFilter;
+    const DocFilter* filter = nullptr;
+    if (!attributeFilter.empty()) {
+        std::string error;
+        if (attributesFile.empty()) error = "Filters need --attrs <docattrs.bin>";
+        else attributes.open(attributesFile, error);
+        if (!error.empty()) {
+            std::cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+        docFilter = attributes.buildFilter(attributeFilter);
+        filter = &docFilter;
+        std::cout << "Filter (" << attributeFilter.key() << ") allows " << docFilter.count() << " documents\n";
+    }
+
+    DocStore docStore;
+    const DocStore* docs = nullptr;
+    if (!docStoreFile.empty()) {
+        std::string error;
+        if (!docStore.open(docStoreFile, error)) {
+            std::cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+        docs = &docStore;
+        if (topK == 0) topK = 10; // snippets only for the best results
     }
+    if (ranked && topK == 0) topK = 10;
+
+    // -------------------- Index state --------------------
+    // The generation identifies the loaded index; a rebuilt index gets a
+    // new one, which empties the result cache
+    std::shared_ptr<SearchIndex> engine;     // --shared
+    std::shared_ptr<BarrelIndex> barrels;    // JSON barrels otherwise
+    bool stripAccents = false;  // how the loaded index folded its words; queries follow it
+    uint64_t generation = 0;
+    int64_t loadedStamp = -1;
+
+    // Loads the index when its files changed since the last attempt. On
+    // failure whatever was loaded before stays in place, and the same
+    // files are not retried until they change again.
+    auto indexStamp = [&]() {
+        return !sharedFile.empty() ? fileStamp(sharedFile) : barrelIndexStamp(args[first + 1], args[first + 2]);
+    };
+    auto loadIndex = [&]() -> bool {
+        int64_t stamp = indexStamp();
+        if (stamp == loadedStamp) return true;
+        loadedStamp = stamp;
 
-    // it->second holds the lexicon ID of the word and it->first is the word itself
-    int lexID = it->second;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        std::string error;
+        if (!sharedFile.empty()) {
+            // Attaching is just an mmap; the pages are shared with every other worker
+            auto fresh = SearchIndex::open(sharedFile, "", "", error);
+            if (!fresh) {
+                std::cerr << "ERROR: " << error << "\n";
+                return false;
+            }
+            engine = std::move(fresh);
+            generation = engine->generation();
+            stripAccents = engine->shared().stripAccents();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            std::cout << "Attached shared index (" << engine->shared().termCount() << " terms, "
+                      << engine->shared().mappedBytes() << " bytes) in "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+                      << " microseconds\n";
+        } else {
+            std::cout << "Loading lexicon and barrel mapping...\n";
+            auto fresh = BarrelIndex::open(args[first], args[first + 1], args[first + 2], error);
+            if (!fresh) {
+                std::cerr << "ERROR: " << error << "\n";
+                return false;
+            }
+            barrels = std::move(fresh);
+            stripAccents = barrels->stripAccents();
+            std::cout << "Data loaded.\n";
+            generation = stamp; // JSON barrels carry no generation; the mapping and barrel mtimes stand in
+        }
+        return true;
+    };
 
-    // STEP 2: get lexID → barrelID
-    int barrelID = barrelMap.at(lexID);
+    // -------------------- One query --------------------
+    // A multi-word query is an AND of its words unless --ranked (shared
+    // index only). The library keeps the top k, so the cache holds only
+    // what gets printed; documents are printed from --docs below.
+    bool queryFailed = false;
+    auto runQuery = [&](const std::string& query) -> SearchResult {
+        SearchOptions options;
+        options.mode = ranked && engine ? SearchOptions::Ranked : SearchOptions::And;
+        options.k = topK;
+        options.filter = filter;
+        options.fetchDocuments = false;
+        SearchResults found = engine ? engine->search(query, options) : barrels->search(query, options);
+        for (const std::string& note : found.notes) std::cout << "[DEBUG] " << note << "\n";
+        if (!found.message.empty()) std::cout << found.message << "\n";
+        queryFailed = !found.error.empty();
+        if (queryFailed) std::cerr << "ERROR: " << found.error << "\n";
 
-    std::cout << "[DEBUG] Word '" << query << "' maps to:\n";
-    std::cout << " - LexID: " << lexID << "\n";
-    std::cout << " - Barrel: " << barrelID << "\n";
+        SearchResult result;
+        for (const SearchHit& hit : found.hits) {
+            if (options.mode == SearchOptions::Ranked) result.ranked.push_back({hit.docID, hit.score});
+            else result.matches.push_back({hit.docID, hit.freq});
+        }
+        return result;
+    };
 
-    // STEP 3: load only that barrel
-    json barrel = loadBarrel(barrelsDir, barrelID);
+    auto printResult = [&](const std::string& query, const SearchResult& result) {
+        ScopedTimer formatTimer(formatLatency);
+        std::vector<std::string> words = queryTerms(query, stripAccents);
+        if (ranked && !sharedFile.empty()) printRanked(words, result.ranked, docs, stripAccents);
+        else printResults(words, result.matches, docs, topK, stripAccents);
+    };
 
-    // STEP 4: find posting list
-    std::string lexIDstr = std::to_string(lexID);
+    // Written on the way out when --metrics names a file
+    auto saveMetrics = [&]() -> int {
+        if (metricsFile.empty()) return 0;
+        if (!metrics().writeFile(metricsFile)) {
+            std::cerr << "ERROR: Cannot write " << metricsFile << "\n";
+            return 1;
+        }
+        return 0;
+    };
 
-    if (!barrel.contains(lexIDstr)) {
-        std::cout << "Word exists in lexicon but has no postings.\n";
-        return;
+    if (!loadIndex()) return 1;
+    MemoryReport memory(memoryReport, memoryBudget);
+    if (memory.enabled()) {
+        if (engine) {
+            memory.structure("shared index (mapped, page cache)", engine->shared().mappedBytes());
+        } else {
+            memory.structure("lexicon, df and barrel mapping (unordered_maps)", barrels->memoryBytes());
+        }
+        if (filter) memory.structure("attribute filter bitset", docFilter.words() * sizeof(uint64_t));
     }
+    memory.stage("load_index");
 
-    json postingList = barrel[lexIDstr];
+    if (!serve) {
+        std::string query = args[0];
 
-    std::cout << "\n=== RESULTS ===\n";
-    for (auto& [docID, freq] : postingList.items()) {
-        std::cout << "Doc " << docID << " (freq: " << freq << ")\n";
+        // --- Timing the search ---
+        using std::chrono::high_resolution_clock;
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        auto t1 = high_resolution_clock::now();
+        printResult(query, runQuery(query));
+        auto t2 = high_resolution_clock::now();
+        queriesTotal.add();
+        queryLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+
+        std::cout << "\nTime taken for search: "
+                  << duration_cast<microseconds>(t2 - t1).count()
+                  << " microseconds\n";
+        memory.stage("query");
+        memory.print(std::cout);
+        memory.warnOverBudget();
+        if (queryFailed) return 1;
+        return saveMetrics();
     }
-}
 
-// ----------------------------------------------------
-// MAIN
-// ----------------------------------------------------
+    // -------------------- Resident mode with a result cache --------------------
+    // Under --memory-budget the cache gets at most half of what the budget
+    // leaves once the index is loaded, instead of pushing the process past it
+    uint64_t cacheBytes = uint64_t(cacheMB) * 1024 * 1024;
+    if (memoryBudget && memoryHeadroom(memoryBudget) / 2 < cacheBytes) {
+        cacheBytes = memoryHeadroom(memoryBudget) / 2;
+        std::cout << "Memory budget " << formatBytes(memoryBudget) << ": result cache capped at "
+                  << formatBytes(cacheBytes) << "\n";
+    }
+    QueryCache<SearchResult> cache(cacheBytes);
+    memory.structure("result cache (capacity)", cacheBytes);
+    memory.print(std::cout);
+    std::string mode = ranked && !sharedFile.empty() ? "ranked" : "and";
+    if (filter) mode += "|" + attributeFilter.key();
 
-int main(int argc, char* argv[]) {
+    // One line of input; false once the server should stop
+    auto handleLine = [&](const std::string& line) -> bool {
+        if (line == "quit") return false;
+        if (line.empty()) return true;
 
-    if (argc < 5) {
-        std::cout << "Usage: search <word> <lexicon.json> <barrel_mapping.json> <barrels_directory>\n";
-        return 1;
+        if (line == "stats") {
+            const QueryCacheStats& st = cache.stats();
+            std::cout << "Cache: " << cache.size() << " entries, " << cache.bytesUsed() << " bytes, "
+                      << st.hits << " hits, " << st.misses << " misses, "
+                      << st.admitted << " admitted, " << st.rejected << " rejected, "
+                      << st.evicted << " evicted, " << st.invalidations << " invalidations\n";
+            return true;
+        }
+        if (line == "metrics") {
+            std::cout << metrics().toJson().dump(4) << "\n";
+            return true;
+        }
+        if (line == "metrics prom") {
+            std::cout << metrics().toPrometheus();
+            return true;
+        }
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        // Pick up a rebuilt index before answering; a rebuild that does
+        // not load (half written, corrupt) leaves the current one serving
+        if (!loadIndex())
+            std::cerr << "ERROR: Reload failed, still serving generation " << generation << "\n";
+        cache.setGeneration(generation);
+
+        std::string key = queryKey(mode, queryTerms(line, stripAccents), topK);
+        const SearchResult* cached = cache.get(key);
+        if (cached) {
+            cacheHitsTotal.add();
+            printResult(line, *cached);
+        } else {
+            SearchResult result = runQuery(line);
+            printResult(line, result);
+            size_t bytes = resultBytes(result);
+            if (!queryFailed) cache.put(key, std::move(result), bytes);
+        }
+
+        auto t2 = std::chrono::high_resolution_clock::now();
+        queriesTotal.add();
+        queryLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+        std::cout << "\nTime taken for search: "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+                  << " microseconds" << (cached ? " (cached)" : "") << "\n";
+        return true;
+    };
+
+    if (!listenSocket.empty()) {
+        // Each reply is exactly what --serve would have printed
+        std::cout << "Listening on " << listenSocket << "\n" << std::flush;
+        std::ostringstream captured;
+        std::streambuf* console = std::cout.rdbuf();
+        std::string error;
+        bool ok = serveLocalSocket(listenSocket, [&](const std::string& request, std::string& reply) {
+            captured.str(std::string());
+            std::cout.rdbuf(captured.rdbuf());
+            bool running = handleLine(request);
+            std::cout.rdbuf(console);
+            reply = captured.str();
+            return running;
+        }, error);
+        if (!ok) {
+            std::cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+        return saveMetrics();
     }
 
-    std::string query      = argv[1];
-    std::string lexFile    = argv[2];
-    std::string mapFile    = argv[3];
-    std::string barrelsDir = argv[4];
-
-    // Load static data first
-    std::cout << "Loading lexicon...\n";
-    auto lexMap    = loadLexicon(lexFile);
-    std::cout << "Loading barrel mapping...\n";
-    auto barrelMap = loadBarrelMapping(mapFile);
-    std::cout << "Data loaded.\n";
-    
-    // --- Timing the searchWord function ---
-    using std::chrono::high_resolution_clock;
-    using std::chrono::duration_cast;
-    using std::chrono::duration;
-    using std::chrono::microseconds;
-    
-    // Record start time
-    auto t1 = high_resolution_clock::now();
-    
-    // Perform the search
-    searchWord(query, lexMap, barrelMap, barrelsDir);
-    
-    // Record end time
-    auto t2 = high_resolution_clock::now();
-    
-    // Calculate the duration
-    auto ms_int = duration_cast<microseconds>(t2 - t1);
-    
-    // Print the elapsed time
-    std::cout << "\nTime taken for search: " 
-              << ms_int.count() 
-              << " microseconds\n";
-    // -------------------------------------
-
-    return 0;
-}
\ No newline at end of file
+    std::string line;
+    while (true) {
+        std::cout << "\nQuery (or 'quit', 'stats', 'metrics [prom]'): ";
+        if (!std::getline(std::cin, line) || !handleLine(line)) break;
+    }
+    return saveMetrics();
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include "posting_containers.h"
+
+// ----------------------------------------------------
+// Compares AND over plain posting arrays (galloping) against the hybrid
+// bitmap/array containers, for term pairs of increasing density.
+//
+// Usage: bench_postings [docCount] [repeats]
+// ----------------------------------------------------
+std::vector<Posting> randomList(uint32_t docCount, double density, std::mt19937& rng) {
+    std::bernoulli_distribution take(density);
+    std::vector<Posting> list;
+    for (uint32_t d = 1; d <= docCount; d++)
+        if (take(rng)) list.push_back({d, 1});
+    return list;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t docCount = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    int repeats       = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    std::mt19937 rng(42);
+    const double densities[][2] = {{0.001, 0.01}, {0.01, 0.1}, {0.1, 0.3}, {0.3, 0.5}, {0.5, 0.9}};
+
+    std::cout << "docs=" << docCount << " repeats=" << repeats << "\n";
+    std::cout << "densityA densityB | array bytes | hybrid bytes | gallop us | hybrid us | matches\n";
+
+    for (auto& d : densities) {
+        std::vector<Posting> a = randomList(docCount, d[0], rng);
+        std::vector<Posting> b = randomList(docCount, d[1], rng);
+
+        std::string blockA = encodeContainers(a.data(), a.size(), CONTAINER_ARRAY_MAX);
+        std::string blockB = encodeContainers(b.data(), b.size(), CONTAINER_ARRAY_MAX);
+
+        // Same decision the index builder makes per term
+        bool denseA = needsContainers(a.data(), a.size(), CONTAINER_ARRAY_MAX);
+        bool denseB = needsContainers(b.data(), b.size(), CONTAINER_ARRAY_MAX);
+
+        TermDocs plainA{a.data(), (uint32_t)a.size(), ContainerSet()};
+        TermDocs plainB{b.data(), (uint32_t)b.size(), ContainerSet()};
+        TermDocs hybridA{a.data(), (uint32_t)a.size(), ContainerSet(denseA ? blockA.data() : nullptr)};
+        TermDocs hybridB{b.data(), (uint32_t)b.size(), ContainerSet(denseB ? blockB.data() : nullptr)};
+
+        IntersectStats stats;
+        size_t plainMatches = 0, hybridMatches = 0;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < repeats; r++) plainMatches = intersectTerms({plainA, plainB}, stats).size();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < repeats; r++) hybridMatches = intersectTerms({hybridA, hybridB}, stats).size();
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        if (plainMatches != hybridMatches) {
+            std::cerr << "ERROR: hybrid intersection disagrees (" << plainMatches
+                      << " vs " << hybridMatches << ")\n";
+            return 1;
+        }
+
+        auto perQuery = [&](auto from, auto to) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count() / repeats;
+        };
+        size_t arrayBytes  = (a.size() + b.size()) * sizeof(Posting);
+        size_t hybridBytes = arrayBytes + (denseA ? blockA.size() : 0) + (denseB ? blockB.size() : 0);
+
+        std::cout << d[0] << " " << d[1] << " | " << arrayBytes << " | " << hybridBytes << " | "
+                  << perQuery(t0, t1) << " | " << perQuery(t1, t2) << " | " << hybridMatches << "\n";
+    }
+    return 0;
+}
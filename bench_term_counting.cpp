@@ -0,0 +1,140 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <regex>
+#include <algorithm>
+#include <unordered_map>
+#include "document_source.h"
+#include "term_arena.h"
+#include "alloc_counter.h"
+
+// ----------------------------------------------------
+// Per-document term counting as the index builders do it:
+//   regex+map      [A-Za-z0-9]+ regex into a fresh unordered_map per document
+//   ascii+flatmap  the old ASCII-only byte loop into one reset FlatTermMap
+//   utf8+flatmap   forEachWord (unicode_text.h) into the same map
+// The first two split words the same way and must agree exactly. The
+// UTF-8 tokenizer agrees with them on pure-ASCII input only; on anything
+// else it keeps letters the others split on, so its counts are reported,
+// not compared. Its cost is the throughput ratio against ascii+flatmap.
+//
+// Usage: bench_term_counting <dataset_folder|release.tar.gz> [repeats]
+// ----------------------------------------------------
+struct Run {
+    uint64_t allocations = 0;
+    double ms = 0;
+    uint64_t terms = 0, tokens = 0;
+};
+
+template <typename Fn>
+Run timed(Fn fn) {
+    Run run;
+    uint64_t before = heapAllocations().load();
+    auto t0 = std::chrono::high_resolution_clock::now();
+    fn(run);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    run.allocations = heapAllocations().load() - before;
+    run.ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    return run;
+}
+
+// The byte loop forEachWord replaced: [A-Za-z0-9]+ runs, lowercased
+template <typename Fn>
+void forEachAsciiWord(std::string_view text, Fn fn) {
+    static thread_local std::string word;
+    word.clear();
+    for (char ch : text) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        bool alnum = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        if (alnum) {
+            word += static_cast<char>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+        } else if (!word.empty()) {
+            fn(std::string_view(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) fn(std::string_view(word));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: bench_term_counting <dataset_folder|release.tar.gz> [repeats]\n";
+        return 1;
+    }
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    std::vector<std::string> docs;
+    uint64_t bytes = 0, nonAscii = 0;
+    bool readOk = forEachDocument(argv[1], false,
+        [&](int, const std::string&, const std::string& content) {
+            docs.push_back(content);
+            bytes += content.size();
+            for (unsigned char c : content) nonAscii += c >= 0x80;
+        });
+    if (!readOk) { std::cerr << "ERROR: Cannot read dataset " << argv[1] << "\n"; return 1; }
+
+    std::cout << "docs=" << docs.size() << " bytes=" << bytes << " non-ascii bytes=" << nonAscii
+              << " repeats=" << repeats << "\n";
+
+    // -------------------- Before: regex + unordered_map per document --------------------
+    Run legacy = timed([&](Run& run) {
+        static const std::regex wordRegex("[A-Za-z0-9]+");
+        for (int r = 0; r < repeats; r++) {
+            for (const std::string& text : docs) {
+                std::unordered_map<std::string,int> termFreq;
+                for (auto it = std::sregex_iterator(text.begin(), text.end(), wordRegex);
+                     it != std::sregex_iterator(); ++it) {
+                    std::string word = it->str();
+                    std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+                    termFreq[word]++;
+                }
+                run.terms += termFreq.size();
+                for (auto& p : termFreq) run.tokens += p.second;
+            }
+        }
+    });
+
+    // -------------------- After: arena-backed map reset per document --------------------
+    auto countWith = [&](auto scan) {
+        return timed([&](Run& run) {
+            FlatTermMap<int> termFreq;
+            for (int r = 0; r < repeats; r++) {
+                for (const std::string& text : docs) {
+                    termFreq.reset();
+                    scan(text, [&](std::string_view word) { termFreq[word]++; });
+                    run.terms += termFreq.size();
+                    for (auto p : termFreq) run.tokens += p.second;
+                }
+            }
+        });
+    };
+    Run ascii = countWith([](const std::string& text, auto fn) { forEachAsciiWord(text, fn); });
+    Run utf8 = countWith([](const std::string& text, auto fn) { forEachWord(text, fn); });
+
+    auto agree = [](const char* name, const Run& a, const Run& b) {
+        if (a.terms == b.terms && a.tokens == b.tokens) return true;
+        std::cerr << "ERROR: term counts disagree for " << name << " (" << a.terms << "/" << a.tokens
+                  << " vs " << b.terms << "/" << b.tokens << ")\n";
+        return false;
+    };
+    if (!agree("regex+map vs ascii+flatmap", legacy, ascii)) return 1;
+    if (nonAscii == 0 && !agree("ascii+flatmap vs utf8+flatmap", ascii, utf8)) return 1;
+
+    std::cout << "path           | heap allocations | ms      | MB/s\n";
+    for (auto& [name, run] : {std::pair<const char*, Run&>{"regex+map     ", legacy},
+                              std::pair<const char*, Run&>{"ascii+flatmap ", ascii},
+                              std::pair<const char*, Run&>{"utf8+flatmap  ", utf8}}) {
+        double mbPerSec = run.ms > 0 ? bytes * repeats / 1e6 / (run.ms / 1000) : 0;
+        std::cout << name << " | " << run.allocations << " | " << run.ms << " | " << mbPerSec << "\n";
+    }
+    std::cout << "terms=" << utf8.terms << " tokens=" << utf8.tokens;
+    if (nonAscii) std::cout << " (ascii: terms=" << ascii.terms << " tokens=" << ascii.tokens << ")";
+    std::cout << "\n";
+
+    // The UTF-8 tokenizer is meant to cost under 10% of the ASCII loop's throughput
+    double ratio = utf8.ms > 0 ? ascii.ms / utf8.ms : 0;
+    std::cout << "utf8 throughput vs ascii loop: " << ratio << "x"
+              << (ratio >= 0.9 ? " (within 10%)" : " (WARNING: more than 10% slower)") << "\n";
+    return 0;
+}
@@ -0,0 +1,403 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include "nlohmann/json.hpp"
+#include "corpus_generator.h"
+#include "term_arena.h"
+#include "cord19_reader.h"
+#include "varint.h"
+#include "posting_containers.h"
+#include "ranking.h"
+#include "autocomplete.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+// ----------------------------------------------------
+// Benchmark suite over deterministic synthetic corpora
+//
+//   benchmark generate <dir>   write a corpus (and its lexicon.json)
+//   benchmark micro            in-memory microbenchmarks: tokenizing,
+//                              CORD-19 extraction, lexicon lookup, barrel
+//                              load, posting decode/intersect, autocomplete
+//   benchmark e2e --bin <dir>  run the build tools from <dir> on a fresh
+//                              corpus, then time AND and ranked queries
+//                              against the search_index.bin they built
+//
+// --json <file> writes the results in machine-readable form. With
+// --baseline <file> every result is compared to an earlier run. Any
+// result worse by more than --tolerance (default 0.15) is reported and
+// the exit code becomes 2.
+// ----------------------------------------------------
+struct Result {
+    std::string name;
+    double value;
+    std::string unit;
+    bool higherIsBetter;
+};
+
+// Best of several runs: the least disturbed by everything else on the machine
+double bestSeconds(int repeats, const std::function<void()>& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+// Keeps the optimizer from discarding a benchmark's work
+volatile uint64_t sink = 0;
+
+// -------------------- Microbenchmarks --------------------
+std::vector<Result> runMicro(const CorpusGenerator& gen, int repeats) {
+    const CorpusConfig& cfg = gen.settings();
+    std::vector<Result> results;
+
+    std::vector<std::string> texts, papers;
+    uint64_t textBytes = 0, paperBytes = 0;
+    for (uint32_t d = 1; d <= cfg.documents; d++) {
+        SyntheticDocument doc = gen.document(d);
+        texts.push_back(gen.text(doc));
+        papers.push_back(gen.cord19Json(doc));
+        textBytes += texts.back().size();
+        paperBytes += papers.back().size();
+    }
+
+    // Tokenize + count, as the index builders do per document
+    FlatTermMap<int> termFreq;
+    double s = bestSeconds(repeats, [&] {
+        for (auto& t : texts) {
+            termFreq.reset();
+            forEachWord(t, [&](std::string_view w) { termFreq[w]++; });
+            sink += termFreq.size();
+        }
+    });
+    results.push_back({"tokenize", textBytes / 1e6 / s, "MB/s", true});
+
+    // CORD-19 text extraction (SAX, no DOM)
+    s = bestSeconds(repeats, [&] {
+        for (auto& p : papers)
+            extractCord19Text(p.data(), p.data() + p.size(),
+                              [&](Cord19Field, const std::string& text) { sink += text.size(); });
+    });
+    results.push_back({"cord19_extract", paperBytes / 1e6 / s, "MB/s", true});
+
+    // Lexicon lookup: Zipf-distributed words, one in ten not in the lexicon
+    FlatTermMap<int> lexicon;
+    for (size_t i = 0; i < gen.words().size(); i++) lexicon[gen.words()[i]] = i + 1;
+    std::vector<std::string> probes;
+    SplitMix64 rng(cfg.seed);
+    for (int i = 0; i < 1000000; i++) {
+        if (i % 10 == 9) probes.push_back("zq" + std::to_string(i));
+        else probes.push_back(gen.words()[gen.sampler().sample(rng)]);
+    }
+    s = bestSeconds(repeats, [&] {
+        for (auto& w : probes)
+            if (const int* id = lexicon.find(w)) sink += *id;
+    });
+    results.push_back({"lexicon_lookup", probes.size() / 1e6 / s, "Mlookups/s", true});
+
+    // Posting lists of the corpus, docIDs ascending
+    std::vector<std::vector<Posting>> lists(gen.words().size() + 1);
+    for (uint32_t d = 0; d < texts.size(); d++) {
+        termFreq.reset();
+        forEachWord(texts[d], [&](std::string_view w) { termFreq[w]++; });
+        for (auto p : termFreq)
+            if (const int* id = lexicon.find(p.first)) lists[*id].push_back({d + 1, (uint32_t)p.second});
+    }
+
+    // Barrel load: one of the 32 barrels, in barrel_creation_storage's format
+    json barrel = json::object();
+    uint64_t barrelPostings = 0;
+    for (size_t id = 1; id < lists.size(); id += 32) {
+        if (lists[id].empty()) continue;
+        json docs = json::object();
+        for (auto& p : lists[id]) docs[std::to_string(p.docID)] = p.freq;
+        barrel[std::to_string(id)] = docs;
+        barrelPostings += lists[id].size();
+    }
+    std::string barrelText = barrel.dump(4);
+    s = bestSeconds(repeats, [&] { sink += json::parse(barrelText).size(); });
+    results.push_back({"barrel_load", barrelText.size() / 1e6 / s, "MB/s", true});
+    results.push_back({"barrel_load_postings", barrelPostings / 1e6 / s, "Mpostings/s", true});
+
+    // Posting decode: varint docID gaps and frequencies
+    std::string encoded;
+    uint64_t postingTotal = 0;
+    for (auto& list : lists) {
+        uint32_t prev = 0;
+        for (auto& p : list) {
+            putVarint(encoded, p.docID - prev);
+            putVarint(encoded, p.freq);
+            prev = p.docID;
+        }
+        postingTotal += list.size();
+    }
+    s = bestSeconds(repeats, [&] {
+        const char* p = encoded.data();
+        const char* end = p + encoded.size();
+        uint64_t doc = 0, freq = 0;
+        while (p < end) {
+            doc += getVarint(p);
+            freq += getVarint(p);
+        }
+        sink += doc + freq;
+    });
+    results.push_back({"posting_decode", postingTotal / 1e6 / s, "Mpostings/s", true});
+
+    // Intersection of Zipf-drawn word pairs. A tiny corpus may not have
+    // two words with postings, or the sampler may hardly ever draw them,
+    // so sampling gives up after a bounded number of draws.
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (uint64_t draws = 0; pairs.size() < 10000 && draws < 1000000; draws++) {
+        uint32_t a = gen.sampler().sample(rng) + 1, b = gen.sampler().sample(rng) + 1;
+        if (a != b && !lists[a].empty() && !lists[b].empty()) pairs.push_back({a, b});
+    }
+    if (pairs.empty()) {
+        std::cout << "  posting_intersect: skipped, fewer than two words with postings\n";
+    } else {
+        IntersectStats stats;
+        s = bestSeconds(repeats, [&] {
+            for (auto& [a, b] : pairs) {
+                sink += intersectTerms({{lists[a].data(), (uint32_t)lists[a].size(), ContainerSet()},
+                                        {lists[b].data(), (uint32_t)lists[b].size(), ContainerSet()}}, stats).size();
+            }
+        });
+        results.push_back({"posting_intersect", pairs.size() / s, "queries/s", true});
+    }
+
+    // Autocomplete on 1-3 letter prefixes of Zipf-drawn words
+    AutocompleteEngine trie;
+    for (auto& w : gen.words()) trie.addWordToLexicon(w);
+    std::vector<std::string> prefixes;
+    for (int i = 0; i < 20000; i++) {
+        const std::string& w = gen.words()[gen.sampler().sample(rng)];
+        prefixes.push_back(w.substr(0, 1 + i % 3));
+    }
+    s = bestSeconds(repeats, [&] {
+        for (auto& p : prefixes) sink += trie.getSuggestions(p, 5).size();
+    });
+    results.push_back({"autocomplete", s / prefixes.size() * 1e6, "us/query", false});
+
+    return results;
+}
+
+// -------------------- End-to-end --------------------
+std::string toolPath(const std::string& binDir, const std::string& name) {
+#ifdef _WIN32
+    return (fs::path(binDir) / (name + ".exe")).string();
+#else
+    return (fs::path(binDir) / name).string();
+#endif
+}
+
+std::string shellQuoted(const std::string& s) { return "\"" + s + "\""; }
+
+bool runE2E(const CorpusGenerator& gen, const std::string& binDir, const std::string& work,
+            int queryCount, std::vector<Result>& results) {
+    const CorpusConfig& cfg = gen.settings();
+    fs::remove_all(work);
+    fs::create_directories(work);
+
+    std::string corpus  = (fs::path(work) / "corpus").string();
+    std::string lexicon = (fs::path(work) / "lexicon.json").string();
+    auto at = [&](const std::string& name) { return (fs::path(work) / name).string(); };
+
+    double s = bestSeconds(1, [&] { sink += gen.write(corpus); });
+    results.push_back({"generate_corpus", s, "s", false});
+    if (!gen.writeLexicon(lexicon)) {
+        std::cerr << "ERROR: Cannot write " << lexicon << "\n";
+        return false;
+    }
+
+    // Each stage runs the real tool, its output kept in <work>/<stage>.log
+    struct Stage { std::string name, command; };
+    std::vector<Stage> stages = {
+        {"build_forward_index", shellQuoted(toolPath(binDir, "build_forward_index")) + " " + shellQuoted(corpus) + " " +
+            shellQuoted(lexicon) + " " + shellQuoted(at("forward_index.json")) + " --binary-forward " + shellQuoted(at("forward_index.bin")) + " --quiet"},
+        {"build_inverted_index", shellQuoted(toolPath(binDir, "build_inverted_index")) + " " + shellQuoted(corpus) + " " +
+            shellQuoted(lexicon) + " " + shellQuoted(at("inverted_index.json")) + " --quiet"},
+        {"barrel_mapping", shellQuoted(toolPath(binDir, "barrel_mapping")) + " " + shellQuoted(lexicon) + " " +
+            shellQuoted(at("barrel_mapping.json"))},
+        {"barrel_creation_storage", shellQuoted(toolPath(binDir, "barrel_creation_storage")) + " " +
+            shellQuoted(at("inverted_index.json")) + " " + shellQuoted(at("barrel_mapping.json")) + " " + shellQuoted(at("barrels"))},
+        {"build_shared_index", shellQuoted(toolPath(binDir, "build_shared_index")) + " " + shellQuoted(lexicon) + " " +
+            shellQuoted(at("barrel_mapping.json")) + " " + shellQuoted(at("barrels")) + " " + shellQuoted(at("search_index.bin"))},
+    };
+    double total = 0;
+    for (auto& stage : stages) {
+        std::string command = stage.command + " > " + shellQuoted(at(stage.name + ".log")) + " 2>&1";
+        int status = 0;
+        s = bestSeconds(1, [&] { status = std::system(command.c_str()); });
+        if (status != 0) {
+            std::cerr << "ERROR: " << stage.name << " failed (see " << at(stage.name + ".log") << ")\n";
+            return false;
+        }
+        std::cout << "  " << stage.name << ": " << s << " s\n";
+        results.push_back({"stage_" + stage.name, s, "s", false});
+        total += s;
+    }
+    results.push_back({"build_total", total, "s", false});
+    results.push_back({"build_throughput", cfg.documents / total, "docs/s", true});
+
+    // -------------------- Queries --------------------
+    SharedIndex index;
+    std::string error;
+    if (!index.open(at("search_index.bin"), error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return false;
+    }
+
+    // One to three Zipf-drawn words, like a query log's head and tail
+    SplitMix64 rng(cfg.seed + 1);
+    std::vector<std::vector<const TermEntry*>> queries;
+    while ((int)queries.size() < queryCount) {
+        std::vector<const TermEntry*> q;
+        int words = 1 + rng.below(3);
+        for (int w = 0; w < words; w++)
+            if (const TermEntry* t = index.findTerm(gen.words()[gen.sampler().sample(rng)])) q.push_back(t);
+        if ((int)q.size() == words) queries.push_back(q);
+    }
+
+    std::vector<double> andUs, rankedUs;
+    IntersectStats stats;
+    for (auto& q : queries) {
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<TermDocs> terms;
+        for (const TermEntry* t : q) terms.push_back(termDocs(index, *t));
+        sink += intersectTerms(terms, stats).size();
+        auto t1 = std::chrono::steady_clock::now();
+        sink += tieredTopK(index, q, 10).size();
+        auto t2 = std::chrono::steady_clock::now();
+        andUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        rankedUs.push_back(std::chrono::duration<double, std::micro>(t2 - t1).count());
+    }
+    for (auto& [name, v] : {std::pair<std::string, std::vector<double>&>{"query_and", andUs},
+                            std::pair<std::string, std::vector<double>&>{"query_ranked", rankedUs}}) {
+        double sum = 0;
+        for (double x : v) sum += x;
+        results.push_back({name + "_p50", percentile(v, 0.50), "us", false});
+        results.push_back({name + "_p99", percentile(v, 0.99), "us", false});
+        results.push_back({name + "_throughput", v.size() / (sum / 1e6), "queries/s", true});
+    }
+    return true;
+}
+
+// -------------------- Baseline comparison --------------------
+int compareBaseline(const std::vector<Result>& results, const json& config,
+                    const std::string& file, double tolerance) {
+    std::ifstream in(file);
+    if (!in) {
+        std::cerr << "ERROR: Cannot open baseline " << file << "\n";
+        return 1;
+    }
+    json baseline;
+    in >> baseline;
+    if (baseline["config"] != config)
+        std::cout << "Note: baseline was run with " << baseline["config"].dump() << "\n";
+
+    int regressions = 0;
+    for (auto& old : baseline["results"]) {
+        auto it = std::find_if(results.begin(), results.end(),
+                               [&](const Result& r) { return r.name == old["name"]; });
+        if (it == results.end() || old["value"].get<double>() <= 0) continue;
+        double change = it->value / old["value"].get<double>() - 1;
+        double worse = it->higherIsBetter ? -change : change;
+        if (worse > tolerance) {
+            regressions++;
+            std::cout << "REGRESSION " << it->name << ": " << old["value"].get<double>() << " -> "
+                      << it->value << " " << it->unit << " (" << (int)(worse * 100) << "% worse)\n";
+        }
+    }
+    if (!regressions) std::cout << "No regressions against " << file << "\n";
+    return regressions ? 2 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: benchmark generate <dir> [corpus options]\n"
+                  << "       benchmark micro [corpus options] [--repeats <n>]\n"
+                  << "       benchmark e2e --bin <tools_dir> [--work <dir>] [--queries <n>] [corpus options]\n"
+                  << "       [--json <results.json>] [--baseline <old.json> [--tolerance <0..1>]]\n"
+                  << "corpus options: --docs <n> --vocab <n> --zipf <s> --words <mean> --json-share <0..1> --seed <n>\n";
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    CorpusConfig cfg;
+    std::string outDir, binDir, work = "bench_work", jsonFile, baselineFile;
+    int repeats = 3, queryCount = 2000;
+    double tolerance = 0.15;
+    int i = 2;
+    if (mode == "generate" && argc > 2) outDir = argv[i++];
+    for (; i < argc; i++) {
+        std::string opt = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (opt == "--docs" && hasValue) cfg.documents = std::stoul(argv[++i]);
+        else if (opt == "--vocab" && hasValue) cfg.vocabulary = std::max<uint32_t>(1, std::stoul(argv[++i]));
+        else if (opt == "--zipf" && hasValue) cfg.zipf = std::stod(argv[++i]);
+        else if (opt == "--words" && hasValue) cfg.meanWords = std::stoul(argv[++i]);
+        else if (opt == "--json-share" && hasValue) cfg.jsonShare = std::stod(argv[++i]);
+        else if (opt == "--seed" && hasValue) cfg.seed = std::stoull(argv[++i]);
+        else if (opt == "--repeats" && hasValue) repeats = std::max(1, std::stoi(argv[++i]));
+        else if (opt == "--bin" && hasValue) binDir = argv[++i];
+        else if (opt == "--work" && hasValue) work = argv[++i];
+        else if (opt == "--queries" && hasValue) queryCount = std::max(1, std::stoi(argv[++i]));
+        else if (opt == "--json" && hasValue) jsonFile = argv[++i];
+        else if (opt == "--baseline" && hasValue) baselineFile = argv[++i];
+        else if (opt == "--tolerance" && hasValue) tolerance = std::stod(argv[++i]);
+    }
+
+    CorpusGenerator gen(cfg);
+    std::vector<Result> results;
+
+    if (mode == "generate") {
+        if (outDir.empty()) { std::cerr << "ERROR: generate needs an output directory\n"; return 1; }
+        uint64_t bytes = gen.write(outDir);
+        if (!bytes || !gen.writeLexicon((fs::path(outDir) / "lexicon.json").string())) {
+            std::cerr << "ERROR: Cannot write corpus to " << outDir << "\n";
+            return 1;
+        }
+        std::cout << "✓ " << cfg.documents << " documents (" << bytes << " bytes) and lexicon.json in "
+                  << outDir << "\n";
+        return 0;
+    } else if (mode == "micro") {
+        results = runMicro(gen, repeats);
+    } else if (mode == "e2e") {
+        if (binDir.empty()) { std::cerr << "ERROR: e2e needs --bin <tools_dir>\n"; return 1; }
+        if (!runE2E(gen, binDir, work, queryCount, results)) return 1;
+    } else {
+        std::cerr << "ERROR: Unknown mode " << mode << "\n";
+        return 1;
+    }
+
+    // -------------------- Report --------------------
+    std::cout << "\n" << mode << " (" << cfg.toJson().dump() << ")\n";
+    for (auto& r : results) std::cout << "  " << r.name << ": " << r.value << " " << r.unit << "\n";
+
+    if (!jsonFile.empty()) {
+        json out = {{"suite", mode}, {"config", cfg.toJson()}, {"results", json::array()}};
+        for (auto& r : results)
+            out["results"].push_back({{"name", r.name}, {"value", r.value}, {"unit", r.unit},
+                                      {"higher_is_better", r.higherIsBetter}});
+        std::ofstream f(jsonFile);
+        f << out.dump(4);
+        if (!f) { std::cerr << "ERROR: Cannot write " << jsonFile << "\n"; return 1; }
+    }
+
+    return baselineFile.empty() ? 0 : compareBaseline(results, cfg.toJson(), baselineFile, tolerance);
+}
@@ -3,132 +3,578 @@
 #include <unordered_map>
 #include <string>
 #include <filesystem>
-#include <regex>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 #include "nlohmann/json.hpp"
+#include "stream_writer.h"
+#include "cord19_reader.h"
+#include "document_source.h"
+#include "doc_store.h"
+#include "forward_index.h"
+#include "doc_attributes.h"
+#include "minhash.h"
+#include "shared_index.h"
+#include "term_arena.h"
+#include "index_files.h"
+#include "document_text.h"
+#include "phrase_index.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_usage.h"
+#include "alloc_counter.h"
 
 using json = nlohmann::json;
-namespace fs = std::filesystem;
 
-// -------------------- File Filter --------------------
-bool isReadableFile(const fs::path& p) {
-    std::string ext = p.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-
-    return ext == ".txt" || ext == ".json" || ext == ".csv" ||
-           ext == ".xml" || ext == ".html" || ext == ".md" ||
-           ext == ".log" || ext == ".tsv" || ext == ".yaml" ||
-           ext == ".ini" || ext == ".cfg";
+// -------------------- Document record --------------------
+// What the outputs need from one tokenized document. Without --checkpoint
+// it is emitted straight away; with it, it goes through a segment file
+// and is emitted by the final merge.
+struct DocumentRecord {
+    int docID = 0;
+    int canonical = 0;          // near-duplicate of this docID, or 0
+    std::string path, title, storedText;
+    TermVector terms;           // lexicon terms, sorted by lexID
+    uint32_t docLength = 0;     // tokens, in the lexicon or not
+    uint32_t distinctTerms = 0;
+    bool hasSignature = false;  // canonical document under --dedup
+    MinHashSignature signature;
+};
+
+// Title and text are only kept when the document store or the
+// completion index wants them
+void saveRecord(SegmentWriter& out, const DocumentRecord& doc, bool withText) {
+    out.putNumber(doc.docID);
+    out.putNumber(doc.canonical);
+    out.putString(doc.path);
+    out.putString(withText ? doc.title : std::string());
+    out.putString(withText ? doc.storedText : std::string());
+    out.putNumber(doc.docLength);
+    out.putNumber(doc.distinctTerms);
+    out.putNumber(doc.terms.size());
+    uint32_t prev = 0;
+    for (auto& [lexID, freq] : doc.terms) {
+        out.putNumber(lexID - prev);
+        out.putNumber(freq);
+        prev = lexID;
+    }
+    out.putNumber(doc.hasSignature);
+    if (doc.hasSignature) out.putBytes(doc.signature.data(), sizeof(doc.signature));
+    out.endRecord();
 }
 
-// -------------------- Tokenizer --------------------
-void tokenize(const std::string& text,
-              std::unordered_map<std::string,int>& termFreq)
-{
-    //This creates an expression and ignore characters like @? and others
-    static const std::regex wordRegex("[A-Za-z0-9]+");
-
-
-    auto begin = std::sregex_iterator(text.begin(), text.end(), wordRegex);
-    auto end   = std::sregex_iterator();
-
-    for (auto it = begin; it != end; ++it) {
-        std::string word = it->str();
-        //Word is lowercased
-        std::transform(word.begin(), word.end(), word.begin(), ::tolower);
-        termFreq[word]++;
+bool loadRecord(SegmentReader& in, DocumentRecord& doc) {
+    if (in.atEnd()) return false;
+    doc.docID         = in.getNumber();
+    doc.canonical     = in.getNumber();
+    doc.path          = in.getString();
+    doc.title         = in.getString();
+    doc.storedText    = in.getString();
+    doc.docLength     = in.getNumber();
+    doc.distinctTerms = in.getNumber();
+    doc.terms.resize(in.getNumber());
+    uint32_t prev = 0;
+    for (auto& [lexID, freq] : doc.terms) {
+        lexID = prev + in.getNumber();
+        freq  = in.getNumber();
+        prev  = lexID;
     }
+    doc.hasSignature = in.getNumber() != 0;
+    if (doc.hasSignature) in.getBytes(doc.signature.data(), sizeof(doc.signature));
+    return true;
 }
 
 int main(int argc, char* argv[]) {
 
     if (argc < 4) {
-        std::cout << "Usage: build_forward_index <dataset_folder> <lexicon_json> <output_json>\n";
+        std::cout << "Usage: build_forward_index <dataset_folder|release.tar.gz> <lexicon_json> <output_json>\n"
+                  << "       [--compact|--binary] [--raw-json] [--archive-order]\n"
+                  << "       [--doc-store <docstore.bin>] [--binary-forward <forward_index.bin>]\n"
+                  << "       [--attributes <docattrs.bin> [--metadata <metadata.csv>]]\n"
+                  << "       [--dedup drop|collapse [--dedup-threshold <0..1>] [--duplicates <duplicates.json>]]\n"
+                  << "       [--checkpoint <dir> [--batch <docs>]]\n"
+                  << "       [--phrases <completions.bin> [--phrase-words <n>] [--phrase-min-count <n>]\n"
+                  << "        [--phrase-max-entries <n>]]\n"
+                  << "       [--memory-budget <MB>] [--memory-report]\n"
+                  << "       [--quiet] [--metrics <metrics.json|metrics.prom>] [--trace <trace.json>]\n";
         return 1;
     }
 
     std::string datasetDir  = argv[1];
     std::string lexiconFile = argv[2];
     std::string outputFile  = argv[3];
+    OutputFormat format     = parseOutputFormat(argc, argv, 4);
+    bool cord19Json         = true;
+    bool archiveOrder       = false;
+    std::string docStoreFile;
+    std::string binaryForwardFile;
+    std::string attributesFile, metadataFile;
+    std::string dedupMode, duplicatesFile = "duplicates.json";
+    double dedupThreshold = 0.8;
+    std::string checkpointDir;
+    uint32_t batchDocs = 1000;
+    bool quiet = false;
+    std::string metricsFile, traceFile;
+    std::string phrasesFile;
+    uint32_t phraseWords = 3, phraseMinCount = 3;
+    size_t phraseMaxEntries = 4000000;
+    uint64_t memoryBudget = 0;
+    bool memoryReport = false;
+    for (int i = 4; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt == "--raw-json") cord19Json = false;
+        else if (opt == "--archive-order") archiveOrder = true;
+        else if (opt == "--doc-store" && i + 1 < argc) docStoreFile = argv[++i];
+        else if (opt == "--binary-forward" && i + 1 < argc) binaryForwardFile = argv[++i];
+        else if (opt == "--attributes" && i + 1 < argc) attributesFile = argv[++i];
+        else if (opt == "--metadata" && i + 1 < argc) metadataFile = argv[++i];
+        else if (opt == "--dedup" && i + 1 < argc) dedupMode = argv[++i];
+        else if (opt == "--dedup-threshold" && i + 1 < argc) dedupThreshold = std::stod(argv[++i]);
+        else if (opt == "--duplicates" && i + 1 < argc) duplicatesFile = argv[++i];
+        else if (opt == "--checkpoint" && i + 1 < argc) checkpointDir = argv[++i];
+        else if (opt == "--batch" && i + 1 < argc) batchDocs = std::max(1, std::stoi(argv[++i]));
+        else if (opt == "--quiet") quiet = true;
+        else if (opt == "--metrics" && i + 1 < argc) metricsFile = argv[++i];
+        else if (opt == "--trace" && i + 1 < argc) traceFile = argv[++i];
+        else if (opt == "--phrases" && i + 1 < argc) phrasesFile = argv[++i];
+        else if (opt == "--phrase-words" && i + 1 < argc) phraseWords = std::max(1, std::min(4, std::stoi(argv[++i])));
+        else if (opt == "--phrase-min-count" && i + 1 < argc) phraseMinCount = std::max(1, std::stoi(argv[++i]));
+        else if (opt == "--phrase-max-entries" && i + 1 < argc) phraseMaxEntries = std::stoull(argv[++i]);
+        else if (opt == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if (opt == "--memory-report") memoryReport = true;
+    }
+    if (!dedupMode.empty() && dedupMode != "drop" && dedupMode != "collapse") {
+        std::cerr << "ERROR: --dedup must be drop or collapse\n";
+        return 1;
+    }
+    if (!traceFile.empty()) tracer().start();
+    MemoryReport memory(memoryReport, memoryBudget);
 
     // -------------------- Load Lexicon JSON --------------------
+    TraceSpan lexiconSpan("load_lexicon", "build", lexiconFile);
     std::ifstream lexIn(lexiconFile);
     json lexJson;
     lexIn >> lexJson;
 
-    std::unordered_map<std::string,int> lexiconMap;
+    FlatTermMap<int> lexiconMap;
 
     int id = 1;
     for (const auto& w : lexJson["lexicon"]) {
         lexiconMap[w.get<std::string>()] = id++;
     }
+    const bool stripAccents = lexiconStripsAccents(lexJson);   // split words as the lexicon did
+    memory.structure("lexicon JSON DOM (freed)", heapBytes(lexJson));
+    lexJson = json();
+    lexiconSpan.end();
+
+    std::cout << "Loaded lexicon size: " << lexiconMap.size() << (stripAccents ? " (accents stripped)" : "") << "\n";
+    memory.structure("lexicon map (FlatTermMap)", lexiconMap.memoryBytes());
+    memory.stage("load_lexicon");
+
+    // -------------------- Open streaming output --------------------
+    // Each document is written as soon as it is tokenized, so memory does
+    // not grow with the corpus and output reaches disk during the run.
+    BufferedWriter out;
+    if (!out.open(outputFile)) {
+        std::cerr << "ERROR: Cannot open output file\n";
+        return 1;
+    }
+    RecordWriter writer(out, format);
+
+    // MessagePack output is a plain sequence of document records
+    if (format != OutputFormat::MsgPack) {
+        writer.beginObject();
+        writer.key("documents");
+        writer.beginArray();
+    }
 
-    std::cout << "Loaded lexicon size: " << lexiconMap.size() << "\n";
+    // -------------------- Optional document store --------------------
+    DocStoreWriter docStore;
+    bool storeDocs = !docStoreFile.empty();
+    if (storeDocs && !docStore.open(docStoreFile)) {
+        std::cerr << "ERROR: Cannot open document store file\n";
+        return 1;
+    }
 
-    // -------------------- Prepare Forward Index JSON --------------------
-    json forwardIndex;
-    forwardIndex["documents"] = json::array();
+    // -------------------- Optional binary forward index --------------------
+    ForwardIndexWriter binaryForward;
+    bool writeBinary = !binaryForwardFile.empty();
+    if (writeBinary && !binaryForward.open(binaryForwardFile, lexiconMap.size())) {
+        std::cerr << "ERROR: Cannot open binary forward index file\n";
+        return 1;
+    }
+
+    // -------------------- Optional attribute columns --------------------
+    DocAttributesWriter attributes;
+    bool writeAttributes = !attributesFile.empty();
+    if (writeAttributes && !attributes.open(attributesFile)) {
+        std::cerr << "ERROR: Cannot open attribute file\n";
+        return 1;
+    }
+    std::unordered_map<std::string, uint16_t> publishYears;
+    if (!metadataFile.empty()) {
+        if (!loadPublishYears(metadataFile, publishYears)) {
+            std::cerr << "ERROR: Cannot read sha/publish_time from " << metadataFile << "\n";
+            return 1;
+        }
+        std::cout << "Loaded publish years for " << publishYears.size() << " papers\n";
+    }
+    uint64_t datedDocs = 0;
+
+    // -------------------- Optional near-duplicate detection --------------------
+    // drop:     duplicates leave no trace in any output
+    // collapse: duplicates get no postings of their own but keep their
+    //           docID in the document store and attribute columns
+    // Either way duplicates.json maps each one to its canonical docID, so
+    // build_inverted_index can skip the same documents.
+    bool dedup = !dedupMode.empty();
+    NearDuplicateIndex nearDuplicates(dedupThreshold);
+    json duplicates = json::object();
+    uint64_t postingsSaved = 0, tokensSaved = 0;
+
+    // -------------------- Optional query completion index --------------------
+    // Word n-grams of every indexed (non-duplicate) document, counted from
+    // the same title and text the document store keeps. Under
+    // --memory-budget the table gets at most half of what the budget
+    // leaves, and prunes sooner instead of growing past it.
+    bool countPhrases = !phrasesFile.empty();
+    if (countPhrases && memoryBudget) {
+        size_t budgetEntries = memoryHeadroom(memoryBudget) / 2 / PHRASE_ENTRY_BYTES;
+        if (budgetEntries < phraseMaxEntries) {
+            phraseMaxEntries = budgetEntries;
+            std::cout << "Memory budget " << formatBytes(memoryBudget) << ": completion counter capped at "
+                      << phraseMaxEntries << " phrases\n";
+        }
+    }
+    PhraseCounter phrases(phraseWords, phraseMinCount, phraseMaxEntries, stripAccents);
 
     int docID = 0;
+    std::chrono::steady_clock::duration writeTime{}, tokenizeTime{};
+    uint64_t bytesRead = 0, bytesTokenized = 0;
+    uint64_t tokenizeAllocations = 0;
+
+    // -------------------- Metrics --------------------
+    Counter& filesMetric     = metrics().counter("build_files_total", "Documents tokenized");
+    Counter& bytesMetric     = metrics().counter("build_bytes_read_total", "Bytes read from the dataset");
+    Counter& tokensMetric    = metrics().counter("build_tokens_total", "Tokens counted");
+    Histogram& tokenizeLatency = metrics().histogram("build_tokenize_seconds", "Tokenizing one document");
+    Histogram& emitLatency     = metrics().histogram("build_emit_seconds", "Writing one document to every output");
+    Histogram& commitLatency   = metrics().histogram("build_checkpoint_commit_seconds", "Committing one checkpoint segment");
+    auto buildStart = std::chrono::steady_clock::now();
+
+    // -------------------- Emit one document to every output --------------------
+    auto emit = [&](const DocumentRecord& doc) {
+        ScopedTimer timer(emitLatency);
+        TraceSpan span("emit");
+        if (doc.canonical) {
+            duplicates[std::to_string(doc.docID)] = doc.canonical;
+            postingsSaved += doc.distinctTerms;
+            tokensSaved += doc.docLength;
+            if (dedupMode == "drop") return;
+        }
 
-    std::vector<fs::path> files;
+        if (storeDocs) docStore.add(doc.docID, doc.path, doc.title, doc.storedText);
 
-    // -------------------- Traverse dataset --------------------
-    for (auto& entry : fs::recursive_directory_iterator(datasetDir)) {
+        if (writeAttributes) {
+            // CORD-19 papers are <sha>.json (PMC ones <id>.xml.json)
+            std::string stem = fs::path(doc.path).filename().string();
+            stem = stem.substr(0, stem.find('.'));
+            auto year = publishYears.find(stem);
+            uint16_t y = year == publishYears.end() ? 0 : year->second;
+            if (y) datedDocs++;
+            attributes.add(doc.docID, docExtension(doc.path), docDirectory(doc.path, datasetDir), y);
+        }
+        if (doc.canonical) return; // collapsed: stored, but no postings
 
-        if (!fs::is_regular_file(entry.path()) || !isReadableFile(entry.path()))
-            continue;
-        if (fs::is_regular_file(entry.path()) && isReadableFile(entry.path()))
-        files.push_back(entry.path());
+        if (countPhrases) {
+            TraceSpan phraseSpan("count_phrases");
+            phrases.addText(doc.title);
+            phrases.addText(doc.storedText);
+        }
+        if (writeBinary) binaryForward.add(doc.docID, doc.terms, doc.docLength);
+
+        // -------------------- Write document entry --------------------
+        auto w0 = std::chrono::steady_clock::now();
+
+        writer.beginObject(3);
+        writer.key("doc_id");
+        writer.value(doc.docID);
+        writer.key("file");
+        writer.value(doc.path);
+        writer.key("terms");
+        writer.beginObject(doc.terms.size());
+        for (auto& [lexID, freq] : doc.terms) {
+            writer.key(lexID);
+            writer.value(freq);
+        }
+        writer.endObject();
+        writer.endObject();
+
+        writeTime += std::chrono::steady_clock::now() - w0;
+    };
+
+    // -------------------- Optional checkpointing --------------------
+    // Records are held back in segment files and emitted by the merge
+    // below; a restart with the same options skips committed documents
+    BuildCheckpoint checkpoint;
+    SegmentWriter segment;
+    std::string checkpointError;
+    uint64_t resumedDocs = 0;
+    bool checkpointing = !checkpointDir.empty();
+    // Under --memory-budget a batch is also committed once its encoded
+    // records take a quarter of what the budget leaves
+    uint64_t segmentLimit = checkpointing && memoryBudget
+        ? std::max<uint64_t>(memoryHeadroom(memoryBudget) / 4, 1 << 20) : 0;
+    if (checkpointing) {
+        // Anything that changes the records must match on resume
+        std::string settings = "build_forward_index lexicon=" + lexiconFile + "#" + fileIdentity(lexiconFile) +
+            " raw-json=" + std::to_string(!cord19Json) + " archive-order=" + std::to_string(archiveOrder) +
+            " store=" + std::to_string(storeDocs) + (countPhrases ? " phrases=1" : "") + " dedup=" + dedupMode + "@" + std::to_string(dedupThreshold);
+        if (!checkpoint.open(checkpointDir, settings, datasetDir, batchDocs, checkpointError)) {
+            std::cerr << "ERROR: " << checkpointError << "\n";
+            return 1;
+        }
 
-    // Sort files alphabetically for deterministic docID assignment
-    std::sort(files.begin(), files.end());
-        docID++;
+        // Committed canonical documents go back into the near-duplicate
+        // index, so the rest of the run sees the same candidates
+        for (size_t i = 0; dedup && i < checkpoint.segmentCount(); i++) {
+            SegmentReader reader;
+            DocumentRecord doc;
+            if (!reader.open(checkpoint.segmentPath(i))) {
+                std::cerr << "ERROR: Cannot read checkpoint segment " << checkpoint.segmentPath(i) << "\n";
+                return 1;
+            }
+            while (loadRecord(reader, doc))
+                if (doc.hasSignature) nearDuplicates.check(doc.docID, doc.signature);
+        }
+        if (checkpoint.committedDocs() > 0)
+            std::cout << "Resuming: " << checkpoint.committedDocs() << " documents in "
+                      << checkpoint.segmentCount() << " committed segments\n";
+    }
 
-        std::ifstream fin(entry.path());
-        if (!fin) continue;
+    // One term map and record for the whole run, reset per document
+    FlatTermMap<int> localTF;
+    DocumentRecord doc;
 
-        std::string content(
-            (std::istreambuf_iterator<char>(fin)),
-             std::istreambuf_iterator<char>()
-        );
-        fin.close();
+    // -------------------- Traverse dataset --------------------
+    auto skipCommitted = [&](int documentID, const std::string& path) {
+        docID = std::max(docID, documentID);
+        resumedDocs++;
+        if (checkpointError.empty()) checkpoint.skip(documentID, path, checkpointError);
+    };
+    bool readOk = forEachDocument(datasetDir, archiveOrder, checkpoint.committedDocs(), skipCommitted,
+        [&](int documentID, const std::string& path, const std::string& content) {
+        if (!checkpointError.empty()) return;
+        TraceSpan documentSpan("document", "build", path);
+        docID = std::max(docID, documentID);
+        bytesRead += content.size();
+        bytesMetric.add(content.size());
+        if (checkpointing) checkpoint.add(documentID, path);
 
         // -------------------- Local term frequency --------------------
-        std::unordered_map<std::string,int> localTF;
-        tokenize(content, localTF);
+        bool keepText = storeDocs || dedup || countPhrases;
+        TraceSpan tokenizeSpan("tokenize");
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t allocationsBefore = heapAllocations().load(std::memory_order_relaxed);
+        localTF.reset();
+        bytesTokenized += tokenizeDocument(fs::path(path), content, cord19Json, localTF,
+                                           keepText ? &doc.title : nullptr,
+                                           keepText ? &doc.storedText : nullptr, stripAccents);
+        tokenizeAllocations += heapAllocations().load(std::memory_order_relaxed) - allocationsBefore;
+        auto tokenizeElapsed = std::chrono::steady_clock::now() - t0;
+        tokenizeTime += tokenizeElapsed;
+        tokenizeLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(tokenizeElapsed).count());
+        filesMetric.add();
+        tokenizeSpan.end();
+
+        doc.docID = documentID;
+        doc.path = path;
+        doc.canonical = 0;
+        doc.hasSignature = false;
+        TraceSpan dedupSpan("minhash");
+        if (dedup && minhashSignature(doc.title + "\n" + doc.storedText, 5, doc.signature, stripAccents)) {
+            doc.canonical = nearDuplicates.check(documentID, doc.signature);
+            doc.hasSignature = doc.canonical == 0;
+        }
+        dedupSpan.end();
 
         // -------------------- Convert words → lexicon IDs --------------------
-        json termsObj = json::object();
+        TraceSpan lookupSpan("lexicon_lookup");
+        doc.terms.clear();
+        doc.docLength = 0;
+        doc.distinctTerms = localTF.size();
+        for (auto p : localTF) {
+            doc.docLength += p.second;
+            if (const int* lexID = lexiconMap.find(p.first))
+                doc.terms.push_back({(uint32_t)*lexID, (uint32_t)p.second});
+        }
+        std::sort(doc.terms.begin(), doc.terms.end());
+        tokensMetric.add(doc.docLength);
+        lookupSpan.end();
+
+        if (!checkpointing) {
+            emit(doc);
+        } else {
+            saveRecord(segment, doc, storeDocs || countPhrases);
+            if (segment.recordCount() >= batchDocs || (segmentLimit && segment.bytes() > segmentLimit)) {
+                ScopedTimer timer(commitLatency);
+                TraceSpan commitSpan("checkpoint_commit");
+                if (!checkpoint.commit(segment))
+                    checkpointError = "Cannot commit checkpoint segment in " + checkpointDir;
+                segment.clear();
+            }
+        }
 
-        for (auto& p : localTF) {
-            const std::string& word = p.first;
-            int freq = p.second;
+        if (quiet) return;
+        if (doc.canonical) std::cout << "Duplicate: " << path << " (of doc " << doc.canonical << ")\n";
+        else std::cout << "Indexed: " << path << "\n";
+    });
 
-            if (lexiconMap.count(word)) {
-                int lexID = lexiconMap[word];
-                termsObj[std::to_string(lexID)] = freq;
+    if (!readOk) {
+        std::cerr << "ERROR: Cannot read dataset " << datasetDir << "\n";
+        return 1;
+    }
+
+    // -------------------- Merge checkpoint segments --------------------
+    if (checkpointing) {
+        TraceSpan mergeSpan("merge_segments");
+        if (checkpointError.empty()) checkpoint.resumeComplete(checkpointError);
+        if (checkpointError.empty() && !segment.empty() && !checkpoint.commit(segment))
+            checkpointError = "Cannot commit checkpoint segment in " + checkpointDir;
+        if (!checkpointError.empty()) {
+            std::cerr << "ERROR: " << checkpointError << "\n";
+            return 1;
+        }
+        for (size_t i = 0; i < checkpoint.segmentCount(); i++) {
+            SegmentReader reader;
+            if (!reader.open(checkpoint.segmentPath(i))) {
+                std::cerr << "ERROR: Cannot read checkpoint segment " << checkpoint.segmentPath(i) << "\n";
+                return 1;
             }
+            while (loadRecord(reader, doc)) emit(doc);
         }
+    }
 
-        // -------------------- Add document entry --------------------
-        json d;
-        d["doc_id"] = docID;
-        d["file"]   = entry.path().string();
-        d["terms"]  = termsObj;
+    if (format != OutputFormat::MsgPack) {
+        writer.endArray();
+        writer.endObject();
+    }
+    if (memory.enabled()) {
+        if (countPhrases) memory.structure("phrase counter (" + std::to_string(phrases.size()) + " phrases)", phrases.memoryBytes());
+        if (dedup) memory.structure("near-duplicate index", nearDuplicates.memoryBytes());
+        if (dedup) memory.structure("duplicates JSON DOM", heapBytes(duplicates));
+        if (!publishYears.empty()) memory.structure("publish years", heapBytes(publishYears));
+    }
+    memory.stage(checkpointing ? "tokenize_and_merge" : "tokenize_and_emit");
 
-        forwardIndex["documents"].push_back(d);
+    TraceSpan finishSpan("finish_outputs");
+    auto w0 = std::chrono::steady_clock::now();
+    uint64_t outBytes = out.bytesWritten();
+    if (!out.close()) {
+        std::cerr << "ERROR: Failed while writing " << outputFile << "\n";
+        return 1;
+    }
+    writeTime += std::chrono::steady_clock::now() - w0;
 
-        std::cout << "Indexed: " << entry.path().string() << "\n";
+    if (writeBinary && !binaryForward.finish()) {
+        std::cerr << "ERROR: Failed while writing " << binaryForwardFile << "\n";
+        return 1;
+    }
+    if (storeDocs && !docStore.finish()) {
+        std::cerr << "ERROR: Failed while writing " << docStoreFile << "\n";
+        return 1;
     }
+    if (writeAttributes && !attributes.finish()) {
+        std::cerr << "ERROR: Failed while writing " << attributesFile << "\n";
+        return 1;
+    }
+    std::vector<PhraseCompletion> frequentPhrases;
+    uint64_t phraseBytes = 0;
+    if (countPhrases) {
+        frequentPhrases = phrases.frequent();
+        if (!writePhraseIndex(phrasesFile, frequentPhrases, phrases.wordsPerPhrase(),
+                              phrases.minimumCount(), &phraseBytes)) {
+            std::cerr << "ERROR: Failed while writing " << phrasesFile << "\n";
+            return 1;
+        }
+    }
+    if (dedup) {
+        std::ofstream dupOut(duplicatesFile);
+        dupOut << json{{"mode", dedupMode}, {"threshold", dedupThreshold}, {"duplicates", duplicates}}.dump(4);
+        if (!dupOut) {
+            std::cerr << "ERROR: Cannot write " << duplicatesFile << "\n";
+            return 1;
+        }
+    }
+    finishSpan.end();
+    memory.stage("finish_outputs");
 
-    // -------------------- Save Forward Index JSON --------------------
-    std::ofstream out(outputFile);
-    out << forwardIndex.dump(4);
-    out.close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
 
     std::cout << "\n✓ Forward index built successfully.\n";
     std::cout << "✓ Documents indexed: " << docID << "\n";
-    std::cout << "✓ Output: " << outputFile << "\n";
+    std::cout << "✓ Throughput: " << (uint64_t)(filesMetric.value() / seconds) << " files/s, "
+              << bytesMetric.value() / 1e6 / seconds << " MB/s read, "
+              << (uint64_t)(tokensMetric.value() / seconds) << " tokens/s\n";
+    std::cout << "✓ Bytes tokenized: " << bytesTokenized << " of " << bytesRead << " read ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(tokenizeTime).count() << " ms, "
+              << tokenizeAllocations << " heap allocations)\n";
+    std::cout << "✓ Output: " << outputFile << " (" << outBytes << " bytes, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(writeTime).count()
+              << " ms writing)\n";
+    if (writeBinary) {
+        std::cout << "✓ Binary forward index: " << binaryForwardFile << " ("
+                  << binaryForward.fileBytes() << " bytes)\n";
+    }
+    if (countPhrases) {
+        std::cout << "✓ Completion index: " << phrasesFile << " (" << frequentPhrases.size()
+                  << " phrases of up to " << phrases.wordsPerPhrase() << " words seen >= "
+                  << phrases.minimumCount() << " times, " << phraseBytes << " bytes";
+        if (phrases.pruneCount()) std::cout << ", pruned " << phrases.pruneCount() << " times";
+        std::cout << ")\n";
+    }
+    if (storeDocs) {
+        std::cout << "✓ Document store: " << docStoreFile << " (" << docStore.fileBytes()
+                  << " bytes for " << docStore.rawBytes() << " bytes of text)\n";
+    }
+    if (dedup) {
+        // Every skipped (doc, term) pair is one posting the inverted index,
+        // the barrels and search_index.bin no longer carry
+        std::cout << "✓ Near-duplicates (" << dedupMode << ", similarity >= " << dedupThreshold << "): "
+                  << duplicates.size() << " of " << docID << " documents, "
+                  << nearDuplicates.candidateChecks() << " candidate checks\n";
+        std::cout << "✓ Index savings: " << postingsSaved << " postings (~"
+                  << postingsSaved * sizeof(Posting) << " bytes in search_index.bin), "
+                  << tokensSaved << " tokens; list in " << duplicatesFile << "\n";
+    }
+    if (checkpointing) {
+        std::cout << "✓ Checkpoint: " << checkpoint.segmentCount() << " segments in " << checkpointDir
+                  << " (" << resumedDocs << " documents resumed)\n";
+    }
+    if (writeAttributes) {
+        std::cout << "✓ Attributes: " << attributesFile << " (" << attributes.extensionCount()
+                  << " extensions, " << attributes.directoryCount() << " directories, "
+                  << datedDocs << " docs with a publish year)\n";
+    }
+    memory.print(std::cout);
+    memory.warnOverBudget();
+    if (!metricsFile.empty()) {
+        if (!metrics().writeFile(metricsFile)) {
+            std::cerr << "ERROR: Cannot write " << metricsFile << "\n";
+            return 1;
+        }
+        std::cout << "✓ Metrics: " << metricsFile << "\n";
+    }
+    if (!traceFile.empty()) {
+        uint64_t events = 0, dropped = 0;
+        if (!tracer().write(traceFile, &events, &dropped)) {
+            std::cerr << "ERROR: Cannot write " << traceFile << "\n";
+            return 1;
+        }
+        std::cout << "✓ Trace: " << traceFile << " (" << events << " spans"
+                  << (dropped ? ", " + std::to_string(dropped) + " oldest dropped" : "") << ")\n";
+    }
 
     return 0;
 }
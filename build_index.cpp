@@ -0,0 +1,76 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include "search_engine.h"
+#include "memory_usage.h"
+
+// -------------------- Main --------------------
+// One-step build of an index directory through IndexWriter, for
+// collections that fit in memory. The multi-stage tools stay the way to
+// build large collections.
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: build_index <dataset_directory|dataset.tar.gz> <index_directory>\n"
+                  << "       [--raw-json] [--no-docs] [--no-attributes] [--metadata <metadata.csv>]\n"
+                  << "       [--strip-accents] [--bitmap-threshold <docs>] [--tier-size <postings>]\n"
+                  << "       [--phrase-words <n, 0 for no completions.bin>] [--phrase-min-count <n>]\n"
+                  << "       [--memory-budget <MB>] [--memory-report]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string outDir = argv[2];
+    IndexWriterOptions options;
+    options.shared.log = &std::cout;
+    uint64_t memoryBudget = 0;
+    bool memoryReport = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--raw-json") options.cord19Json = false;
+        else if (arg == "--no-docs") options.storeDocuments = false;
+        else if (arg == "--no-attributes") options.writeAttributes = false;
+        else if (arg == "--metadata" && i + 1 < argc) options.metadataFile = argv[++i];
+        else if (arg == "--strip-accents") options.stripAccents = true;
+        else if (arg == "--bitmap-threshold" && i + 1 < argc) options.shared.bitmapThreshold = std::stoul(argv[++i]);
+        else if (arg == "--tier-size" && i + 1 < argc) options.shared.tierSize = std::stoul(argv[++i]);
+        else if (arg == "--phrase-words" && i + 1 < argc) options.phraseWords = std::min(4, std::stoi(argv[++i]));
+        else if (arg == "--phrase-min-count" && i + 1 < argc) options.phraseMinCount = std::stoul(argv[++i]);
+        else if (arg == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if (arg == "--memory-report") memoryReport = true;
+    }
+    MemoryReport memory(memoryReport, memoryBudget);
+
+    // The postings stay in memory by design; only the phrase table can
+    // be held back, as build_forward_index does under a budget
+    if (memoryBudget && options.phraseWords > 0) {
+        size_t budgetEntries = memoryHeadroom(memoryBudget) / 4 / PHRASE_ENTRY_BYTES;
+        if (budgetEntries < options.phraseMaxEntries) {
+            options.phraseMaxEntries = budgetEntries;
+            std::cout << "Memory budget " << formatBytes(memoryBudget) << ": completion counter capped at "
+                      << budgetEntries << " phrases\n";
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    IndexWriter writer;
+    std::string error;
+    if (!writer.open(outDir, error, options) || !writer.addAll(input, error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Indexed " << writer.documents() << " documents, "
+              << writer.termCount() << " distinct words\n";
+    if (memory.enabled()) memory.structure("postings, terms and phrases (IndexWriter)", writer.memoryBytes());
+    memory.stage("add_documents");
+
+    if (!writer.commit(error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "✓ Index directory: " << outDir << " (" << elapsed << " s)\n";
+    memory.stage("commit");
+    memory.print(std::cout);
+    memory.warnOverBudget();
+    return 0;
+}
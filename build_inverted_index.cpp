@@ -4,112 +4,419 @@
 #include <unordered_set>
 #include <string>
 #include <filesystem>
-#include <regex>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <functional>
 #include "nlohmann/json.hpp"
+#include "stream_writer.h"
+#include "cord19_reader.h"
+#include "document_source.h"
+#include "term_arena.h"
+#include "index_files.h"
+#include "document_text.h"
+#include "checkpoint.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_usage.h"
+#include "alloc_counter.h"
 
 using json = nlohmann::json;
-namespace fs = std::filesystem;
-
-// -------------------- File Filter --------------------
-bool isReadableFile(const fs::path& p) {
-    std::string ext = p.extension().string();
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-
-    return ext == ".txt" || ext == ".json" || ext == ".csv" ||
-           ext == ".xml" || ext == ".html" || ext == ".md" ||
-           ext == ".log" || ext == ".tsv" || ext == ".yaml" ||
-           ext == ".ini" || ext == ".cfg";
-}
-
-// -------------------- Tokenizer --------------------
-void tokenize(const std::string& text, std::unordered_map<std::string,int>& termFreq) {
-    static const std::regex wordRegex("[A-Za-z0-9]+");
-    auto begin = std::sregex_iterator(text.begin(), text.end(), wordRegex);
-    auto end = std::sregex_iterator();
-
-    for (auto it = begin; it != end; ++it) {
-        std::string word = it->str();
-        std::transform(word.begin(), word.end(), word.begin(), ::tolower);
-        termFreq[word]++;
-    }
-}
 
 int main(int argc, char* argv[]) {
     if (argc < 4) {
-        std::cout << "Usage: build_inverted_index <dataset_folder> <lexicon_json> <output_json>\n";
+        std::cout << "Usage: build_inverted_index <dataset_folder|release.tar.gz> <lexicon_json> <output_json>\n"
+                  << "       [--compact|--binary] [--raw-json] [--archive-order]\n"
+                  << "       [--duplicates <duplicates.json>] [--checkpoint <dir> [--batch <docs>]]\n"
+                  << "       [--memory-budget <MB>] [--memory-report]\n"
+                  << "       [--quiet] [--metrics <metrics.json|metrics.prom>] [--trace <trace.json>]\n";
         return 1;
     }
 
     std::string datasetDir = argv[1];
     std::string lexiconFile = argv[2];
     std::string outputFile = argv[3];
+    OutputFormat format = parseOutputFormat(argc, argv, 4);
+    bool cord19Json = true;
+    bool archiveOrder = false;
+    std::string duplicatesFile;
+    std::string checkpointDir;
+    uint32_t batchDocs = 1000;
+    bool quiet = false;
+    std::string metricsFile, traceFile;
+    uint64_t memoryBudget = 0;
+    bool memoryReport = false;
+    for (int i = 4; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt == "--raw-json") cord19Json = false;
+        else if (opt == "--archive-order") archiveOrder = true;
+        else if (opt == "--duplicates" && i + 1 < argc) duplicatesFile = argv[++i];
+        else if (opt == "--checkpoint" && i + 1 < argc) checkpointDir = argv[++i];
+        else if (opt == "--batch" && i + 1 < argc) batchDocs = std::max(1, std::stoi(argv[++i]));
+        else if (opt == "--quiet") quiet = true;
+        else if (opt == "--metrics" && i + 1 < argc) metricsFile = argv[++i];
+        else if (opt == "--trace" && i + 1 < argc) traceFile = argv[++i];
+        else if (opt == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if (opt == "--memory-report") memoryReport = true;
+    }
+    if (!traceFile.empty()) tracer().start();
+    MemoryReport memory(memoryReport, memoryBudget);
+
+    // -------------------- Near-duplicates to skip --------------------
+    // Written by build_forward_index --dedup; docIDs match because both
+    // builders number the same walk of the dataset
+    std::unordered_set<int> skipDocs;
+    if (!duplicatesFile.empty()) {
+        std::ifstream dupIn(duplicatesFile);
+        if (!dupIn) { std::cerr << "ERROR: Cannot open duplicates file\n"; return 1; }
+        json dupJson; dupIn >> dupJson;
+        for (auto& [dupID, canonical] : dupJson["duplicates"].items()) skipDocs.insert(std::stoi(dupID));
+        std::cout << "Skipping " << skipDocs.size() << " near-duplicate documents\n";
+    }
 
     // -------------------- Load Lexicon --------------------
+    TraceSpan lexiconSpan("load_lexicon", "build", lexiconFile);
     std::ifstream lexIn(lexiconFile);
     if (!lexIn) { std::cerr << "ERROR: Cannot open lexicon file\n"; return 1; }
     json lexJson; lexIn >> lexJson;
 
-    std::unordered_map<std::string,int> lexiconMap;
+    FlatTermMap<int> lexiconMap;
     int id = 1;
     for (const auto& w : lexJson["lexicon"]) lexiconMap[w.get<std::string>()] = id++;
+    const bool stripAccents = lexiconStripsAccents(lexJson);   // split words as the lexicon did
+    memory.structure("lexicon JSON DOM (freed)", heapBytes(lexJson));
+    lexJson = json();
+    lexiconSpan.end();
 
-    std::cout << "Loaded lexicon size: " << lexiconMap.size() << "\n";
+    std::cout << "Loaded lexicon size: " << lexiconMap.size() << (stripAccents ? " (accents stripped)" : "") << "\n";
+    memory.structure("lexicon map (FlatTermMap)", lexiconMap.memoryBytes());
+    memory.structure("near-duplicate skip set", heapBytes(skipDocs));
+    memory.stage("load_lexicon");
 
     // -------------------- Build Inverted Index --------------------
-    std::unordered_map<int, std::unordered_map<int,int>> invertedIndex;
+    // Documents normally arrive in docID order, so each posting list is
+    // appended already sorted and needs no per-term hash map.
+    using PostingLists = std::unordered_map<int, std::vector<std::pair<int,int>>>;
+    PostingLists invertedIndex;
+    uint64_t postingBytes = 0;  // capacity of the lists in invertedIndex
+    uint64_t peakHeld = 0;      // largest heldBytes() seen
     int docID = 0;
+    bool inOrder = true;
+    uint64_t bytesRead = 0, bytesTokenized = 0;
+    uint64_t tokenizeAllocations = 0;
+    std::chrono::steady_clock::duration tokenizeTime{};
+    FlatTermMap<int> localTF;   // reused, reset per document
 
-    std::vector<fs::path> files;std::vector<fs::path> files;
-    for (auto& entry : fs::recursive_directory_iterator(datasetDir)) {
-        if (!fs::is_regular_file(entry.path()) || !isReadableFile(entry.path()))
-            continue;
-
-          if (fs::is_regular_file(entry.path()) && isReadableFile(entry.path()))
-        files.push_back(entry.path());
-
-    // Sort files alphabetically for deterministic docID assignment
-    std::sort(files.begin(), files.end());
-        docID++;
-        std::ifstream fin(entry.path());
-        if (!fin) continue;
-
-        std::string content((std::istreambuf_iterator<char>(fin)),
-                             std::istreambuf_iterator<char>());
-        fin.close();
-
-        std::unordered_map<std::string,int> localTF;
-        tokenize(content, localTF);
-
-        for (auto& p : localTF) {
-            const std::string& word = p.first;
-            int freq = p.second;
-            if (lexiconMap.count(word)) {
-                int lexID = lexiconMap[word];
-                invertedIndex[lexID][docID] = freq;
-            }
+    // Estimated heap of the in-memory lists, nodes and buckets included
+    auto heldBytes = [&]() {
+        return postingBytes + invertedIndex.size() * hashNodeBytes<PostingLists>() +
+               invertedIndex.bucket_count() * sizeof(void*);
+    };
+
+    // -------------------- Metrics --------------------
+    Counter& filesMetric     = metrics().counter("build_files_total", "Documents tokenized");
+    Counter& bytesMetric     = metrics().counter("build_bytes_read_total", "Bytes read from the dataset");
+    Counter& tokensMetric    = metrics().counter("build_tokens_total", "Tokens counted");
+    Counter& postingsMetric  = metrics().counter("build_postings_total", "Postings appended");
+    Histogram& tokenizeLatency = metrics().histogram("build_tokenize_seconds", "Tokenizing one document");
+    Histogram& commitLatency   = metrics().histogram("build_checkpoint_commit_seconds", "Committing one checkpoint segment");
+    auto buildStart = std::chrono::steady_clock::now();
+
+    // -------------------- Optional checkpointing --------------------
+    // Postings of the current batch collect in invertedIndex and are
+    // committed as one segment; the merge below appends the segments in
+    // order, which is the order an uninterrupted run appends them in
+    BuildCheckpoint checkpoint;
+    SegmentWriter segment;
+    size_t segmentDocs = 0;                 // documents in the batch in progress
+    std::string checkpointError;
+    uint64_t resumedDocs = 0;
+    bool checkpointing = !checkpointDir.empty();
+    if (checkpointing) {
+        std::string settings = "build_inverted_index lexicon=" + lexiconFile + "#" + fileIdentity(lexiconFile) +
+            " raw-json=" + std::to_string(!cord19Json) + " archive-order=" + std::to_string(archiveOrder) +
+            " duplicates=" + duplicatesFile;
+        if (!checkpoint.open(checkpointDir, settings, datasetDir, batchDocs, checkpointError)) {
+            std::cerr << "ERROR: " << checkpointError << "\n";
+            return 1;
         }
+        if (checkpoint.committedDocs() > 0)
+            std::cout << "Resuming: " << checkpoint.committedDocs() << " documents in "
+                      << checkpoint.segmentCount() << " committed segments\n";
+    }
 
-        std::cout << "Processed: " << entry.path().string() << "\n";
+    // -------------------- Spilling under --memory-budget --------------------
+    // Once the lists in memory would outgrow what the budget leaves after
+    // the lexicon, they are written out as a segment, exactly like a
+    // checkpoint batch. Without --checkpoint the segments are scratch
+    // files next to the output, removed once it is written. Half the
+    // headroom is the limit: a list that grows doubles its capacity, and
+    // the encoded segment needs room while it is written.
+    static const uint64_t MIN_SPILL_BYTES = 4 << 20;
+    uint64_t spillLimit = 0;
+    std::string spillDir;
+    std::vector<std::string> spillRuns;
+    if (memoryBudget) {
+        spillLimit = std::max(memoryHeadroom(memoryBudget) / 2, MIN_SPILL_BYTES);
+        if (!checkpointing) {
+            spillDir = outputFile + ".spill";
+            std::error_code ec;
+            fs::remove_all(spillDir, ec);
+            fs::create_directories(spillDir, ec);
+            if (ec) { std::cerr << "ERROR: Cannot create spill directory " << spillDir << "\n"; return 1; }
+        }
+        std::cout << "Memory budget " << formatBytes(memoryBudget) << ": postings spill to disk past "
+                  << formatBytes(spillLimit) << "\n";
     }
+    bool segmented = checkpointing || memoryBudget;
+
+    // Segment: varint termCount, then per term termID, postingCount and
+    // (docID, freq) pairs in the order they were appended. Each list is
+    // released once encoded, so the segment does not double the peak.
+    auto commitBatch = [&]() {
+        ScopedTimer timer(commitLatency);
+        TraceSpan span("checkpoint_commit");
+        peakHeld = std::max(peakHeld, heldBytes());
+        std::vector<int> batchTerms;
+        for (auto& p : invertedIndex) batchTerms.push_back(p.first);
+        std::sort(batchTerms.begin(), batchTerms.end());
+
+        segment.clear();
+        segment.putNumber(batchTerms.size());
+        for (int termID : batchTerms) {
+            auto& postings = invertedIndex[termID];
+            segment.putNumber(termID);
+            segment.putNumber(postings.size());
+            for (auto& [doc, freq] : postings) {
+                segment.putNumber(doc);
+                segment.putNumber(freq);
+            }
+            std::vector<std::pair<int,int>>().swap(postings);
+        }
+        segment.endRecord();
+        if (checkpointing) {
+            if (!checkpoint.commit(segment))
+                checkpointError = "Cannot commit checkpoint segment in " + checkpointDir;
+        } else {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/run_%05zu.bin", spillRuns.size());
+            spillRuns.push_back(spillDir + name);
+            if (!segment.write(spillRuns.back()))
+                checkpointError = "Cannot write spill file " + spillRuns.back();
+        }
+        PostingLists().swap(invertedIndex);
+        postingBytes = 0;
+        segmentDocs = 0;
+        segment.clear();
+    };
+
+    auto skipCommitted = [&](int documentID, const std::string& path) {
+        if (documentID < docID) inOrder = false;
+        docID = std::max(docID, documentID);
+        resumedDocs++;
+        if (checkpointError.empty()) checkpoint.skip(documentID, path, checkpointError);
+    };
+    bool readOk = forEachDocument(datasetDir, archiveOrder, checkpoint.committedDocs(), skipCommitted,
+        [&](int documentID, const std::string& path, const std::string& content) {
+        if (!checkpointError.empty()) return;
+        TraceSpan documentSpan("document", "build", path);
+        if (documentID < docID) inOrder = false;
+        docID = std::max(docID, documentID);
+        bytesRead += content.size();
+        bytesMetric.add(content.size());
+        if (checkpointing) checkpoint.add(documentID, path);
+        if (skipDocs.count(documentID)) return;
+
+        TraceSpan tokenizeSpan("tokenize");
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t allocationsBefore = heapAllocations().load(std::memory_order_relaxed);
+        localTF.reset();
+        bytesTokenized += tokenizeDocument(fs::path(path), content, cord19Json, localTF,
+                                           nullptr, nullptr, stripAccents);
+        tokenizeAllocations += heapAllocations().load(std::memory_order_relaxed) - allocationsBefore;
+        auto tokenizeElapsed = std::chrono::steady_clock::now() - t0;
+        tokenizeTime += tokenizeElapsed;
+        tokenizeLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(tokenizeElapsed).count());
+        filesMetric.add();
+        tokenizeSpan.end();
+
+        TraceSpan lookupSpan("lexicon_lookup");
+        uint64_t tokens = 0, postings = 0;
+        for (auto p : localTF) {
+            tokens += p.second;
+            if (const int* lexID = lexiconMap.find(p.first)) {
+                auto& list = invertedIndex[*lexID];
+                size_t capacity = list.capacity();
+                list.push_back({documentID, p.second});
+                postingBytes += (list.capacity() - capacity) * sizeof(list[0]);
+                postings++;
+            }
+        }
+        tokensMetric.add(tokens);
+        postingsMetric.add(postings);
+        lookupSpan.end();
 
-    // -------------------- Save Inverted Index JSON --------------------
-    json outJson;
-    for (auto& p : invertedIndex) {
-        int termID = p.first;
-        outJson[std::to_string(termID)] = json::object();
-        for (auto& doc : p.second) {
-            outJson[std::to_string(termID)][std::to_string(doc.first)] = doc.second;
+        if (checkpointing) segmentDocs++;
+        if ((checkpointing && segmentDocs >= batchDocs) || (spillLimit && heldBytes() > spillLimit))
+            commitBatch();
+
+        if (!quiet) std::cout << "Processed: " << path << "\n";
+    });
+
+    if (!readOk) { std::cerr << "ERROR: Cannot read dataset " << datasetDir << "\n"; return 1; }
+
+    // With nothing spilled, a budgeted run writes straight from memory
+    if (memoryBudget && !checkpointing && spillRuns.empty()) segmented = false;
+    peakHeld = std::max(peakHeld, heldBytes());
+    bool unsaved = checkpointing ? segmentDocs > 0 : !invertedIndex.empty();
+    if (checkpointing && checkpointError.empty()) checkpoint.resumeComplete(checkpointError);
+    if (segmented && checkpointError.empty() && unsaved) commitBatch();
+    if (!checkpointError.empty()) { std::cerr << "ERROR: " << checkpointError << "\n"; return 1; }
+    memory.structure(segmented ? "postings in memory (largest batch)" : "postings in memory (whole index)", peakHeld);
+    memory.stage("tokenize_and_invert");
+
+    // -------------------- Stream Inverted Index --------------------
+    // Term records are written straight from the posting lists in termID
+    // order; no JSON copy of the index is built.
+    TraceSpan writeSpan("write_output", "build", outputFile);
+    auto w0 = std::chrono::steady_clock::now();
+
+    BufferedWriter out;
+    if (!out.open(outputFile)) { std::cerr << "ERROR: Cannot open output file\n"; return 1; }
+    RecordWriter writer(out, format);
+
+    // Archive members come in archive order, not docID order
+    auto writeTerm = [&](int termID, std::vector<std::pair<int,int>>& postings) {
+        if (!inOrder) std::sort(postings.begin(), postings.end());
+        writer.key(termID);
+        writer.beginObject(postings.size());
+        for (auto& [doc, freq] : postings) {
+            writer.key(doc);
+            writer.value(freq);
         }
+        writer.endObject();
+    };
+
+    size_t termCount = 0;
+    if (!segmented) {
+        std::vector<int> termIDs;
+        termIDs.reserve(invertedIndex.size());
+        for (auto& p : invertedIndex) termIDs.push_back(p.first);
+        std::sort(termIDs.begin(), termIDs.end());
+        termCount = termIDs.size();
+
+        writer.beginObject(termCount);
+        for (int termID : termIDs) writeTerm(termID, invertedIndex[termID]);
+        writer.endObject();
+    } else {
+        // -------------------- Merge segments --------------------
+        // Every segment lists its terms in ascending termID order, so a
+        // k-way merge writes the index one term at a time. Ties pop in
+        // segment order, which keeps each list in append order. A first
+        // pass counts the distinct terms: MessagePack needs the count up
+        // front.
+        TraceSpan mergeSpan("merge_segments");
+        std::vector<std::string> paths = spillRuns;
+        for (size_t i = 0; checkpointing && i < checkpoint.segmentCount(); i++)
+            paths.push_back(checkpoint.segmentPath(i));
+
+        std::vector<SegmentReader> readers(paths.size());
+        std::vector<bool> seen(lexiconMap.size() + 1, false);
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (!readers[i].open(paths[i])) {
+                std::cerr << "ERROR: Cannot read segment " << paths[i] << "\n";
+                return 1;
+            }
+            for (uint32_t terms = readers[i].getNumber(); terms > 0; terms--) {
+                uint32_t termID = readers[i].getNumber();
+                if (termID < seen.size() && !seen[termID]) { seen[termID] = true; termCount++; }
+                for (uint32_t n = readers[i].getNumber(); n > 0; n--) {
+                    readers[i].getNumber();
+                    readers[i].getNumber();
+                }
+            }
+        }
+
+        using Head = std::pair<uint32_t, size_t>;   // next termID, segment
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        std::vector<uint32_t> termsLeft(readers.size());
+        for (size_t i = 0; i < readers.size(); i++) {
+            readers[i].rewind();
+            termsLeft[i] = readers[i].getNumber();
+            if (termsLeft[i]) heads.push({readers[i].getNumber(), i});
+        }
+
+        std::vector<std::pair<int,int>> postings;
+        writer.beginObject(termCount);
+        while (!heads.empty()) {
+            uint32_t termID = heads.top().first;
+            postings.clear();
+            while (!heads.empty() && heads.top().first == termID) {
+                size_t i = heads.top().second;
+                heads.pop();
+                for (uint32_t n = readers[i].getNumber(); n > 0; n--) {
+                    int doc = readers[i].getNumber();
+                    int freq = readers[i].getNumber();
+                    postings.push_back({doc, freq});
+                }
+                if (--termsLeft[i]) heads.push({readers[i].getNumber(), i});
+            }
+            writeTerm(termID, postings);
+        }
+        writer.endObject();
+        memory.structure("merge buffer (longest list)", heapBytes(postings));
     }
 
-    std::ofstream out(outputFile);
-    if (!out) { std::cerr << "ERROR: Cannot open output file\n"; return 1; }
-    out << outJson.dump(4);
-    out.close();
+    uint64_t outBytes = out.bytesWritten();
+    if (!out.close()) { std::cerr << "ERROR: Failed while writing " << outputFile << "\n"; return 1; }
+    auto writeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - w0).count();
+    writeSpan.end();
+    memory.stage(segmented ? "merge_and_write" : "write_output");
+
+    if (!spillDir.empty()) {
+        std::error_code ec;
+        fs::remove_all(spillDir, ec);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
 
     std::cout << "\n✓ Inverted index built successfully.\n";
-    std::cout << "✓ Terms indexed: " << invertedIndex.size() << "\n";
-    std::cout << "✓ Output: " << outputFile << "\n";
+    std::cout << "✓ Terms indexed: " << termCount << "\n";
+    std::cout << "✓ Throughput: " << (uint64_t)(filesMetric.value() / seconds) << " files/s, "
+              << bytesMetric.value() / 1e6 / seconds << " MB/s read, "
+              << (uint64_t)(tokensMetric.value() / seconds) << " tokens/s\n";
+    std::cout << "✓ Bytes tokenized: " << bytesTokenized << " of " << bytesRead << " read ("
+              << std::chrono::duration_cast<std::chrono::milliseconds>(tokenizeTime).count() << " ms, "
+              << tokenizeAllocations << " heap allocations)\n";
+    std::cout << "✓ Output: " << outputFile << " (" << outBytes << " bytes, "
+              << writeMs << " ms writing)\n";
+    if (checkpointing) {
+        std::cout << "✓ Checkpoint: " << checkpoint.segmentCount() << " segments in " << checkpointDir
+                  << " (" << resumedDocs << " documents resumed)\n";
+    }
+    if (!spillRuns.empty()) {
+        std::cout << "✓ Spilled: " << spillRuns.size() << " runs of at most " << formatBytes(spillLimit)
+                  << " under --memory-budget, merged and removed\n";
+    }
+    memory.print(std::cout);
+    memory.warnOverBudget();
+    if (!metricsFile.empty()) {
+        if (!metrics().writeFile(metricsFile)) {
+            std::cerr << "ERROR: Cannot write " << metricsFile << "\n";
+            return 1;
+        }
+        std::cout << "✓ Metrics: " << metricsFile << "\n";
+    }
+    if (!traceFile.empty()) {
+        uint64_t events = 0, dropped = 0;
+        if (!tracer().write(traceFile, &events, &dropped)) {
+            std::cerr << "ERROR: Cannot write " << traceFile << "\n";
+            return 1;
+        }
+        std::cout << "✓ Trace: " << traceFile << " (" << events << " spans"
+                  << (dropped ? ", " + std::to_string(dropped) + " oldest dropped" : "") << ")\n";
+    }
 
     return 0;
 }
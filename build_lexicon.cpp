@@ -1,29 +1,48 @@
 #include <iostream>
 #include <fstream>
-#include <unordered_map>
-#include <sstream>
 #include <string>
 #include <io.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <vector>
+#include <cstdint>
 #include "nlohmann/json.hpp"
+#include "term_arena.h"
 using json = nlohmann::json;
 
 
 using namespace std;
 
-// Clean a word: lowercase + remove punctuation
-string cleanWord(const string& w) {
-    string result;
-    for (char c : w) {
-        if (isalnum(static_cast<unsigned char>(c)))
-            result += tolower(c);
+// -------------------- Term statistics --------------------
+// cf: occurrences in the collection, df: files containing the term.
+// Each file counts as one document.
+struct TermStats {
+    uint64_t cf = 0;
+    uint32_t df = 0;
+    uint32_t lastDoc = 0;   // last file that bumped df
+};
+
+struct Lexicon {
+    FlatTermMap<TermStats> terms;
+    uint32_t documents = 0;
+    bool stripAccents = false;  // --strip-accents
+
+    void add(string_view word) {
+        TermStats& t = terms[word];
+        t.cf++;
+        if (t.lastDoc != documents) {
+            t.df++;
+            t.lastDoc = documents;
+        }
     }
-    return result;
-}
+};
 
 // Process any text file (txt, csv, tsv, log, md)
-void processTextFile(const string& filepath, unordered_map<string, int>& lexicon) {
+// Words are split and folded by the tokenizer the index builders use
+// (forEachWord), so "α-synuclein" and "Müller" get the same entries here
+// as in the indexes. They are counted straight into the arena-backed
+// map, so no string is allocated per token.
+void processTextFile(const string& filepath, Lexicon& lexicon) {
     cout << "Reading file: " << filepath << endl;
 
     ifstream file(filepath);
@@ -31,23 +50,18 @@ void processTextFile(const string& filepath, unordered_map<string, int>& lexicon
         cout << "Error opening file: " << filepath << endl;
         return;
     }
+    lexicon.documents++;
 
     string line;
     while (getline(file, line)) {
-        stringstream ss(line);
-        string word;
-        while (ss >> word) {
-            string cleaned = cleanWord(word);
-            if (!cleaned.empty())
-                lexicon[cleaned]++;
-        }
+        forEachWord(line, [&](string_view word) { lexicon.add(word); }, lexicon.stripAccents);
     }
 
     file.close();
 }
 
 // Windows-safe recursive folder walk
-void readAllFiles(const string& path, unordered_map<string, int>& lexicon) {
+void readAllFiles(const string& path, Lexicon& lexicon) {
     struct _finddata_t data;
     intptr_t handle;
 
@@ -104,28 +118,51 @@ void readAllFiles(const string& path, unordered_map<string, int>& lexicon) {
 }
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cout << "Usage: build_lexicon <folder_or_file_path>\n";
+        std::cout << "Usage: build_lexicon <folder_or_file_path> [--strip-accents]\n";
         return 1;
     }
 
     
     std::string path = argv[1];
-
-    unordered_map<string, int> lexicon;
+    Lexicon lexicon;
+    for (int i = 2; i < argc; i++) {
+        if (std::string(argv[i]) == "--strip-accents") lexicon.stripAccents = true;
+    }
 
     cout << "Starting...\n";
 
     readAllFiles(path, lexicon);
 
-    cout << "\nFinished! Total unique words in lexicon: " << lexicon.size() << "\n";
+    cout << "\nFinished! Total unique words in lexicon: " << lexicon.terms.size() << "\n";
+
+    // -------------------- Assign lexIDs by frequency --------------------
+    // Every tool numbers words by array position (lexID = index + 1), so
+    // writing them in descending cf order gives the hot terms the small
+    // IDs and packs them together in any table indexed by lexID.
+    // Ties fall back to df, then the word, so the order is reproducible.
+    vector<pair<string_view, TermStats>> ordered;
+    ordered.reserve(lexicon.terms.size());
+    for (auto p : lexicon.terms) ordered.push_back({p.first, p.second});
+    sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+        if (a.second.cf != b.second.cf) return a.second.cf > b.second.cf;
+        if (a.second.df != b.second.df) return a.second.df > b.second.df;
+        return a.first < b.first;
+    });
 
     // -------------------- Save Lexicon JSON --------------------
+    // "cf" and "df" run parallel to "lexicon": cf[lexID - 1], df[lexID - 1]
     json lexJson;
     lexJson["lexicon"] = json::array();
-
-    // only export words (not counts)
-    for (auto& p : lexicon)
-        lexJson["lexicon"].push_back(p.first);
+    lexJson["cf"] = json::array();
+    lexJson["df"] = json::array();
+    lexJson["documents"] = lexicon.documents;
+    if (lexicon.stripAccents) lexJson["strip_accents"] = true;   // every later stage tokenizes the same way
+
+    for (auto& [word, stats] : ordered) {
+        lexJson["lexicon"].push_back(string(word));
+        lexJson["cf"].push_back(stats.cf);
+        lexJson["df"].push_back(stats.df);
+    }
 
     // write lexicon.json file
     std::ofstream out("lexicon.json");
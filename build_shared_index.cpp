@@ -0,0 +1,137 @@
+#include <iostream>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include "nlohmann/json.hpp"
+#include "shared_index_writer.h"
+#include "index_files.h"
+#include "mapped_file.h"
+#include "inverted_index_sax.h"
+#include "memory_usage.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+inline uint64_t heapBytes(const TermRecord& term) { return heapBytes(term.postings); }
+
+// -------------------- Barrel files as a BarrelSource --------------------
+// Terms in ascending lexID order, the order search_index.bin stores them in.
+// The barrel is mapped and parsed as a stream into compact per-term lists:
+// a DOM would cost about ten times the postings it holds.
+bool readJsonBarrel(const std::string& barrelsDir, int b, size_t lexiconSize,
+                    const std::function<void(uint32_t, std::vector<Posting>&)>& emit,
+                    std::string& error, uint64_t& largestBarrel) {
+    std::string path = barrelsDir + "/barrel_" + std::to_string(b) + ".json";
+    std::error_code ec;
+    if (!fs::exists(path, ec) || fs::file_size(path, ec) == 0) return true; // empty barrels may be missing
+    MappedFile in;
+    if (!in.open(path)) {
+        error = "Cannot open barrel " + path;
+        return false;
+    }
+
+    std::vector<TermRecord> records;
+    auto keep = [&](TermRecord& term) {
+        if (term.lexID >= 1 && term.lexID <= (int)lexiconSize) records.push_back(std::move(term));
+        term = TermRecord();
+        return true;
+    };
+    InvertedIndexSax<decltype(keep)> sax(keep);
+    if (!json::sax_parse(in.data(), in.data() + in.size(), &sax)) {
+        error = "Failed to parse barrel " + std::to_string(b) + ": " + sax.error;
+        return false;
+    }
+    std::sort(records.begin(), records.end(),
+              [](const TermRecord& x, const TermRecord& y) { return x.lexID < y.lexID; });
+    largestBarrel = std::max<uint64_t>(largestBarrel, heapBytes(records));
+
+    std::vector<Posting> list;
+    for (TermRecord& term : records) {
+        list.clear();
+        for (auto& [docID, freq] : term.postings) list.push_back({docID, freq});
+        std::vector<std::pair<uint32_t,uint32_t>>().swap(term.postings);
+        emit(term.lexID, list);
+    }
+    return true;
+}
+
+// -------------------- Main --------------------
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cout << "Usage: build_shared_index <lexicon.json> <barrel_mapping.json> "
+                  << "<barrels_directory> <search_index.bin>\n"
+                  << "       [--bitmap-threshold <docs>] [--tier-size <postings>]\n"
+                  << "       [--memory-budget <MB>] [--memory-report]\n";
+        return 1;
+    }
+
+    SharedIndexOptions options;
+    options.log = &std::cout;
+    uint64_t memoryBudget = 0;
+    bool memoryReport = false;
+    for (int i = 5; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bitmap-threshold" && i + 1 < argc) options.bitmapThreshold = std::stoul(argv[++i]);
+        else if (arg == "--tier-size" && i + 1 < argc) options.tierSize = std::stoul(argv[++i]);
+        else if (arg == "--memory-budget" && i + 1 < argc) memoryBudget = std::stoull(argv[++i]) << 20;
+        else if (arg == "--memory-report") memoryReport = true;
+    }
+    MemoryReport memory(memoryReport, memoryBudget);
+
+    std::string lexFile    = argv[1];
+    std::string mapFile    = argv[2];
+    std::string barrelsDir = argv[3];
+    std::string outFile    = argv[4];
+
+    std::vector<std::string> words;
+    std::unordered_map<int,int> barrelMap;
+    std::string error;
+    if (!loadLexiconWords(lexFile, words, error, nullptr, &options.stripAccents) ||
+        !loadBarrelMapping(mapFile, barrelMap, error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "Loaded lexicon size: " << words.size() << "\n";
+    std::cout << "Loaded barrel mapping: " << barrelMap.size() << " terms\n";
+    memory.structure("lexicon words", heapBytes(words));
+    memory.structure("barrel mapping (unordered_map)", heapBytes(barrelMap));
+    memory.stage("load_lexicon_and_mapping");
+
+    // Barrels from prune_index come with the full index's statistics
+    std::vector<uint32_t> docLengths, df;
+    std::string statsFile = (fs::path(barrelsDir) / "index_stats.json").string();
+    if (!loadIndexStats(statsFile, docLengths, df, error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+    if (!docLengths.empty()) {
+        if (df.size() != words.size()) {
+            std::cerr << "ERROR: " << statsFile << " does not match the lexicon\n";
+            return 1;
+        }
+        options.docLengths = &docLengths;
+        options.documentFrequencies = &df;
+        memory.structure("full index statistics", heapBytes(docLengths) + heapBytes(df));
+        std::cout << "BM25 statistics from " << statsFile << " (pruned barrels)\n";
+    }
+
+    uint64_t largestBarrel = 0;
+    auto readBarrel = [&](int b, const std::function<void(uint32_t, std::vector<Posting>&)>& emit,
+                          std::string& err) {
+        return readJsonBarrel(barrelsDir, b, words.size(), emit, err, largestBarrel);
+    };
+    if (!writeSharedIndex(words, barrelMap, readBarrel, outFile, options, error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+    memory.structure("largest barrel, parsed", largestBarrel);
+    memory.stage("pack_postings");
+    memory.print(std::cout);
+    memory.warnOverBudget();
+    return 0;
+}
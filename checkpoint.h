@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "varint.h"
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------
+// Checkpointed builds
+//
+// A long build commits its work in batches. Each batch goes to its own
+// segment file in the checkpoint directory, and manifest.jsonl gets one
+// line per committed segment:
+//
+// {"tool":"forward","input":"<dataset>","batch":1000}
+// {"file":"segment_00000.bin","first_doc":1,"last_doc":1000,"docs":1000,
+//  "position":1000,"paths":<hash>}
+//
+// A segment is written to a temporary name, flushed to disk and renamed.
+// Its manifest line is then appended and flushed. A segment only counts
+// once the manifest names it, so a crash loses at most the batch in
+// progress. A restart tells the document source how many documents to
+// pass over; they are not read, only their paths checked against the
+// hashes. The final merge reads the segments in manifest order, which is
+// the order an uninterrupted run would have produced.
+// ----------------------------------------------------
+static const char SEGMENT_MAGIC[8] = {'S','E','S','E','G','0','1','\0'};
+
+// Writes data to path through a temporary file, flushed to disk before
+// the rename so the file is either complete or absent
+inline bool writeFileDurably(const std::string& path, const std::string& data) {
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = std::fflush(f) == 0 && ok;
+#ifndef _WIN32
+    ok = ::fsync(fileno(f)) == 0 && ok;
+#endif
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) return false;
+
+    // Windows refuses to rename onto an existing file
+    if (std::rename(tmp.c_str(), path.c_str()) != 0 &&
+        (std::remove(path.c_str()) != 0 || std::rename(tmp.c_str(), path.c_str()) != 0))
+        return false;
+    return true;
+}
+
+// "<size>@<mtime>" of an input the segments depend on (the lexicon), for
+// the settings string: a file rebuilt in place no longer matches, so its
+// old segments are not mixed with new IDs. Empty when it cannot be read.
+inline std::string fileIdentity(const std::string& path) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) return "";
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return "";
+    return std::to_string(size) + "@" + std::to_string(mtime.time_since_epoch().count());
+}
+
+// -------------------- Segment records --------------------
+// Varints and length-prefixed strings after the magic
+class SegmentWriter {
+private:
+    std::string data;
+    uint32_t records = 0;
+
+public:
+    SegmentWriter() { clear(); }
+
+    void clear() {
+        data.assign(SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+        records = 0;
+    }
+
+    void putNumber(uint32_t v) { putVarint(data, v); }
+    void putString(const std::string& s) {
+        putVarint(data, s.size());
+        data += s;
+    }
+    void putBytes(const void* p, size_t n) { data.append(static_cast<const char*>(p), n); }
+    void endRecord() { records++; }
+
+    uint32_t recordCount() const { return records; }
+    size_t bytes() const { return data.size(); }
+    bool empty() const { return records == 0; }
+    bool write(const std::string& path) const { return writeFileDurably(path, data); }
+};
+
+// Segments are mapped, not read into memory: a merge over many of them
+// costs page cache the kernel can reclaim, not heap
+class SegmentReader {
+private:
+    MappedFile file;
+    const char* p = nullptr;
+    const char* end = nullptr;
+
+public:
+    bool open(const std::string& path) {
+        if (!file.open(path)) return false;
+        if (file.size() < sizeof(SEGMENT_MAGIC) ||
+            std::memcmp(file.data(), SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0)
+            return false;
+        rewind();
+        return true;
+    }
+
+    // Back to the first record
+    void rewind() {
+        p = file.data() + sizeof(SEGMENT_MAGIC);
+        end = file.data() + file.size();
+    }
+
+    bool atEnd() const { return p >= end; }
+    uint32_t getNumber() { return getVarint(p); }
+    std::string getString() {
+        uint32_t n = getVarint(p);
+        std::string s(p, n);
+        p += n;
+        return s;
+    }
+    void getBytes(void* out, size_t n) {
+        std::memcpy(out, p, n);
+        p += n;
+    }
+};
+
+// -------------------- Manifest --------------------
+// manifest.jsonl: a header line, then one line per committed segment,
+// appended and flushed to disk by each commit. A segment line covers the
+// documents the source handed over since the previous one: their count
+// ("position" is the running total), docID range and a hash of their
+// paths. A torn last line from a crash during the append is dropped.
+class BuildCheckpoint {
+private:
+    struct Segment {
+        std::string file;
+        uint64_t position = 0;
+        uint64_t pathHash = 0;
+    };
+
+    static constexpr uint64_t HASH_SEED = 0xCBF29CE484222325ull;
+
+    std::string dir;
+    std::vector<Segment> segments;
+    uint32_t nextSegment = 0;          // never reused, even for a dropped commit
+
+    // Documents handed over so far, and the batch since the last commit
+    uint64_t position = 0;
+    uint64_t pathHash = HASH_SEED;
+    int firstDoc = 0, lastDoc = 0;
+    size_t verified = 0;               // committed segments checked on resume
+
+    std::string manifestPath() const { return dir + "/manifest.jsonl"; }
+
+    // FNV-1a over docID and path, chained through the batch
+    static uint64_t hashDocument(uint64_t h, int docID, const std::string& path) {
+        auto mix = [&h](unsigned char c) { h ^= c; h *= 0x100000001B3ull; };
+        for (int i = 0; i < 4; i++) mix(static_cast<unsigned char>(static_cast<uint32_t>(docID) >> (8 * i)));
+        for (unsigned char c : path) mix(c);
+        mix('\n');
+        return h;
+    }
+
+    bool append(const std::string& line) {
+        std::FILE* f = std::fopen(manifestPath().c_str(), "ab");
+        if (!f) return false;
+        bool ok = std::fwrite(line.data(), 1, line.size(), f) == line.size() && std::fputc('\n', f) != EOF;
+        ok = std::fflush(f) == 0 && ok;
+#ifndef _WIN32
+        ok = ::fsync(fileno(f)) == 0 && ok;
+#endif
+        return std::fclose(f) == 0 && ok;
+    }
+
+public:
+    // Creates the directory, or picks up the manifest of an earlier run
+    // of the same tool over the same input
+    bool open(const std::string& directory, const std::string& tool,
+              const std::string& input, uint32_t batch, std::string& error) {
+        dir = directory;
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec) { error = "Cannot create checkpoint directory " + dir; return false; }
+
+        // Segment files left by a commit whose manifest line never made it
+        // still hold their number
+        for (auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            unsigned n;
+            if (std::sscanf(entry.path().filename().string().c_str(), "segment_%u.bin", &n) == 1)
+                nextSegment = std::max(nextSegment, n + 1);
+        }
+
+        std::ifstream in(manifestPath(), std::ios::binary);
+        if (!in) {
+            nlohmann::json header = {{"tool", tool}, {"input", input}, {"batch", batch}};
+            if (!writeFileDurably(manifestPath(), header.dump() + "\n")) {
+                error = "Cannot write checkpoint manifest " + manifestPath();
+                return false;
+            }
+            return true;
+        }
+
+        std::string line;
+        uint64_t good = 0;
+        bool first = true;
+        while (std::getline(in, line)) {
+            if (in.eof()) break;                // no newline: torn append
+            nlohmann::json record;
+            Segment s;
+            try {
+                record = nlohmann::json::parse(line);
+                if (!first) {
+                    s.file = record.at("file").get<std::string>();
+                    s.position = record.at("position").get<uint64_t>();
+                    s.pathHash = record.at("paths").get<uint64_t>();
+                }
+            } catch (nlohmann::json::exception&) {
+                if (in.peek() == EOF) break;    // torn append
+                error = "Corrupt checkpoint manifest " + manifestPath();
+                return false;
+            }
+            if (first) {
+                if (record.value("tool", "") != tool || record.value("input", "") != input) {
+                    error = "Checkpoint in " + dir + " belongs to another build (" +
+                            record.value("tool", "?") + " over " + record.value("input", "?") + ")";
+                    return false;
+                }
+                first = false;
+            } else {
+                segments.push_back(s);
+            }
+            good += line.size() + 1;
+        }
+        if (first) { error = "Corrupt checkpoint manifest " + manifestPath(); return false; }
+        in.close();
+
+        // Cut a torn line off so the next append starts a fresh one
+        if (std::filesystem::file_size(manifestPath(), ec) != good) {
+            std::filesystem::resize_file(manifestPath(), good, ec);
+            if (ec) { error = "Cannot repair checkpoint manifest " + manifestPath(); return false; }
+        }
+        return true;
+    }
+
+    // Documents the committed segments cover, counted in the order the
+    // source hands them over; a resumed run skips that many
+    uint64_t committedDocs() const { return segments.empty() ? 0 : segments.back().position; }
+    size_t segmentCount() const { return segments.size(); }
+    std::string segmentPath(size_t i) const { return dir + "/" + segments[i].file; }
+
+    // Call for every document the source skips on resume. At the end of
+    // each committed segment the paths seen must hash to what was
+    // recorded, or the dataset changed since the checkpoint was written.
+    bool skip(int docID, const std::string& path, std::string& error) {
+        position++;
+        pathHash = hashDocument(pathHash, docID, path);
+        while (verified < segments.size() && segments[verified].position == position) {
+            if (segments[verified].pathHash != pathHash) {
+                error = "Dataset changed since the checkpoint: documents up to " + path +
+                        " differ from " + segments[verified].file;
+                return false;
+            }
+            pathHash = HASH_SEED;
+            verified++;
+        }
+        return true;
+    }
+
+    // False when the source ran out before the committed documents did
+    bool resumeComplete(std::string& error) const {
+        if (verified == segments.size()) return true;
+        error = "Dataset changed since the checkpoint: it has fewer than " +
+                std::to_string(committedDocs()) + " documents";
+        return false;
+    }
+
+    // Call for every document handed over after the committed ones,
+    // including any the build then leaves out
+    void add(int docID, const std::string& path) {
+        if (position == committedDocs() || docID < firstDoc) firstDoc = docID;
+        if (position == committedDocs() || docID > lastDoc) lastDoc = docID;
+        position++;
+        pathHash = hashDocument(pathHash, docID, path);
+    }
+
+    // Writes the segment under a fresh name, then appends its manifest line
+    bool commit(const SegmentWriter& segment) {
+        if (verified < segments.size()) return false;   // resume not finished
+        char name[32];
+        std::snprintf(name, sizeof(name), "segment_%05u.bin", nextSegment++);
+        if (!segment.write(dir + "/" + name)) return false;
+
+        uint64_t docs = position - committedDocs();
+        nlohmann::json record = {{"file", name}, {"first_doc", firstDoc}, {"last_doc", lastDoc},
+                                 {"docs", docs}, {"position", position}, {"paths", pathHash}};
+        if (!append(record.dump())) return false;
+        segments.push_back({name, position, pathHash});
+        verified = segments.size();
+        pathHash = HASH_SEED;
+        return true;
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+// ----------------------------------------------------
+// CORD-19 paper ingestion
+// A CORD-19 JSON file is mostly structure (paper_id, authors, spans,
+// bib entries, ref ids). Only a few string values are worth indexing:
+//
+//   metadata.title
+//   abstract[].text
+//   body_text[].text
+//
+// The SAX handler below picks those out while the parser streams through
+// the file, so no DOM is ever built and keys never reach the tokenizer.
+// ----------------------------------------------------
+enum class Cord19Field { Title, Abstract, Body };
+
+template <typename TextFn>
+class Cord19TextHandler : public nlohmann::json_sax<nlohmann::json> {
+private:
+    // One entry per open container: the key it was opened under
+    // (empty for array elements), and whether it is an array
+    struct Frame {
+        std::string key;
+        bool isArray;
+    };
+
+    TextFn& onText;
+    std::vector<Frame> frames;
+    std::string currentKey;
+    size_t fieldsFound = 0;
+
+    void open(bool isArray) {
+        std::string k = (!frames.empty() && frames.back().isArray) ? std::string() : currentKey;
+        frames.push_back({k, isArray});
+    }
+
+public:
+    explicit Cord19TextHandler(TextFn& fn) : onText(fn) {}
+
+    size_t fields() const { return fieldsFound; }
+
+    bool string(string_t& val) override {
+        // frames[0] is the paper object itself
+        if (frames.size() == 2 && frames[1].key == "metadata" && currentKey == "title") {
+            onText(Cord19Field::Title, val);
+            fieldsFound++;
+        } else if (frames.size() == 3 && frames[2].isArray == false && currentKey == "text" &&
+                   (frames[1].key == "abstract" || frames[1].key == "body_text")) {
+            onText(frames[1].key == "abstract" ? Cord19Field::Abstract : Cord19Field::Body, val);
+            fieldsFound++;
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override { currentKey = val; return true; }
+
+    bool start_object(std::size_t) override { open(false); return true; }
+    bool end_object() override { frames.pop_back(); return true; }
+    bool start_array(std::size_t) override { open(true); return true; }
+    bool end_array() override { frames.pop_back(); return true; }
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+};
+
+// ----------------------------------------------------
+// Stream the text fields of one CORD-19 paper held in [begin, end).
+// onText(Cord19Field, const std::string&) is called once per field.
+// Returns false if the bytes are not valid JSON or contain no CORD-19
+// text fields; callers then fall back to treating them as plain text.
+// ----------------------------------------------------
+template <typename TextFn>
+bool extractCord19Text(const char* begin, const char* end, TextFn onText) {
+    Cord19TextHandler<TextFn> handler(onText);
+    bool ok = nlohmann::json::sax_parse(begin, end, &handler);
+    return ok && handler.fields() > 0;
+}
+
+// ----------------------------------------------------
+// Read a whole file with a single read into a reusable buffer.
+// Avoids istreambuf_iterator's byte-at-a-time copy and, because the
+// buffer is reused, a fresh allocation per document.
+// ----------------------------------------------------
+inline bool readWholeFile(const std::string& path, std::string& buffer) {
+    std::ifstream fin(path, std::ios::binary | std::ios::ate);
+    if (!fin) return false;
+
+    std::streamsize size = fin.tellg();
+    fin.seekg(0);
+    buffer.resize(static_cast<size_t>(size));
+    return static_cast<bool>(fin.read(buffer.data(), size));
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+// ----------------------------------------------------
+// Deterministic synthetic corpora
+//
+// Word frequencies follow a Zipf law over a fixed vocabulary: the word of
+// rank r is drawn with probability proportional to 1 / r^s. Each document
+// is generated from its own docID and the seed alone. The same config
+// therefore always gives the same bytes, on any platform and in any
+// order. This is why the random numbers and the Zipf sampler are our own
+// and not <random>'s distributions, which differ between standard
+// libraries.
+//
+// Documents are plain text or CORD-19-shaped JSON (metadata.title,
+// abstract[], body_text[] plus the usual structural noise), laid out like
+// a CORD-19 release:
+//
+//   <dir>/comm_use_subset/<sha>.json
+//   <dir>/text/doc_<docID>.txt
+// ----------------------------------------------------
+struct CorpusConfig {
+    uint32_t documents  = 1000;
+    uint32_t vocabulary = 50000;
+    double   zipf       = 1.07;     // exponent s; ~1 for English text
+    uint32_t meanWords  = 400;      // words per document, title excluded
+    double   jsonShare  = 0.8;      // fraction of CORD-19 JSON documents
+    uint64_t seed       = 42;
+
+    nlohmann::json toJson() const {
+        return {{"documents", documents}, {"vocabulary", vocabulary}, {"zipf", zipf},
+                {"mean_words", meanWords}, {"json_share", jsonShare}, {"seed", seed}};
+    }
+};
+
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1) with 53 random bits
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(uniform() * n); }
+};
+
+// Word for a frequency rank (0 = most frequent): rank + 1 written in base
+// 100, one consonant-vowel syllable per digit, so every rank gets a
+// distinct, pronounceable lowercase word
+inline std::string syntheticWord(uint32_t rank) {
+    static const char consonants[] = "bcdfghjklmnprstvwxyz";
+    static const char vowels[] = "aeiou";
+    std::string word;
+    for (uint32_t n = rank + 1; n > 0; n /= 100) {
+        word += consonants[(n % 100) / 5];
+        word += vowels[n % 5];
+    }
+    return word;
+}
+
+class ZipfSampler {
+private:
+    std::vector<double> cdf;
+
+public:
+    ZipfSampler(uint32_t n, double s) : cdf(n) {
+        double total = 0;
+        for (uint32_t r = 0; r < n; r++) {
+            total += 1.0 / std::pow(r + 1.0, s);
+            cdf[r] = total;
+        }
+        for (double& c : cdf) c /= total;
+    }
+
+    uint32_t sample(SplitMix64& rng) const {
+        auto it = std::upper_bound(cdf.begin(), cdf.end(), rng.uniform());
+        return static_cast<uint32_t>(std::min<size_t>(it - cdf.begin(), cdf.size() - 1));
+    }
+};
+
+struct SyntheticDocument {
+    uint32_t docID = 0;
+    bool json = false;
+    std::string title;
+    std::string abstract;
+    std::vector<std::string> paragraphs;
+};
+
+class CorpusGenerator {
+private:
+    CorpusConfig config;
+    std::vector<std::string> vocabulary;
+    ZipfSampler zipf;
+
+    std::string sentence(SplitMix64& rng, uint32_t words) const {
+        std::string out;
+        for (uint32_t i = 0; i < words; i++) {
+            if (i) out += ' ';
+            out += vocabulary[zipf.sample(rng)];
+        }
+        return out;
+    }
+
+    std::string paragraph(SplitMix64& rng, uint32_t words) const {
+        std::string out;
+        while (words > 0) {
+            uint32_t n = std::min(words, 8 + rng.below(16));
+            if (!out.empty()) out += ' ';
+            out += sentence(rng, n);
+            out += rng.below(4) ? ". " : ", ";
+            out.pop_back();
+            words -= n;
+        }
+        if (!out.empty()) out[0] = static_cast<char>(out[0] - 'a' + 'A');
+        return out;
+    }
+
+public:
+    explicit CorpusGenerator(const CorpusConfig& c) : config(c), zipf(c.vocabulary, c.zipf) {
+        vocabulary.reserve(config.vocabulary);
+        for (uint32_t r = 0; r < config.vocabulary; r++) vocabulary.push_back(syntheticWord(r));
+    }
+
+    const CorpusConfig& settings() const { return config; }
+    const std::vector<std::string>& words() const { return vocabulary; }
+    const ZipfSampler& sampler() const { return zipf; }
+
+    SyntheticDocument document(uint32_t docID) const {
+        SplitMix64 rng(config.seed * 0x100000001B3ull + docID);
+        SyntheticDocument doc;
+        doc.docID = docID;
+        doc.json  = rng.uniform() < config.jsonShare;
+
+        // Lengths vary from half to one and a half times the mean
+        uint32_t words = config.meanWords / 2 + rng.below(config.meanWords + 1);
+        doc.title = paragraph(rng, 4 + rng.below(8));
+        uint32_t abstractWords = std::min(words, 60 + rng.below(120));
+        doc.abstract = paragraph(rng, abstractWords);
+        for (words -= abstractWords; words > 0;) {
+            uint32_t n = std::min(words, 40 + rng.below(120));
+            doc.paragraphs.push_back(paragraph(rng, n));
+            words -= n;
+        }
+        return doc;
+    }
+
+    // 40 hex digits, like a CORD-19 paper sha
+    std::string paperID(uint32_t docID) const {
+        SplitMix64 rng(config.seed ^ (0xC0FFEEull * (docID + 1)));
+        char hex[49];
+        for (int i = 0; i < 48; i += 16)
+            std::snprintf(hex + i, sizeof(hex) - i, "%016llx", (unsigned long long)rng.next());
+        return std::string(hex, 40);
+    }
+
+    std::string text(const SyntheticDocument& doc) const {
+        std::string out = doc.title + "\n\n" + doc.abstract + "\n";
+        for (auto& p : doc.paragraphs) out += "\n" + p + "\n";
+        return out;
+    }
+
+    std::string cord19Json(const SyntheticDocument& doc) const {
+        using json = nlohmann::json;
+        static const char* sections[] = {"Introduction", "Methods", "Results", "Discussion"};
+        json paper;
+        paper["paper_id"] = paperID(doc.docID);
+        paper["metadata"] = {{"title", doc.title},
+                             {"authors", json::array({{{"first", "A"}, {"middle", json::array()},
+                                                       {"last", "Author"}, {"suffix", ""},
+                                                       {"affiliation", json::object()}, {"email", ""}}})}};
+        paper["abstract"] = json::array({{{"text", doc.abstract}, {"cite_spans", json::array()},
+                                          {"ref_spans", json::array()}, {"section", "Abstract"}}});
+        paper["body_text"] = json::array();
+        for (size_t i = 0; i < doc.paragraphs.size(); i++) {
+            paper["body_text"].push_back({{"text", doc.paragraphs[i]},
+                                          {"cite_spans", json::array({{{"start", 0}, {"end", 3}, {"text", "[1]"}, {"ref_id", "BIBREF0"}}})},
+                                          {"ref_spans", json::array()},
+                                          {"section", sections[i * 4 / doc.paragraphs.size()]}});
+        }
+        paper["bib_entries"] = {{"BIBREF0", {{"ref_id", "b0"}, {"title", "Cited work"}, {"year", 2019}}}};
+        paper["ref_entries"] = json::object();
+        paper["back_matter"] = json::array();
+        return paper.dump(4);
+    }
+
+    std::string relativePath(const SyntheticDocument& doc) const {
+        if (doc.json) return "comm_use_subset/" + paperID(doc.docID) + ".json";
+        char name[32];
+        std::snprintf(name, sizeof(name), "text/doc_%06u.txt", doc.docID);
+        return name;
+    }
+
+    // Writes the whole corpus under dir; returns the bytes written, 0 on failure
+    uint64_t write(const std::string& dir) const {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::create_directories(fs::path(dir) / "comm_use_subset", ec);
+        fs::create_directories(fs::path(dir) / "text", ec);
+        if (ec) return 0;
+
+        uint64_t bytes = 0;
+        for (uint32_t d = 1; d <= config.documents; d++) {
+            SyntheticDocument doc = document(d);
+            std::string body = doc.json ? cord19Json(doc) : text(doc);
+            std::ofstream out(fs::path(dir) / relativePath(doc), std::ios::binary);
+            out.write(body.data(), body.size());
+            if (!out) return 0;
+            bytes += body.size();
+        }
+        return bytes;
+    }
+
+    // lexicon.json with the vocabulary in rank order, which is the
+    // frequency order build_lexicon assigns
+    bool writeLexicon(const std::string& path) const {
+        std::ofstream out(path);
+        out << nlohmann::json{{"lexicon", vocabulary}}.dump();
+        return static_cast<bool>(out);
+    }
+};
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+#include "varint.h"
+#include "doc_filter.h"
+
+namespace fs = std::filesystem;
+
+// ----------------------------------------------------
+// Document attribute columns (docattrs.bin)
+//
+// [DocAttributesHeader]
+// [u8  x docs+1]   extension ID per docID
+// [u16 x docs+1]   source directory ID per docID
+// [u16 x docs+1]   publish year per docID, 0 when unknown
+// [names]          extensions then directories: varint length + bytes
+// [bitsets]        one per extension, directory and year in
+//                  [yearMin, yearMin + yearCount), wordsPerBitset u64 each
+//
+// Name ID 0 is "" for both columns (no extension / not indexed). The
+// columns answer "what is this doc"; the bitsets turn a filter into a
+// few word-wise ANDs and ORs instead of a scan over every document.
+// ----------------------------------------------------
+static const char DOC_ATTRIBUTES_MAGIC[8] = {'S','E','A','T','R','0','1','\0'};
+
+struct DocAttributesHeader {
+    char     magic[8];
+    uint32_t docCount;          // highest docID
+    uint32_t extCount;
+    uint32_t dirCount;
+    uint32_t yearMin;
+    uint32_t yearCount;
+    uint32_t wordsPerBitset;
+    uint64_t extColumnOffset;
+    uint64_t dirColumnOffset;
+    uint64_t yearColumnOffset;
+    uint64_t namesOffset;
+    uint64_t bitsetsOffset;
+};
+
+// -------------------- Path attributes --------------------
+// Lowercased extension without the dot: "json", "txt"
+inline std::string docExtension(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    if (!ext.empty()) ext.erase(0, 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+// "2020-03-13": the top directory of a CORD-19 release
+inline bool isReleaseDate(const std::string& name) {
+    if (name.size() != 10 || name[4] != '-' || name[7] != '-') return false;
+    for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9})
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) return false;
+    return true;
+}
+
+// First directory under the dataset root, e.g. "comm_use_subset";
+// "." for files directly in the root. A release date directory is
+// skipped, so a release archive or an extracted release
+// ("2020-03-13/comm_use_subset/...") gives the subset name too.
+inline std::string docDirectory(const std::string& path, const std::string& root) {
+    fs::path rel = fs::path(path).lexically_relative(root);
+    if (rel.empty() || rel.begin() == rel.end()) return ".";
+    auto first = rel.begin();
+    if (std::next(first) == rel.end()) return ".";
+    if (isReleaseDate(first->string())) {
+        ++first;
+        if (std::next(first) == rel.end()) return ".";
+    }
+    return first->string();
+}
+
+// ----------------------------------------------------
+// CORD-19 metadata.csv: paper sha → publish year
+// Papers are named <sha>.json in the releases; a row may list several
+// shas separated by "; ". Quoted fields may contain commas and newlines.
+// ----------------------------------------------------
+inline bool readCsvRow(std::istream& in, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false, any = false;
+    char c;
+    while (in.get(c)) {
+        any = true;
+        if (quoted) {
+            if (c == '"') {
+                if (in.peek() == '"') { field += '"'; in.get(c); }
+                else quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    if (!any) return false;
+    fields.push_back(field);
+    return true;
+}
+
+inline bool loadPublishYears(const std::string& csvFile, std::unordered_map<std::string, uint16_t>& years) {
+    std::ifstream in(csvFile, std::ios::binary);
+    if (!in) return false;
+
+    std::vector<std::string> row;
+    if (!readCsvRow(in, row)) return false;
+    auto column = [&](const std::string& name) {
+        return std::find(row.begin(), row.end(), name) - row.begin();
+    };
+    size_t shaCol = column("sha"), timeCol = column("publish_time");
+    if (shaCol == row.size() || timeCol == row.size()) return false;
+
+    while (readCsvRow(in, row)) {
+        if (row.size() <= std::max(shaCol, timeCol)) continue;
+        const std::string& time = row[timeCol];
+        if (time.size() < 4 || !std::all_of(time.begin(), time.begin() + 4, ::isdigit)) continue;
+        uint16_t year = static_cast<uint16_t>(std::stoi(time.substr(0, 4)));
+
+        const std::string& shas = row[shaCol];
+        size_t start = 0;
+        while (start < shas.size()) {
+            size_t end = shas.find(';', start);
+            if (end == std::string::npos) end = shas.size();
+            std::string sha = shas.substr(start, end - start);
+            sha.erase(0, sha.find_first_not_of(' '));
+            if (!sha.empty()) years[sha] = year;
+            start = end + 1;
+        }
+    }
+    return true;
+}
+
+// -------------------- Writer --------------------
+class DocAttributesWriter {
+private:
+    std::string path;
+    std::vector<uint8_t> extColumn;
+    std::vector<uint16_t> dirColumn;
+    std::vector<uint16_t> yearColumn;
+    std::vector<std::string> extNames{""};
+    std::vector<std::string> dirNames{""};
+    std::unordered_map<std::string, uint32_t> extIDs{{"", 0}};
+    std::unordered_map<std::string, uint32_t> dirIDs{{"", 0}};
+
+    static uint32_t intern(const std::string& name, std::vector<std::string>& names,
+                           std::unordered_map<std::string, uint32_t>& ids, uint32_t limit) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        if (names.size() >= limit) return 0; // column full: treated as unknown
+        ids[name] = names.size();
+        names.push_back(name);
+        return names.size() - 1;
+    }
+
+public:
+    bool open(const std::string& file) {
+        path = file;
+        std::ofstream probe(file, std::ios::binary);
+        return static_cast<bool>(probe);
+    }
+
+    void add(int docID, const std::string& extension, const std::string& directory, uint16_t year) {
+        if (docID >= (int)extColumn.size()) {
+            extColumn.resize(docID + 1, 0);
+            dirColumn.resize(docID + 1, 0);
+            yearColumn.resize(docID + 1, 0);
+        }
+        extColumn[docID]  = intern(extension, extNames, extIDs, 256);
+        dirColumn[docID]  = intern(directory, dirNames, dirIDs, 65536);
+        yearColumn[docID] = year;
+    }
+
+    bool finish() {
+        if (extColumn.empty()) add(0, "", "", 0);
+        uint32_t docCount = extColumn.size() - 1;
+
+        DocAttributesHeader header{};
+        std::memcpy(header.magic, DOC_ATTRIBUTES_MAGIC, sizeof(DOC_ATTRIBUTES_MAGIC));
+        header.docCount = docCount;
+        header.extCount = extNames.size();
+        header.dirCount = dirNames.size();
+        header.wordsPerBitset = docCount / 64 + 1;
+
+        uint32_t yearMax = 0;
+        header.yearMin = UINT16_MAX;
+        for (uint16_t y : yearColumn) {
+            if (!y) continue;
+            header.yearMin = std::min<uint32_t>(header.yearMin, y);
+            yearMax = std::max<uint32_t>(yearMax, y);
+        }
+        if (yearMax == 0) header.yearMin = 0;
+        header.yearCount = yearMax ? yearMax - header.yearMin + 1 : 0;
+
+        std::string names;
+        for (auto& n : extNames) { putVarint(names, n.size()); names += n; }
+        for (auto& n : dirNames) { putVarint(names, n.size()); names += n; }
+
+        auto align8 = [](uint64_t v) { return (v + 7) / 8 * 8; };
+        header.extColumnOffset  = sizeof(DocAttributesHeader);
+        header.dirColumnOffset  = align8(header.extColumnOffset + extColumn.size());
+        header.yearColumnOffset = header.dirColumnOffset + dirColumn.size() * sizeof(uint16_t);
+        header.namesOffset      = header.yearColumnOffset + yearColumn.size() * sizeof(uint16_t);
+        header.bitsetsOffset    = align8(header.namesOffset + names.size());
+
+        // Bitsets: extensions, then directories, then years
+        size_t words = header.wordsPerBitset;
+        std::vector<uint64_t> bitsets((header.extCount + header.dirCount + header.yearCount) * words, 0);
+        for (uint32_t d = 1; d <= docCount; d++) {
+            uint64_t bit = uint64_t(1) << (d & 63);
+            if (extColumn[d] || dirColumn[d]) {
+                bitsets[extColumn[d] * words + (d >> 6)] |= bit;
+                bitsets[(header.extCount + dirColumn[d]) * words + (d >> 6)] |= bit;
+            }
+            if (yearColumn[d])
+                bitsets[(header.extCount + header.dirCount + yearColumn[d] - header.yearMin) * words + (d >> 6)] |= bit;
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        auto pad = [&](uint64_t to) {
+            std::string zeros(to - static_cast<uint64_t>(out.tellp()), '\0');
+            out.write(zeros.data(), zeros.size());
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(extColumn.data()), extColumn.size());
+        pad(header.dirColumnOffset);
+        out.write(reinterpret_cast<const char*>(dirColumn.data()), dirColumn.size() * sizeof(uint16_t));
+        out.write(reinterpret_cast<const char*>(yearColumn.data()), yearColumn.size() * sizeof(uint16_t));
+        out.write(names.data(), names.size());
+        pad(header.bitsetsOffset);
+        out.write(reinterpret_cast<const char*>(bitsets.data()), bitsets.size() * sizeof(uint64_t));
+        out.close();
+        return static_cast<bool>(out);
+    }
+
+    size_t extensionCount() const { return extNames.size() - 1; }
+    size_t directoryCount() const { return dirNames.size() - 1; }
+};
+
+// ----------------------------------------------------
+// Query-time filter: empty fields match everything
+// ----------------------------------------------------
+struct AttributeFilter {
+    std::string extension;
+    std::string directory;
+    uint32_t yearFrom = 0;
+    uint32_t yearTo = 0;
+
+    bool empty() const { return extension.empty() && directory.empty() && !yearFrom && !yearTo; }
+
+    // Stable text form, part of the result cache key
+    std::string key() const {
+        return "ext=" + extension + ",dir=" + directory + ",year=" +
+               std::to_string(yearFrom) + "-" + std::to_string(yearTo);
+    }
+
+    // "--ext json", "--dir comm_use_subset", "--year 2019", "--year 2015-2020"
+    // or an open range ("--year 2019-", "--year -2020"); returns false when
+    // argv[i] is not a filter option, and sets error for a bad value
+    bool parse(int argc, char* argv[], int& i, std::string& error) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        if (arg == "--ext") {
+            extension = argv[++i];
+            if (!extension.empty() && extension[0] == '.') extension.erase(0, 1);
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        } else if (arg == "--dir") {
+            directory = argv[++i];
+        } else if (arg == "--year") {
+            std::string range = argv[++i];
+            size_t dash = range.find('-');
+            // An empty bound is open; 0 means unbounded to buildFilter
+            auto year = [](const std::string& text, uint32_t& out) {
+                out = 0;
+                if (text.empty()) return true;
+                auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+                return ec == std::errc() && end == text.data() + text.size() && out > 0;
+            };
+            bool ok = dash == std::string::npos
+                ? !range.empty() && year(range, yearFrom)
+                : year(range.substr(0, dash), yearFrom) && year(range.substr(dash + 1), yearTo);
+            if (dash == std::string::npos) yearTo = yearFrom;
+            if (!ok || (!yearFrom && !yearTo) || (yearTo && yearFrom > yearTo))
+                error = "Bad --year '" + range + "': expected <y>, <from-to>, <from->, or <-to>";
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+// -------------------- Reader --------------------
+class DocAttributes {
+private:
+    MappedFile file;
+    const DocAttributesHeader* header = nullptr;
+    std::vector<std::string> extNames, dirNames;
+
+    const uint64_t* bitset(uint32_t index) const {
+        return reinterpret_cast<const uint64_t*>(file.data() + header->bitsetsOffset) +
+               size_t(index) * header->wordsPerBitset;
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path) || file.size() < sizeof(DocAttributesHeader)) {
+            error = "Cannot map attribute file " + path;
+            return false;
+        }
+        header = reinterpret_cast<const DocAttributesHeader*>(file.data());
+        if (std::memcmp(header->magic, DOC_ATTRIBUTES_MAGIC, sizeof(DOC_ATTRIBUTES_MAGIC)) != 0) {
+            error = "Not a document attribute file (bad magic)";
+            return false;
+        }
+        const char* p = file.data() + header->namesOffset;
+        for (uint32_t i = 0; i < header->extCount + header->dirCount; i++) {
+            uint32_t length = getVarint(p);
+            (i < header->extCount ? extNames : dirNames).emplace_back(p, length);
+            p += length;
+        }
+        return true;
+    }
+
+    uint32_t docCount() const { return header->docCount; }
+
+    const std::string& extension(uint32_t docID) const {
+        static const std::string none;
+        if (docID > header->docCount) return none;
+        return extNames[reinterpret_cast<const uint8_t*>(file.data() + header->extColumnOffset)[docID]];
+    }
+
+    const std::string& directory(uint32_t docID) const {
+        static const std::string none;
+        if (docID > header->docCount) return none;
+        return dirNames[reinterpret_cast<const uint16_t*>(file.data() + header->dirColumnOffset)[docID]];
+    }
+
+    uint16_t year(uint32_t docID) const {
+        if (docID > header->docCount) return 0;
+        return reinterpret_cast<const uint16_t*>(file.data() + header->yearColumnOffset)[docID];
+    }
+
+    // ANDs the bitsets the filter names; an unknown value matches nothing
+    DocFilter buildFilter(const AttributeFilter& f) const {
+        DocFilter filter(header->docCount, true);
+
+        if (!f.extension.empty()) {
+            auto it = std::find(extNames.begin() + 1, extNames.end(), f.extension);
+            if (it == extNames.end()) return DocFilter(header->docCount, false);
+            filter.andWith(bitset(it - extNames.begin()));
+        }
+        if (!f.directory.empty()) {
+            auto it = std::find(dirNames.begin() + 1, dirNames.end(), f.directory);
+            if (it == dirNames.end()) return DocFilter(header->docCount, false);
+            filter.andWith(bitset(header->extCount + (it - dirNames.begin())));
+        }
+        if (f.yearFrom || f.yearTo) {
+            DocFilter years(header->docCount, false);
+            uint32_t from = std::max(f.yearFrom, header->yearMin);
+            uint32_t to   = std::min<uint32_t>(f.yearTo ? f.yearTo : UINT16_MAX, header->yearMin + header->yearCount - 1);
+            for (uint32_t y = from; header->yearCount && y <= to; y++)
+                years.orWith(bitset(header->extCount + header->dirCount + (y - header->yearMin)));
+            filter.andWith(years);
+        }
+        return filter;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+// ----------------------------------------------------
+// Set of allowed docIDs, one bit per document.
+// Built per query from the attribute bitsets (doc_attributes.h) and
+// probed by the intersection and ranking loops; docIDs past the end are
+// never allowed.
+// ----------------------------------------------------
+class DocFilter {
+private:
+    std::vector<uint64_t> bits;
+
+public:
+    DocFilter() = default;
+    DocFilter(uint32_t docCount, bool allowAll) : bits(docCount / 64 + 1, allowAll ? ~uint64_t(0) : 0) {
+        if (!allowAll) return;
+        bits[0] &= ~uint64_t(1); // docIDs start at 1
+        uint32_t tail = (docCount & 63) + 1;
+        if (tail < 64) bits.back() &= (uint64_t(1) << tail) - 1;
+    }
+
+    bool allows(uint32_t docID) const {
+        return (docID >> 6) < bits.size() && ((bits[docID >> 6] >> (docID & 63)) & 1);
+    }
+
+    size_t words() const { return bits.size(); }
+
+    // Bits of docIDs [64 * i, 64 * i + 64); a 64K container chunk's bitmap
+    // word w lines up with word (key << 10) + w
+    uint64_t word(size_t i) const { return i < bits.size() ? bits[i] : 0; }
+
+    void andWith(const uint64_t* other) {
+        for (size_t i = 0; i < bits.size(); i++) bits[i] &= other[i];
+    }
+
+    void orWith(const uint64_t* other) {
+        for (size_t i = 0; i < bits.size(); i++) bits[i] |= other[i];
+    }
+
+    void andWith(const DocFilter& other) { andWith(other.bits.data()); }
+
+    uint32_t count() const {
+        uint32_t n = 0;
+        for (size_t i = 0; i < bits.size(); i++) n += std::bitset<64>(bits[i]).count();
+        return n;
+    }
+};
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h> // link with -lz
+#include "mapped_file.h"
+#include "varint.h"
+#include "unicode_text.h"
+
+// ----------------------------------------------------
+// Document store (docstore.bin)
+//
+// [DocStoreHeader]
+// [text blocks]        zlib-compressed, ~64 KiB of documents each
+// [path blocks]        16 paths per block, front-coded
+// [u64 x pathBlocks]   file offset of every path block
+// [TextBlock x N]      file offset and sizes of every text block
+// [DocEntry x docs+1]  indexed by docID: where its text lives
+//
+// Every stored document is [u32 titleLength][title][text]. Resolving one
+// search result touches one path block and one text block.
+// ----------------------------------------------------
+static const char DOC_STORE_MAGIC[8] = {'S','E','D','O','C','0','1','\0'};
+static const uint32_t DOC_STORE_PATHS_PER_BLOCK = 16;
+static const uint32_t DOC_STORE_NO_BLOCK = 0xFFFFFFFFu;
+
+struct DocStoreHeader {
+    char     magic[8];
+    uint32_t docCount;          // highest docID
+    uint32_t textBlockCount;
+    uint32_t pathBlockCount;
+    uint32_t reserved;
+    uint64_t pathOffsetsOffset;
+    uint64_t textBlocksOffset;
+    uint64_t docEntriesOffset;
+};
+
+struct TextBlock {
+    uint64_t offset;
+    uint32_t compressedBytes;
+    uint32_t rawBytes;
+};
+
+struct DocEntry {
+    uint32_t block;             // DOC_STORE_NO_BLOCK when nothing was stored
+    uint32_t offsetInBlock;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+// ----------------------------------------------------
+// Writer, fed by the forward index builder one document at a time.
+// Documents may arrive in any docID order (archive input); text is
+// compressed as it arrives, paths are front-coded at the end.
+// ----------------------------------------------------
+class DocStoreWriter {
+private:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;
+
+    std::ofstream out;
+    std::string block;
+    std::vector<TextBlock> blocks;
+    std::vector<DocEntry> entries;
+    std::vector<std::string> paths;
+    uint64_t pos = sizeof(DocStoreHeader);
+    uint64_t rawTotal = 0;
+
+    void flushBlock() {
+        if (block.empty()) return;
+        uLongf compressedBytes = compressBound(block.size());
+        std::string compressed(compressedBytes, '\0');
+        compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedBytes,
+                  reinterpret_cast<const Bytef*>(block.data()), block.size(), 6);
+
+        out.write(compressed.data(), compressedBytes);
+        blocks.push_back({pos, static_cast<uint32_t>(compressedBytes), static_cast<uint32_t>(block.size())});
+        pos += compressedBytes;
+        block.clear();
+    }
+
+    void grow(int docID) {
+        if (docID >= (int)entries.size()) {
+            entries.resize(docID + 1, DocEntry{DOC_STORE_NO_BLOCK, 0, 0, 0});
+            paths.resize(docID + 1);
+        }
+    }
+
+public:
+    bool open(const std::string& path) {
+        out.open(path, std::ios::binary);
+        if (!out) return false;
+        DocStoreHeader blank{};
+        out.write(reinterpret_cast<const char*>(&blank), sizeof(blank));
+        return true;
+    }
+
+    void add(int docID, const std::string& path, const std::string& title, const std::string& text) {
+        grow(docID);
+        paths[docID] = path;
+
+        DocEntry& e = entries[docID];
+        e.block = blocks.size();
+        e.offsetInBlock = block.size();
+
+        uint32_t titleLength = title.size();
+        block.append(reinterpret_cast<const char*>(&titleLength), sizeof(titleLength));
+        block += title;
+        block += text;
+        e.length = block.size() - e.offsetInBlock;
+        rawTotal += e.length;
+
+        if (block.size() >= BLOCK_BYTES) flushBlock();
+    }
+
+    bool finish() {
+        flushBlock();
+        grow(0);
+
+        DocStoreHeader header{};
+        std::memcpy(header.magic, DOC_STORE_MAGIC, sizeof(DOC_STORE_MAGIC));
+        header.docCount = entries.size() - 1;
+        header.textBlockCount = blocks.size();
+
+        // Front-coded path blocks: the first path in full, then
+        // (shared prefix length, suffix) against the previous path
+        std::vector<uint64_t> pathOffsets;
+        std::string coded;
+        for (size_t i = 0; i < paths.size(); i += DOC_STORE_PATHS_PER_BLOCK) {
+            pathOffsets.push_back(pos);
+            coded.clear();
+            size_t end = std::min(paths.size(), i + DOC_STORE_PATHS_PER_BLOCK);
+            for (size_t j = i; j < end; j++) {
+                uint32_t shared = 0;
+                if (j > i) {
+                    const std::string& prev = paths[j - 1];
+                    while (shared < prev.size() && shared < paths[j].size() &&
+                           prev[shared] == paths[j][shared]) shared++;
+                }
+                putVarint(coded, shared);
+                putVarint(coded, paths[j].size() - shared);
+                coded.append(paths[j], shared, std::string::npos);
+            }
+            out.write(coded.data(), coded.size());
+            pos += coded.size();
+        }
+        header.pathBlockCount = pathOffsets.size();
+
+        // The offset tables are read in place, keep them 8-byte aligned
+        std::string padding((8 - pos % 8) % 8, '\0');
+        out.write(padding.data(), padding.size());
+        pos += padding.size();
+
+        header.pathOffsetsOffset = pos;
+        out.write(reinterpret_cast<const char*>(pathOffsets.data()), pathOffsets.size() * sizeof(uint64_t));
+        pos += pathOffsets.size() * sizeof(uint64_t);
+
+        header.textBlocksOffset = pos;
+        out.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(TextBlock));
+        pos += blocks.size() * sizeof(TextBlock);
+
+        header.docEntriesOffset = pos;
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(DocEntry));
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        return static_cast<bool>(out);
+    }
+
+    uint64_t rawBytes() const { return rawTotal; }
+    uint64_t fileBytes() const { return pos + entries.size() * sizeof(DocEntry); }
+};
+
+// ----------------------------------------------------
+// Reader: maps docstore.bin and decodes only what a result needs
+// ----------------------------------------------------
+struct StoredDocument {
+    std::string path;
+    std::string title;
+    std::string text;
+};
+
+class DocStore {
+private:
+    MappedFile file;
+    const DocStoreHeader* header = nullptr;
+
+    const DocEntry& entry(uint32_t docID) const {
+        return reinterpret_cast<const DocEntry*>(file.data() + header->docEntriesOffset)[docID];
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path) || file.size() < sizeof(DocStoreHeader)) {
+            error = "Cannot map document store " + path;
+            return false;
+        }
+        header = reinterpret_cast<const DocStoreHeader*>(file.data());
+        if (std::memcmp(header->magic, DOC_STORE_MAGIC, sizeof(DOC_STORE_MAGIC)) != 0) {
+            error = "Not a document store file (bad magic)";
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t docCount() const { return header->docCount; }
+
+    std::string path(uint32_t docID) const {
+        if (docID > header->docCount) return std::string();
+
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file.data() + header->pathOffsetsOffset);
+        const char* p = file.data() + offsets[docID / DOC_STORE_PATHS_PER_BLOCK];
+
+        std::string current;
+        for (uint32_t i = 0; i <= docID % DOC_STORE_PATHS_PER_BLOCK; i++) {
+            uint32_t shared = getVarint(p);
+            uint32_t suffix = getVarint(p);
+            current.resize(shared);
+            current.append(p, suffix);
+            p += suffix;
+        }
+        return current;
+    }
+
+    bool fetch(uint32_t docID, StoredDocument& doc) const {
+        doc.path = path(docID);
+        doc.title.clear();
+        doc.text.clear();
+        if (docID > header->docCount) return false;
+
+        const DocEntry& e = entry(docID);
+        if (e.block == DOC_STORE_NO_BLOCK) return false;
+
+        const TextBlock& b = reinterpret_cast<const TextBlock*>(file.data() + header->textBlocksOffset)[e.block];
+        std::string raw(b.rawBytes, '\0');
+        uLongf rawBytes = b.rawBytes;
+        if (uncompress(reinterpret_cast<Bytef*>(&raw[0]), &rawBytes,
+                       reinterpret_cast<const Bytef*>(file.data() + b.offset), b.compressedBytes) != Z_OK)
+            return false;
+
+        uint32_t titleLength;
+        std::memcpy(&titleLength, raw.data() + e.offsetInBlock, sizeof(titleLength));
+        doc.title = raw.substr(e.offsetInBlock + sizeof(titleLength), titleLength);
+        doc.text  = raw.substr(e.offsetInBlock + sizeof(titleLength) + titleLength,
+                               e.length - sizeof(titleLength) - titleLength);
+        return true;
+    }
+};
+
+// ----------------------------------------------------
+// Query-highlighted snippet: a window of about `width` bytes around the
+// first match of any query word, matches wrapped in [ ]. The text is
+// split and folded by the tokenizer itself, with the index's
+// stripAccents, so "MÜLLER" is highlighted for the query word "müller";
+// the brackets go around the original bytes.
+// ----------------------------------------------------
+inline std::string makeSnippet(const std::string& text, const std::vector<std::string>& words,
+                               size_t width = 200, bool stripAccents = false) {
+    // Every word of the text as a byte range, and whether it matched.
+    // A word runs from the end of the gap before it to the start of the
+    // gap after it.
+    struct Span { size_t begin, end; bool match; };
+    std::vector<Span> spans;
+    size_t gapEnd = 0;
+    bool pending = false;
+    scanWords(text, [&](std::string_view word) {
+        bool match = std::find(words.begin(), words.end(), word) != words.end();
+        spans.push_back({gapEnd, text.size(), match});
+        pending = true;
+    }, [&](std::string_view gap) {
+        size_t at = gap.data() - text.data();
+        if (pending) spans.back().end = at;
+        pending = false;
+        gapEnd = at + gap.size();
+    }, stripAccents);
+
+    size_t first = std::string::npos;
+    for (const Span& w : spans) {
+        if (w.match) { first = w.begin; break; }
+    }
+
+    // The window never cuts a word or a UTF-8 sequence: its start moves
+    // back over a word it lands in or right after, its end forward over
+    // one it lands in or right before
+    auto snap = [&](size_t pos, bool forward) {
+        for (const Span& w : spans) {
+            if (w.begin > pos) break;
+            if (forward ? pos < w.end : (w.begin < pos && pos <= w.end)) return forward ? w.end : w.begin;
+        }
+        while (pos > 0 && pos < text.size() && (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80)
+            forward ? pos++ : pos--;
+        return pos;
+    };
+    size_t start = 0;
+    if (first != std::string::npos && first > width / 3) start = snap(first - width / 3, false);
+    size_t end = snap(std::min(text.size(), start + width), true);
+
+    std::string snippet = start > 0 ? "..." : "";
+    auto span = std::lower_bound(spans.begin(), spans.end(), start,
+                                 [](const Span& w, size_t pos) { return w.begin < pos; });
+    for (size_t i = start; i < end; ) {
+        if (span != spans.end() && span->begin == i) {
+            if (span->match) snippet += "[" + text.substr(i, span->end - i) + "]";
+            else snippet.append(text, i, span->end - i);
+            i = span->end;
+            ++span;
+        } else {
+            char c = text[i++];
+            snippet += (c == '\n' || c == '\r' || c == '\t') ? ' ' : c;
+        }
+    }
+    if (end < text.size()) snippet += "...";
+    return snippet;
+}
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h> // link with -lz
+#include "bounded_queue.h"
+#include "cord19_reader.h"
+#include "trace.h"
+
+namespace fs = std::filesystem;
+
+// ----------------------------------------------------
+// Document sources for the index builders
+//
+// A dataset is either a directory (walked recursively) or a CORD-19
+// release archive (.tar.gz / .tgz) that is read straight out of gzip,
+// including the per-subset .tar.gz archives nested inside a release.
+// Both give every document the same docID: its rank in sorted path order.
+// ----------------------------------------------------
+
+// -------------------- File Filter --------------------
+inline bool isReadableFile(const fs::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    return ext == ".txt" || ext == ".json" || ext == ".csv" ||
+           ext == ".xml" || ext == ".html" || ext == ".md" ||
+           ext == ".log" || ext == ".tsv" || ext == ".yaml" ||
+           ext == ".ini" || ext == ".cfg";
+}
+
+inline bool isTarGzPath(const std::string& path) {
+    std::string p = path;
+    std::transform(p.begin(), p.end(), p.begin(), ::tolower);
+    auto endsWith = [&](const char* suffix) {
+        size_t n = std::strlen(suffix);
+        return p.size() >= n && p.compare(p.size() - n, n, suffix) == 0;
+    };
+    return endsWith(".tar.gz") || endsWith(".tgz");
+}
+
+// -------------------- Byte Streams --------------------
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+    // Reads up to n bytes; 0 means end of stream
+    virtual size_t read(char* out, size_t n) = 0;
+};
+
+class FileByteSource : public ByteSource {
+private:
+    std::FILE* file;
+
+public:
+    explicit FileByteSource(const std::string& path) : file(std::fopen(path.c_str(), "rb")) {}
+    ~FileByteSource() override { if (file) std::fclose(file); }
+
+    bool isOpen() const { return file != nullptr; }
+
+    size_t read(char* out, size_t n) override {
+        return file ? std::fread(out, 1, n, file) : 0;
+    }
+};
+
+// At most `limit` bytes of another stream (one tar entry's data)
+class LimitedByteSource : public ByteSource {
+private:
+    ByteSource* in = nullptr;
+    uint64_t remaining = 0;
+
+public:
+    void reset(ByteSource& src, uint64_t limit) { in = &src; remaining = limit; }
+
+    size_t read(char* out, size_t n) override {
+        if (remaining == 0) return 0;
+        size_t got = in->read(out, std::min<uint64_t>(n, remaining));
+        remaining -= got;
+        if (got == 0) remaining = 0; // underlying stream ended early
+        return got;
+    }
+
+    void skipRest() {
+        char scratch[1 << 14];
+        while (remaining > 0 && read(scratch, sizeof(scratch)) > 0) {}
+    }
+};
+
+// gzip decoder; concatenated members (pigz / bgzip output) are read in turn
+class GzipByteSource : public ByteSource {
+private:
+    ByteSource& in;
+    z_stream zs{};
+    std::vector<char> inBuf;
+    bool finished = false;
+    bool failed = false;
+    int membersDone = 0;
+
+public:
+    explicit GzipByteSource(ByteSource& src) : in(src), inBuf(1 << 16) {
+        if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) { failed = true; finished = true; }
+    }
+    ~GzipByteSource() override { inflateEnd(&zs); }
+
+    bool ok() const { return !failed; }
+
+    size_t read(char* out, size_t n) override {
+        zs.next_out = reinterpret_cast<Bytef*>(out);
+        zs.avail_out = static_cast<uInt>(n);
+
+        while (zs.avail_out > 0 && !finished) {
+            if (zs.avail_in == 0) {
+                size_t got = in.read(inBuf.data(), inBuf.size());
+                if (got == 0) { finished = true; break; }
+                zs.next_in = reinterpret_cast<Bytef*>(inBuf.data());
+                zs.avail_in = static_cast<uInt>(got);
+            }
+
+            int r = inflate(&zs, Z_NO_FLUSH);
+            if (r == Z_STREAM_END) {
+                membersDone++;
+                inflateReset(&zs);
+            } else if (r != Z_OK && r != Z_BUF_ERROR) {
+                // Trailing padding after a complete member is not an error
+                if (membersDone == 0) failed = true;
+                finished = true;
+            }
+        }
+        return n - zs.avail_out;
+    }
+};
+
+// -------------------- Tar Reader --------------------
+struct TarEntry {
+    std::string name;
+    uint64_t size = 0;
+    bool isFile = false;
+};
+
+class TarReader {
+private:
+    ByteSource& in;
+    LimitedByteSource entry;
+    uint64_t padding = 0;
+
+    bool readFull(char* buf, size_t n) {
+        size_t done = 0;
+        while (done < n) {
+            size_t got = in.read(buf + done, n - done);
+            if (got == 0) return false;
+            done += got;
+        }
+        return true;
+    }
+
+    void skip(uint64_t n) {
+        char scratch[512];
+        while (n > 0) {
+            size_t step = std::min<uint64_t>(n, sizeof(scratch));
+            if (!readFull(scratch, step)) return;
+            n -= step;
+        }
+    }
+
+    static uint64_t parseSize(const char* field) {
+        // GNU base-256 encoding for entries of 8 GiB and more
+        if (static_cast<unsigned char>(field[0]) & 0x80) {
+            uint64_t v = 0;
+            for (int i = 1; i < 12; i++) v = (v << 8) | static_cast<unsigned char>(field[i]);
+            return v;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < 12 && field[i] >= '0' && field[i] <= '7'; i++) v = v * 8 + (field[i] - '0');
+        return v;
+    }
+
+    static std::string field(const char* p, size_t n) {
+        return std::string(p, strnlen(p, n));
+    }
+
+    // pax extended header: "<len> path=<value>\n" records
+    static std::string paxPath(const std::string& data) {
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t space = data.find(' ', pos);
+            if (space == std::string::npos) break;
+            // A malformed length ends the scan; this runs on the
+            // decompression thread, where a throw would end the build
+            size_t len = 0;
+            auto [end, ec] = std::from_chars(data.data() + pos, data.data() + space, len);
+            if (ec != std::errc() || end != data.data() + space) break;
+            if (len <= space - pos + 1 || pos + len > data.size()) break;
+            std::string record = data.substr(space + 1, pos + len - space - 2);
+            if (record.compare(0, 5, "path=") == 0) return record.substr(5);
+            pos += len;
+        }
+        return std::string();
+    }
+
+public:
+    explicit TarReader(ByteSource& src) : in(src) {}
+
+    // Advances to the next header, skipping whatever is left of the current entry
+    bool next(TarEntry& e) {
+        std::string longName;
+
+        for (;;) {
+            entry.skipRest();
+            skip(padding);
+            padding = 0;
+
+            char header[512];
+            if (!readFull(header, sizeof(header)) || header[0] == '\0') return false;
+
+            e.size = parseSize(header + 124);
+            char type = header[156];
+            entry.reset(in, e.size);
+            padding = (512 - e.size % 512) % 512;
+
+            if (type == 'L' || type == 'x') {
+                // Long name for the entry that follows
+                std::string data;
+                readAll(data);
+                longName = type == 'L' ? field(data.data(), data.size()) : paxPath(data);
+                continue;
+            }
+            if (type == 'g' || type == 'K') continue;
+
+            e.name = field(header, 100);
+            if (std::memcmp(header + 257, "ustar", 5) == 0 && header[345] != '\0')
+                e.name = field(header + 345, 155) + "/" + e.name;
+            if (!longName.empty()) e.name = longName;
+            e.isFile = type == '0' || type == '\0' || type == '7';
+            return true;
+        }
+    }
+
+    ByteSource& data() { return entry; }
+
+    void readAll(std::string& out) {
+        out.clear();
+        char buf[1 << 16];
+        size_t got;
+        while ((got = entry.read(buf, sizeof(buf))) > 0) out.append(buf, got);
+    }
+};
+
+// -------------------- Archive Walk --------------------
+// fn(name, TarReader&) for every regular file, descending into nested
+// .tar.gz members; a nested archive's entries are named as if it had been
+// extracted next to itself ("2020-03-13/comm_use_subset/<sha>.json").
+template <typename Fn>
+bool walkTarGz(ByteSource& compressed, const std::string& prefix, Fn& fn) {
+    GzipByteSource gz(compressed);
+    TarReader tar(gz);
+    TarEntry e;
+
+    while (tar.next(e)) {
+        if (!e.isFile) continue;
+        if (e.name.compare(0, 2, "./") == 0) e.name.erase(0, 2);
+        std::string name = prefix + e.name;
+
+        if (isTarGzPath(name)) {
+            size_t slash = name.find_last_of('/');
+            std::string dir = slash == std::string::npos ? std::string() : name.substr(0, slash + 1);
+            if (!walkTarGz(tar.data(), dir, fn)) return false;
+            continue;
+        }
+        fn(name, tar);
+    }
+    return gz.ok();
+}
+
+// ----------------------------------------------------
+// Calls fn(docID, path, content) for every readable document in `input`.
+//
+// Directory: files in sorted path order, docIDs 1..N as before.
+// Archive:   a first pass lists the member names so each gets its rank
+//            in the same sorted order; the second pass decompresses on
+//            a background thread while the caller tokenizes, and hands
+//            documents over in archive order. With archiveOrder the
+//            listing pass is skipped and docIDs follow archive order.
+//
+// Documents that cannot be read still consume their docID.
+// Returns false if the input could not be read.
+//
+// A resumed build passes resumeAt: the first resumeAt documents go to
+// skipped(docID, path) instead, without being read. A directory walk
+// jumps over those files; an archive still has to inflate them (gzip has
+// no seek points) but does not copy or queue their contents.
+// ----------------------------------------------------
+struct SourceDocument {
+    int docID = 0;
+    std::string path;
+    std::string content;
+    bool skipped = false;
+};
+
+template <typename Fn, typename SkipFn>
+bool forEachDocument(const std::string& input, bool archiveOrder, uint64_t resumeAt, SkipFn skipped, Fn fn) {
+    if (!isTarGzPath(input)) {
+        TraceSpan walkSpan("walk_directory", "io", input);
+        std::vector<fs::path> files;
+        for (auto& entry : fs::recursive_directory_iterator(input)) {
+            if (fs::is_regular_file(entry.path()) && isReadableFile(entry.path()))
+                files.push_back(entry.path());
+        }
+
+        // Sort files alphabetically for deterministic docID assignment
+        std::sort(files.begin(), files.end());
+        walkSpan.end();
+
+        std::string content;
+        int docID = 0;
+        uint64_t handedOver = 0;
+        for (const auto& file : files) {
+            docID++;
+            std::string path = file.string();
+            if (handedOver < resumeAt) {
+                // Opened, not read, so the count matches the earlier run
+                if (!std::ifstream(path, std::ios::binary)) continue;
+                handedOver++;
+                skipped(docID, path);
+                continue;
+            }
+            TraceSpan readSpan("read_file", "io", path);
+            if (!readWholeFile(path, content)) continue;
+            readSpan.end();
+            handedOver++;
+            fn(docID, path, content);
+        }
+        return true;
+    }
+
+    // Pass 1: member names only, ranked like a directory walk
+    std::unordered_map<std::string,int> docIDs;
+    if (!archiveOrder) {
+        TraceSpan listSpan("list_archive", "io", input);
+        std::vector<fs::path> names;
+        FileByteSource file(input);
+        if (!file.isOpen()) return false;
+
+        auto list = [&](const std::string& name, TarReader&) {
+            if (isReadableFile(name)) names.push_back(name);
+        };
+        if (!walkTarGz(file, "", list)) return false;
+
+        std::sort(names.begin(), names.end());
+        for (size_t i = 0; i < names.size(); i++) docIDs[names[i].string()] = i + 1;
+    }
+
+    // Pass 2: decompression thread -> bounded queue -> caller
+    BoundedQueue<SourceDocument> queue(64);
+    bool readOk = true;
+
+    std::thread producer([&] {
+        tracer().nameThread("decompress");
+        FileByteSource file(input);
+        int nextID = 0;
+        uint64_t handedOver = 0;
+        auto emit = [&](const std::string& name, TarReader& tar) {
+            if (!isReadableFile(name)) return;
+            TraceSpan readSpan("decompress_member", "io", name);
+            SourceDocument doc;
+            doc.docID = archiveOrder ? ++nextID : docIDs[name];
+            doc.path = input + "/" + name;
+            doc.skipped = ++handedOver <= resumeAt;
+            if (!doc.skipped) tar.readAll(doc.content);
+            readSpan.end();
+            TraceSpan pushSpan("queue_full_wait", "io");
+            queue.push(std::move(doc));
+        };
+        readOk = file.isOpen() && walkTarGz(file, "", emit);
+        queue.close();
+    });
+
+    // Time spent waiting here is decompression the caller could not hide
+    SourceDocument doc;
+    for (;;) {
+        TraceSpan waitSpan("queue_empty_wait", "io");
+        if (!queue.pop(doc)) break;
+        waitSpan.end();
+        if (doc.skipped) skipped(doc.docID, doc.path);
+        else fn(doc.docID, doc.path, doc.content);
+    }
+    producer.join();
+    return readOk;
+}
+
+template <typename Fn>
+bool forEachDocument(const std::string& input, bool archiveOrder, Fn fn) {
+    return forEachDocument(input, archiveOrder, 0, [](int, const std::string&) {}, fn);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include "cord19_reader.h"
+#include "term_arena.h"
+
+// ----------------------------------------------------
+// Document text → term counts, shared by the index builders and the
+// search_engine library so every path into the index tokenizes alike
+// ----------------------------------------------------
+
+// -------------------- Tokenizer --------------------
+// Words are forEachWord's (unicode_text.h): case-folded runs of letters
+// and digits in any script, accents stripped when the index asks for it.
+// Counting goes into a FlatTermMap whose keys
+// live in its arena, so a warmed-up map counts a document without
+// touching the heap.
+inline void tokenize(std::string_view text, FlatTermMap<int>& termFreq, bool stripAccents = false)
+{
+    forEachWord(text, [&](std::string_view word) { termFreq[word]++; }, stripAccents);
+}
+
+// -------------------- Document Text --------------------
+// CORD-19 papers contribute only their title, abstract and body text.
+// Other files, and any .json that is not a CORD-19 paper, are tokenized whole.
+// When title/storedText are given they receive the text kept for the
+// document store. Returns the number of bytes handed to the tokenizer.
+inline size_t tokenizeDocument(const std::filesystem::path& path,
+                               const std::string& content,
+                               bool cord19Json,
+                               FlatTermMap<int>& termFreq,
+                               std::string* title = nullptr,
+                               std::string* storedText = nullptr,
+                               bool stripAccents = false)
+{
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (title) title->clear();
+    if (storedText) storedText->clear();
+
+    if (cord19Json && ext == ".json") {
+        size_t bytes = 0;
+        bool ok = extractCord19Text(content.data(), content.data() + content.size(),
+            [&](Cord19Field field, const std::string& text) {
+                tokenize(text, termFreq, stripAccents);
+                bytes += text.size();
+                if (field == Cord19Field::Title && title) {
+                    *title = text;
+                } else if (storedText) {
+                    if (!storedText->empty()) *storedText += "\n\n";
+                    *storedText += text;
+                }
+            });
+        if (ok) return bytes;
+        termFreq.reset(); // drop anything counted before the parser gave up
+        if (title) title->clear();
+        if (storedText) storedText->clear();
+    }
+
+    tokenize(content, termFreq, stripAccents);
+
+    // Plain files: the first non-empty line stands in for a title
+    if (storedText) *storedText = content;
+    if (title) {
+        size_t start = content.find_first_not_of(" \t\r\n");
+        if (start != std::string::npos) {
+            size_t end = content.find_first_of("\r\n", start);
+            *title = content.substr(start, std::min<size_t>(end - start, 200));
+        }
+    }
+    return content.size();
+}
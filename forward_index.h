@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mapped_file.h"
+#include "varint.h"
+
+// ----------------------------------------------------
+// Binary forward index (forward_index.bin)
+//
+// [ForwardIndexHeader]
+// [document records]      varint termCount, then (lexID gap, freq) varints,
+//                         lexIDs ascending
+// [ForwardDocSlot x docs+1]  indexed by docID: record position and length
+// [u32 x termCount+1]     document frequency per lexID
+//
+// The same data as forward_index_new.json, but readable in place: one
+// document's term vector is a slot lookup plus a short varint decode.
+// ----------------------------------------------------
+static const char FORWARD_INDEX_MAGIC[8] = {'S','E','F','W','D','0','1','\0'};
+
+struct ForwardIndexHeader {
+    char     magic[8];
+    uint32_t docCount;          // highest docID
+    uint32_t termCount;         // lexicon size
+    uint64_t indexedDocs;       // documents actually stored
+    uint64_t totalTokens;
+    uint64_t slotsOffset;
+    uint64_t dfOffset;
+};
+
+struct ForwardDocSlot {
+    uint64_t offset;
+    uint32_t bytes;             // 0 when the document was not indexed
+    uint32_t length;            // tokens in the document, for length normalisation
+};
+
+using TermVector = std::vector<std::pair<uint32_t,uint32_t>>; // (lexID, freq)
+
+// -------------------- Writer --------------------
+class ForwardIndexWriter {
+private:
+    std::ofstream out;
+    std::vector<ForwardDocSlot> slots;
+    std::vector<uint32_t> df;
+    uint64_t pos = sizeof(ForwardIndexHeader);
+    uint64_t indexedDocs = 0;
+    uint64_t totalTokens = 0;
+    std::string record;
+
+public:
+    bool open(const std::string& path, uint32_t lexiconSize) {
+        out.open(path, std::ios::binary);
+        if (!out) return false;
+        df.assign(lexiconSize + 1, 0);
+        ForwardIndexHeader blank{};
+        out.write(reinterpret_cast<const char*>(&blank), sizeof(blank));
+        return true;
+    }
+
+    // terms must be sorted by lexID; length is the document's token count
+    void add(int docID, const TermVector& terms, uint32_t length) {
+        if (docID >= (int)slots.size()) slots.resize(docID + 1, ForwardDocSlot{0, 0, 0});
+
+        record.clear();
+        putVarint(record, terms.size());
+        uint32_t prev = 0;
+        for (auto& [lexID, freq] : terms) {
+            putVarint(record, lexID - prev);
+            putVarint(record, freq);
+            prev = lexID;
+            df[lexID]++;
+        }
+
+        slots[docID] = {pos, static_cast<uint32_t>(record.size()), length};
+        out.write(record.data(), record.size());
+        pos += record.size();
+        indexedDocs++;
+        totalTokens += length;
+    }
+
+    bool finish() {
+        if (slots.empty()) slots.resize(1, ForwardDocSlot{0, 0, 0});
+
+        ForwardIndexHeader header{};
+        std::memcpy(header.magic, FORWARD_INDEX_MAGIC, sizeof(FORWARD_INDEX_MAGIC));
+        header.docCount    = slots.size() - 1;
+        header.termCount   = df.size() - 1;
+        header.indexedDocs = indexedDocs;
+        header.totalTokens = totalTokens;
+
+        std::string padding((8 - pos % 8) % 8, '\0');
+        out.write(padding.data(), padding.size());
+        pos += padding.size();
+
+        header.slotsOffset = pos;
+        out.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(ForwardDocSlot));
+        pos += slots.size() * sizeof(ForwardDocSlot);
+
+        header.dfOffset = pos;
+        out.write(reinterpret_cast<const char*>(df.data()), df.size() * sizeof(uint32_t));
+        pos += df.size() * sizeof(uint32_t);
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        return static_cast<bool>(out);
+    }
+
+    uint64_t fileBytes() const { return pos; }
+};
+
+// -------------------- Reader --------------------
+class ForwardIndex {
+private:
+    MappedFile file;
+    const ForwardIndexHeader* header = nullptr;
+    const ForwardDocSlot* slots = nullptr;
+    const uint32_t* dfTable = nullptr;
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path) || file.size() < sizeof(ForwardIndexHeader)) {
+            error = "Cannot map forward index " + path;
+            return false;
+        }
+        header = reinterpret_cast<const ForwardIndexHeader*>(file.data());
+        if (std::memcmp(header->magic, FORWARD_INDEX_MAGIC, sizeof(FORWARD_INDEX_MAGIC)) != 0) {
+            error = "Not a binary forward index (bad magic)";
+            return false;
+        }
+        slots   = reinterpret_cast<const ForwardDocSlot*>(file.data() + header->slotsOffset);
+        dfTable = reinterpret_cast<const uint32_t*>(file.data() + header->dfOffset);
+        return true;
+    }
+
+    uint32_t docCount() const { return header->docCount; }
+    uint64_t indexedDocs() const { return header->indexedDocs; }
+    uint32_t termCount() const { return header->termCount; }
+
+    bool hasDoc(uint32_t docID) const {
+        return docID <= header->docCount && slots[docID].bytes > 0;
+    }
+
+    uint32_t docLength(uint32_t docID) const {
+        return docID <= header->docCount ? slots[docID].length : 0;
+    }
+
+    double averageDocLength() const {
+        return header->indexedDocs ? double(header->totalTokens) / header->indexedDocs : 0.0;
+    }
+
+    uint32_t df(uint32_t lexID) const {
+        return lexID <= header->termCount ? dfTable[lexID] : 0;
+    }
+
+    // Decodes one document's (lexID, freq) pairs into `terms`
+    bool termVector(uint32_t docID, TermVector& terms) const {
+        terms.clear();
+        if (!hasDoc(docID)) return false;
+
+        const char* p = file.data() + slots[docID].offset;
+        uint32_t count = getVarint(p);
+        terms.reserve(count);
+        uint32_t lexID = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            lexID += getVarint(p);
+            uint32_t freq = getVarint(p);
+            terms.push_back({lexID, freq});
+        }
+        return true;
+    }
+};
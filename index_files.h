@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "unicode_text.h"
+
+// ----------------------------------------------------
+// Readers for the JSON files every stage of the pipeline shares
+//
+//   lexicon.json          { "lexicon": [word, ...], "cf": [...], "df": [...] }
+//                         lexID = position + 1; cf/df only from newer builds;
+//                         "strip_accents": true if built with --strip-accents
+//   barrel_mapping.json   { "<lexID>": barrelID, ... }
+//   index_stats.json      { "doc_count": n, "doc_lengths": [length of docID 0, 1, ...],
+//                           "df": [...] }
+//                         next to barrels pruned by prune_index: the full
+//                         index's statistics, which BM25 keeps using;
+//                         df[lexID - 1] as in the lexicon
+//
+// A tool that reads a lexicon tokenizes the way that lexicon was built
+// (lexiconStripsAccents), so the setting is only given where a lexicon
+// is made.
+//
+// One copy for the tools and the search_engine library. Errors come back
+// as a message; the caller decides whether to exit.
+// ----------------------------------------------------
+
+// Whether the lexicon's words were folded with accents stripped; text
+// matched against it has to be tokenized the same way
+inline bool lexiconStripsAccents(const nlohmann::json& lexJson) {
+    return lexJson.value("strip_accents", false);
+}
+
+// words[lexID - 1]; df[lexID - 1] too when asked for and present, and
+// the lexicon's accent stripping when asked for
+inline bool loadLexiconWords(const std::string& lexFile, std::vector<std::string>& words,
+                             std::string& error, std::vector<uint32_t>* df = nullptr,
+                             bool* stripAccents = nullptr) {
+    std::ifstream fin(lexFile);
+    if (!fin) {
+        error = "Cannot open lexicon file " + lexFile;
+        return false;
+    }
+    nlohmann::json lexJson;
+    try {
+        fin >> lexJson;
+    } catch (nlohmann::json::exception& e) {
+        error = std::string("Failed to parse lexicon file: ") + e.what();
+        return false;
+    }
+    if (!lexJson.contains("lexicon") || !lexJson["lexicon"].is_array()) {
+        error = "Lexicon file has no 'lexicon' array: " + lexFile;
+        return false;
+    }
+
+    if (stripAccents) *stripAccents = lexiconStripsAccents(lexJson);
+    words.clear();
+    for (const auto& w : lexJson["lexicon"]) words.push_back(w.get<std::string>());
+    if (df) {
+        df->clear();
+        if (lexJson.contains("df") && lexJson["df"].size() == words.size())
+            *df = lexJson["df"].get<std::vector<uint32_t>>();
+    }
+    return true;
+}
+
+// word → lexID, the id++ numbering every tool uses
+inline std::unordered_map<std::string, int> lexiconMap(const std::vector<std::string>& words) {
+    std::unordered_map<std::string, int> lexMap;
+    lexMap.reserve(words.size());
+    int id = 1;
+    for (const std::string& w : words) lexMap[w] = id++;
+    return lexMap;
+}
+
+inline bool loadBarrelMapping(const std::string& mapFile, std::unordered_map<int, int>& barrelMap,
+                              std::string& error) {
+    std::ifstream fin(mapFile);
+    if (!fin) {
+        error = "Cannot open barrel mapping file " + mapFile;
+        return false;
+    }
+    nlohmann::json mapJson;
+    try {
+        fin >> mapJson;
+    } catch (nlohmann::json::exception& e) {
+        error = std::string("Failed to parse barrel mapping: ") + e.what();
+        return false;
+    }
+
+    barrelMap.clear();
+    for (auto& [lexID, barrelID] : mapJson.items()) barrelMap[std::stoi(lexID)] = barrelID;
+    return true;
+}
+
+// docLengths[docID] and df[lexID - 1]; false with an error when the file
+// is unreadable, true with both empty when it does not exist
+inline bool loadIndexStats(const std::string& file, std::vector<uint32_t>& docLengths,
+                           std::vector<uint32_t>& df, std::string& error) {
+    docLengths.clear();
+    df.clear();
+    std::ifstream fin(file);
+    if (!fin) return true;
+    nlohmann::json statsJson;
+    try {
+        fin >> statsJson;
+        docLengths = statsJson.at("doc_lengths").get<std::vector<uint32_t>>();
+        df = statsJson.at("df").get<std::vector<uint32_t>>();
+    } catch (nlohmann::json::exception& e) {
+        error = "Failed to parse " + file + ": " + e.what();
+        return false;
+    }
+    if (docLengths.empty()) docLengths.push_back(0);
+    return true;
+}
+
+// -------------------- Barrel assignment --------------------
+// 8 alphabetical buckets (A–C, D–F, G–I, J–L, M–O, P–R, S–U, V–Z) of 4
+// hash sub-buckets each: barrels 0–31
+static const int BARREL_COUNT = 32;
+
+inline int barrelOfWord(const std::string& word) {
+    char c = std::tolower(static_cast<unsigned char>(word[0]));
+    int alphaBucket;
+    if (c >= 'a' && c <= 'c') alphaBucket = 0;
+    else if (c >= 'd' && c <= 'f') alphaBucket = 1;
+    else if (c >= 'g' && c <= 'i') alphaBucket = 2;
+    else if (c >= 'j' && c <= 'l') alphaBucket = 3;
+    else if (c >= 'm' && c <= 'o') alphaBucket = 4;
+    else if (c >= 'p' && c <= 'r') alphaBucket = 5;
+    else if (c >= 's' && c <= 'u') alphaBucket = 6;
+    else alphaBucket = 7; // v-z
+
+    int subBucket = std::hash<std::string>{}(word) % 4;
+    return alphaBucket * 4 + subBucket;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+// -------------------- Term records --------------------
+// One term of the inverted index on its way to its barrel
+struct TermRecord {
+    int lexID = 0;
+    std::vector<std::pair<uint32_t,uint32_t>> postings;  // docID, freq
+};
+
+// -------------------- Streaming inverted index reader --------------------
+// SAX events from { "lexID": { "docID": freq, ... }, ... } become one
+// TermRecord per term, handed to onTerm as soon as its object closes.
+// No DOM of the index is ever built. Works for the JSON and MessagePack
+// outputs of build_inverted_index, and for barrels, which have the
+// same shape.
+template <typename OnTerm>
+class InvertedIndexSax {
+private:
+    OnTerm onTerm;
+    int depth = 0;
+    uint32_t docID = 0;
+    TermRecord term;
+
+    static bool toNumber(const std::string& s, uint32_t& v) {
+        auto res = std::from_chars(s.data(), s.data() + s.size(), v);
+        return res.ec == std::errc() && res.ptr == s.data() + s.size();
+    }
+
+    bool posting(uint64_t freq) {
+        if (depth != 2) return fail("posting outside a term");
+        term.postings.push_back({docID, static_cast<uint32_t>(freq)});
+        return true;
+    }
+
+public:
+    std::string error;
+    uint64_t terms = 0, postings = 0;
+
+    explicit InvertedIndexSax(OnTerm fn) : onTerm(fn) {}
+
+    bool fail(const std::string& why) {
+        if (error.empty()) error = "Unexpected inverted index layout: " + why;
+        return false;
+    }
+
+    bool key(std::string& k) {
+        uint32_t id;
+        if (!toNumber(k, id)) return fail("non-numeric key '" + k + "'");
+        if (depth == 1) {
+            term.lexID = id;
+            term.postings.clear();
+        } else {
+            docID = id;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        if (++depth > 2) return fail("nesting deeper than term → doc → freq");
+        return true;
+    }
+
+    bool end_object() {
+        if (depth == 2) {
+            terms++;
+            postings += term.postings.size();
+            if (!onTerm(term)) return false;
+        }
+        depth--;
+        return true;
+    }
+
+    bool number_unsigned(uint64_t v) { return posting(v); }
+    bool number_integer(int64_t v) { return v >= 0 ? posting(v) : fail("negative frequency"); }
+    bool number_float(double, const std::string&) { return fail("fractional frequency"); }
+    bool null() { return depth == 0 || fail("null"); }   // older tools wrote empty barrels as null
+    bool boolean(bool) { return fail("boolean"); }
+    bool string(std::string&) { return fail("string value"); }
+    bool binary(nlohmann::json::binary_t&) { return fail("binary value"); }
+    bool start_array(std::size_t) { return fail("array"); }
+    bool end_array() { return fail("array"); }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::json::exception& e) {
+        error = "Failed to parse inverted index at byte " + std::to_string(position) + ": " + e.what();
+        return false;
+    }
+};
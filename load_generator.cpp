@@ -0,0 +1,366 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include "nlohmann/json.hpp"
+#include "corpus_generator.h"
+#include "local_socket.h"
+#include "metrics.h"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+// ----------------------------------------------------
+// Open-loop load generator for `search --listen` and
+// `autocomplete --listen`
+//
+// Requests are sent on a fixed schedule: request i is due at
+// start + i / qps, or at Poisson arrivals with --poisson. They go out at
+// that time whether or not earlier replies have come back. Each latency
+// is measured from the request's due time, not from when it was actually
+// written. A stalled server therefore shows up in the tail, instead of
+// silently lowering the offered load (coordinated omission).
+//
+// Each --qps rate is one step of the run. A step reports its achieved
+// throughput, p50/p90/p99/p999/max latency, errors and timeouts. Together
+// the steps form the QPS-vs-latency curve that --out writes as JSON.
+// POSIX only, like the --listen servers.
+// ----------------------------------------------------
+
+// -------------------- Query mix --------------------
+// Replays a log in order, or draws Zipfian queries from lexicon.json.
+// lexIDs follow term frequency, so rank order is frequency order.
+class QueryMix {
+private:
+    std::vector<std::string> log;
+    std::vector<std::string> words;
+    std::unique_ptr<ZipfSampler> zipf;
+    SplitMix64 rng;
+    uint32_t maxWords = 1;
+    bool prefixes = false;
+    size_t next = 0;
+
+public:
+    explicit QueryMix(uint64_t seed) : rng(seed) {}
+
+    // Control words of the servers are never replayed: 'quit' would stop them
+    bool loadLog(const std::string& file) {
+        std::ifstream in(file);
+        if (!in) return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line == "quit" || line == "stats" || line.compare(0, 7, "metrics") == 0) continue;
+            log.push_back(line);
+        }
+        return !log.empty();
+    }
+
+    bool loadLexicon(const std::string& file, double s, uint32_t wordsPerQuery, bool prefixMode) {
+        std::ifstream in(file);
+        if (!in) return false;
+        json lex;
+        try {
+            in >> lex;
+        } catch (json::exception&) {
+            return false;
+        }
+        for (auto& w : lex["lexicon"]) words.push_back(w.get<std::string>());
+        if (words.empty()) return false;
+        zipf = std::make_unique<ZipfSampler>(words.size(), s);
+        maxWords = std::max<uint32_t>(1, wordsPerQuery);
+        prefixes = prefixMode;
+        return true;
+    }
+
+    std::string query() {
+        if (!log.empty()) return log[next++ % log.size()];
+
+        const std::string& first = words[zipf->sample(rng)];
+        if (prefixes) return first.substr(0, 1 + rng.below(first.size()));
+        std::string q = first;
+        for (uint32_t n = rng.below(maxWords); n > 0; n--) q += " " + words[zipf->sample(rng)];
+        return q;
+    }
+};
+
+// -------------------- One rate step --------------------
+struct StepResult {
+    double targetQPS = 0;
+    double achievedQPS = 0;
+    uint64_t sent = 0, completed = 0, errors = 0, timeouts = 0;
+    uint64_t lateSends = 0;         // requests written more than 1 ms after their due time
+    HistogramSnapshot latency;      // ns, measured from the due time
+
+    json toJson() const {
+        return {{"target_qps", targetQPS}, {"achieved_qps", achievedQPS},
+                {"sent", sent}, {"completed", completed}, {"errors", errors}, {"timeouts", timeouts},
+                {"late_sends", lateSends},
+                {"p50_ms", latency.quantile(0.50) / 1e6}, {"p90_ms", latency.quantile(0.90) / 1e6},
+                {"p99_ms", latency.quantile(0.99) / 1e6}, {"p999_ms", latency.quantile(0.999) / 1e6},
+                {"max_ms", latency.max / 1e6}, {"mean_ms", latency.mean() / 1e6}};
+    }
+};
+
+struct LoadOptions {
+    std::string socket;
+    double duration = 10;       // seconds measured per step
+    double warmup = 1;          // seconds sent but not measured
+    int connections = 4;
+    double timeoutMs = 1000;
+    bool poisson = false;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string in;
+    std::string out;                                      // requests not yet written
+    std::deque<std::pair<Clock::time_point, bool>> due;   // due time, measured
+};
+
+// Reads what is available; false when the connection failed
+bool readReplies(Connection& c, const std::function<void(Clock::time_point, bool)>& done) {
+    char buf[1 << 16];
+    bool open = true;
+    for (;;) {
+        ssize_t got = ::recv(c.fd, buf, sizeof(buf), 0);
+        if (got > 0) { c.in.append(buf, got); continue; }
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        open = false;   // closed or failed; replies already read still count
+        break;
+    }
+
+    // "<bytes>\n" then the body
+    size_t pos = 0;
+    for (;;) {
+        size_t eol = c.in.find('\n', pos);
+        if (eol == std::string::npos) break;
+        size_t bytes = std::stoul(c.in.substr(pos, eol - pos));
+        if (c.in.size() < eol + 1 + bytes) break;
+        pos = eol + 1 + bytes;
+        if (c.due.empty()) return false;    // a reply nobody asked for
+        done(c.due.front().first, c.due.front().second);
+        c.due.pop_front();
+    }
+    c.in.erase(0, pos);
+    return open;
+}
+
+StepResult runStep(const LoadOptions& opt, double qps, QueryMix& mix, std::string& error) {
+    StepResult step;
+    step.targetQPS = qps;
+
+    std::vector<Connection> conns(opt.connections);
+    for (auto& c : conns) {
+        c.fd = connectLocalSocket(opt.socket, error);
+        if (c.fd < 0) {
+            for (auto& o : conns) if (o.fd >= 0) ::close(o.fd);
+            return step;
+        }
+        ::fcntl(c.fd, F_SETFL, ::fcntl(c.fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    auto histogram = std::make_unique<Histogram>();
+    auto timeout = std::chrono::nanoseconds((int64_t)(opt.timeoutMs * 1e6));
+    auto onReply = [&](Clock::time_point due, bool measured) {
+        if (!measured) return;
+        // Each request counts once: a reply after the timeout is a timeout
+        auto latency = Clock::now() - due;
+        if (latency > timeout) {
+            step.timeouts++;
+            return;
+        }
+        histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+        step.completed++;
+    };
+
+    SplitMix64 arrivals(0x5EED ^ (uint64_t)qps);
+    Clock::time_point start = Clock::now() + std::chrono::milliseconds(10);
+    Clock::time_point measureFrom = start + std::chrono::nanoseconds((int64_t)(opt.warmup * 1e9));
+    Clock::time_point end = measureFrom + std::chrono::nanoseconds((int64_t)(opt.duration * 1e9));
+    Clock::time_point nextDue = start;
+    double interval = 1e9 / qps;
+    size_t turn = 0;
+    std::vector<pollfd> polls(conns.size());
+
+    auto outstanding = [&]() {
+        size_t n = 0;
+        for (auto& c : conns) n += c.due.size();
+        return n;
+    };
+    auto failConnection = [&](Connection& c) {
+        for (auto& d : c.due) if (d.second) step.errors++;
+        c.due.clear();
+        c.out.clear();
+        if (c.fd >= 0) ::close(c.fd);
+        c.fd = -1;
+    };
+
+    for (;;) {
+        Clock::time_point now = Clock::now();
+
+        // Send everything that is due, late or not
+        while (nextDue < end && nextDue <= now) {
+            Connection* c = nullptr;
+            for (size_t tries = 0; tries < conns.size() && !c; tries++) {
+                Connection& candidate = conns[turn++ % conns.size()];
+                if (candidate.fd >= 0) c = &candidate;
+            }
+            bool measured = nextDue >= measureFrom;
+            if (measured) step.sent++;
+            if (!c) {
+                if (measured) step.errors++;
+            } else {
+                if (Clock::now() - nextDue > std::chrono::milliseconds(1) && measured) step.lateSends++;
+                c->due.push_back({nextDue, measured});
+                c->out += mix.query();
+                c->out += '\n';
+                if (!flushOutput(c->fd, c->out)) failConnection(*c);
+            }
+            double gap = opt.poisson ? -std::log(1.0 - arrivals.uniform()) * interval : interval;
+            nextDue += std::chrono::nanoseconds((int64_t)gap);
+        }
+
+        // Done once the schedule is over and every reply is in or overdue
+        if (nextDue >= end) {
+            if (outstanding() == 0) break;
+            bool overdue = true;
+            for (auto& c : conns)
+                if (!c.due.empty() && now - c.due.front().first < timeout) overdue = false;
+            if (overdue) {
+                for (auto& c : conns) {
+                    for (auto& d : c.due) if (d.second) step.timeouts++;
+                    c.due.clear();
+                }
+                break;
+            }
+        }
+
+        // Wait for replies, and for room to write queued requests, until the
+        // next request is due. Replies are drained while requests wait, so
+        // neither side blocks on a full socket buffer.
+        for (size_t i = 0; i < conns.size(); i++)
+            polls[i] = pollfd{conns[i].fd, (short)(conns[i].out.empty() ? POLLIN : POLLIN | POLLOUT), 0};
+        auto wait = nextDue < end ? nextDue - now : std::chrono::nanoseconds(std::chrono::milliseconds(10));
+        int64_t ns = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+        timespec ts{(time_t)(ns / 1000000000), (long)(ns % 1000000000)};
+        if (::ppoll(polls.data(), polls.size(), &ts, nullptr) < 0 && errno != EINTR) {
+            error = std::string("poll failed: ") + std::strerror(errno);
+            break;
+        }
+        for (size_t i = 0; i < conns.size(); i++) {
+            if (conns[i].fd < 0) continue;
+            if ((polls[i].revents & POLLOUT) && !flushOutput(conns[i].fd, conns[i].out)) {
+                failConnection(conns[i]);
+                continue;
+            }
+            if (!(polls[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (!readReplies(conns[i], onReply)) failConnection(conns[i]);
+        }
+    }
+
+    for (auto& c : conns) if (c.fd >= 0) ::close(c.fd);
+    step.latency = histogram->snapshot();
+    step.achievedQPS = step.completed / opt.duration;
+    return step;
+}
+
+// -------------------- Main --------------------
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: load_generator <socket> --qps <rate[,rate...]>\n"
+                  << "       (--log <queries.txt> | --lexicon <lexicon.json> [--zipf <s>] [--words <max>] [--prefixes])\n"
+                  << "       [--duration <s>] [--warmup <s>] [--connections <n>] [--timeout-ms <ms>]\n"
+                  << "       [--poisson] [--seed <n>] [--out <curve.json>]\n"
+                  << "The server is `search --listen <socket> ...` or `autocomplete <lexicon.json> --listen <socket>`.\n";
+        return 1;
+    }
+
+    LoadOptions opt;
+    opt.socket = argv[1];
+    std::vector<double> rates;
+    std::string logFile, lexiconFile, outFile;
+    double zipfS = 1.0;
+    uint32_t maxWords = 2;
+    bool prefixes = false;
+    uint64_t seed = 42;
+    for (int i = 2; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--qps" && hasValue) {
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos <= list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                if (comma > pos) rates.push_back(std::stod(list.substr(pos, comma - pos)));
+                pos = comma + 1;
+            }
+        }
+        else if (a == "--log" && hasValue) logFile = argv[++i];
+        else if (a == "--lexicon" && hasValue) lexiconFile = argv[++i];
+        else if (a == "--zipf" && hasValue) zipfS = std::stod(argv[++i]);
+        else if (a == "--words" && hasValue) maxWords = std::stoul(argv[++i]);
+        else if (a == "--prefixes") prefixes = true;
+        else if (a == "--duration" && hasValue) opt.duration = std::stod(argv[++i]);
+        else if (a == "--warmup" && hasValue) opt.warmup = std::stod(argv[++i]);
+        else if (a == "--connections" && hasValue) opt.connections = std::max(1, std::stoi(argv[++i]));
+        else if (a == "--timeout-ms" && hasValue) opt.timeoutMs = std::stod(argv[++i]);
+        else if (a == "--poisson") opt.poisson = true;
+        else if (a == "--seed" && hasValue) seed = std::stoull(argv[++i]);
+        else if (a == "--out" && hasValue) outFile = argv[++i];
+        else { std::cerr << "ERROR: Unknown option " << a << "\n"; return 1; }
+    }
+    rates.erase(std::remove_if(rates.begin(), rates.end(), [](double r) { return r <= 0; }), rates.end());
+    if (rates.empty()) { std::cerr << "ERROR: --qps needs at least one positive rate\n"; return 1; }
+
+    QueryMix mix(seed);
+    if (!logFile.empty()) {
+        if (!mix.loadLog(logFile)) { std::cerr << "ERROR: No queries in " << logFile << "\n"; return 1; }
+    } else if (!lexiconFile.empty()) {
+        if (!mix.loadLexicon(lexiconFile, zipfS, maxWords, prefixes)) {
+            std::cerr << "ERROR: Cannot read lexicon " << lexiconFile << "\n";
+            return 1;
+        }
+    } else {
+        std::cerr << "ERROR: Give a query log (--log) or a lexicon (--lexicon)\n";
+        return 1;
+    }
+
+    std::cout << "target_qps achieved_qps      p50_ms      p99_ms     p999_ms      max_ms  errors  timeouts\n";
+    json curve = json::array();
+    for (double qps : rates) {
+        std::string error;
+        StepResult step = runStep(opt, qps, mix, error);
+        if (!error.empty()) { std::cerr << "ERROR: " << error << "\n"; return 1; }
+
+        char row[160];
+        std::snprintf(row, sizeof(row), "%10.0f %12.1f %11.3f %11.3f %11.3f %11.3f %7llu %9llu",
+                      qps, step.achievedQPS, step.latency.quantile(0.50) / 1e6,
+                      step.latency.quantile(0.99) / 1e6, step.latency.quantile(0.999) / 1e6,
+                      step.latency.max / 1e6, (unsigned long long)step.errors, (unsigned long long)step.timeouts);
+        std::cout << row << "\n" << std::flush;
+        curve.push_back(step.toJson());
+    }
+
+    if (!outFile.empty()) {
+        std::ofstream out(outFile);
+        out << json{{"socket", opt.socket}, {"duration_s", opt.duration}, {"warmup_s", opt.warmup},
+                    {"connections", opt.connections}, {"timeout_ms", opt.timeoutMs},
+                    {"arrivals", opt.poisson ? "poisson" : "uniform"},
+                    {"queries", logFile.empty() ? "zipf:" + lexiconFile : "log:" + logFile},
+                    {"steps", curve}}.dump(4) << "\n";
+        if (!out) { std::cerr << "ERROR: Cannot write " << outFile << "\n"; return 1; }
+        std::cout << "✓ Curve: " << outFile << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------
+// Line protocol over a local (Unix domain) socket
+//
+// A request is one line. The reply is its length in decimal, a newline,
+// then that many bytes:
+//
+//   client: "covid vaccine\n"
+//   server: "1234\n" + 1234 bytes of output
+//
+// A connection may pipeline requests; replies come back in request
+// order. The server answers one request at a time, so queueing shows
+// up in the client's latency the way it would in a resident process.
+// Both ends write without blocking and keep unsent bytes per connection,
+// so a peer that stops reading never stalls the other side.
+// ----------------------------------------------------
+#ifndef _WIN32
+
+// Writes as much of out as the socket takes without blocking and drops
+// what was sent; false when the connection failed
+inline bool flushOutput(int fd, std::string& out) {
+    size_t done = 0;
+    while (done < out.size()) {
+        ssize_t sent = ::send(fd, out.data() + done, out.size() - done, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (sent <= 0) return false;
+        done += sent;
+    }
+    out.erase(0, done);
+    return true;
+}
+
+inline bool socketAddress(const std::string& path, sockaddr_un& addr, std::string& error) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        error = "Socket path too long: " + path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Blocking connection to a listening server; -1 on failure
+inline int connectLocalSocket(const std::string& path, std::string& error) {
+    sockaddr_un addr;
+    if (!socketAddress(path, addr, error)) return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = "Cannot connect to " + path + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Serves requests until handler returns false. The handler fills reply
+// for every request, including the one that stops the server.
+inline bool serveLocalSocket(const std::string& path,
+                             const std::function<bool(const std::string&, std::string&)>& handler,
+                             std::string& error) {
+    // A client with this much unsent output is not read from until it
+    // drains some of it, so a reader that fell behind cannot grow it forever
+    const size_t MAX_BUFFERED_OUTPUT = 4 << 20;
+
+    sockaddr_un addr;
+    if (!socketAddress(path, addr, error)) return false;
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(path.c_str()); // a stale socket from an earlier run
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener, 64) != 0) {
+        error = "Cannot listen on " + path + ": " + std::strerror(errno);
+        if (listener >= 0) ::close(listener);
+        return false;
+    }
+
+    struct Client { int fd; std::string pending; std::string out; };
+    std::vector<Client> clients;
+    std::vector<pollfd> polls;
+    std::string reply;
+    char buf[1 << 16];
+    bool running = true;
+
+    auto drop = [](Client& c) {
+        ::close(c.fd);
+        c.fd = -1;
+    };
+
+    while (running) {
+        polls.assign(1, pollfd{listener, POLLIN, 0});
+        for (auto& c : clients) {
+            short events = c.out.size() < MAX_BUFFERED_OUTPUT ? POLLIN : 0;
+            if (!c.out.empty()) events |= POLLOUT;
+            polls.push_back(pollfd{c.fd, events, 0});
+        }
+        if (::poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("poll failed: ") + std::strerror(errno);
+            break;
+        }
+
+        if (polls[0].revents & POLLIN) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd >= 0) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                clients.push_back({fd, std::string(), std::string()});
+            }
+        }
+
+        for (size_t i = 1; i < polls.size() && running; i++) {
+            Client& c = clients[i - 1];
+            if ((polls[i].revents & POLLOUT) && !flushOutput(c.fd, c.out)) {
+                drop(c);
+                continue;
+            }
+            if (!(polls[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t got = ::recv(c.fd, buf, sizeof(buf), 0);
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if (got <= 0) {
+                drop(c);
+                continue;
+            }
+            c.pending.append(buf, got);
+
+            size_t start = 0, eol;
+            while (running && (eol = c.pending.find('\n', start)) != std::string::npos) {
+                std::string request = c.pending.substr(start, eol - start);
+                if (!request.empty() && request.back() == '\r') request.pop_back();
+                start = eol + 1;
+
+                reply.clear();
+                running = handler(request, reply);
+                c.out += std::to_string(reply.size());
+                c.out += '\n';
+                c.out += reply;
+            }
+            c.pending.erase(0, start);
+            if (!flushOutput(c.fd, c.out)) drop(c);
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Client& c) { return c.fd < 0; }), clients.end());
+    }
+
+    // Give the reply to the stopping request (and anything queued before
+    // it) a moment to go out before closing
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    for (auto& c : clients) {
+        while (!c.out.empty() && std::chrono::steady_clock::now() < deadline) {
+            if (!flushOutput(c.fd, c.out)) break;
+            pollfd p{c.fd, POLLOUT, 0};
+            if (!c.out.empty()) ::poll(&p, 1, 10);
+        }
+        ::close(c.fd);
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+    return error.empty();
+}
+
+#else
+
+inline int connectLocalSocket(const std::string& path, std::string& error) {
+    error = "Local sockets are not supported on this platform (" + path + ")";
+    return -1;
+}
+
+inline bool serveLocalSocket(const std::string& path,
+                             const std::function<bool(const std::string&, std::string&)>&,
+                             std::string& error) {
+    error = "Local sockets are not supported on this platform (" + path + ")";
+    return false;
+}
+
+#endif
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// ----------------------------------------------------
+// Memory accounting
+//
+// Resident set size comes from /proc/self/status on Linux (VmRSS now,
+// VmHWM for the peak), from getrusage() on other POSIX systems (peak
+// only) and from GetProcessMemoryInfo on Windows. Per-stage peaks rely on
+// Linux's /proc/self/clear_refs, which resets VmHWM to the current RSS;
+// elsewhere a stage reports the process peak so far.
+//
+// Structure sizes are estimates built from element counts and
+// capacities: the heap payload of each container plus the per-node
+// overhead of node-based ones. They are not allocator measurements, but
+// they show which structure dominates and how it grows.
+// ----------------------------------------------------
+
+#ifdef __linux__
+// A "VmXXX:  1234 kB" field of /proc/self/status, in bytes; 0 if absent
+inline uint64_t procStatusBytes(const char* field) {
+    std::FILE* f = std::fopen("/proc/self/status", "r");
+    if (!f) return 0;
+    char line[256];
+    size_t n = std::strlen(field);
+    uint64_t kb = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        if (std::strncmp(line, field, n) == 0 && line[n] == ':') {
+            kb = std::strtoull(line + n + 1, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(f);
+    return kb * 1024;
+}
+#endif
+
+inline uint64_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.PeakWorkingSetSize : 0;
+#else
+#ifdef __linux__
+    if (uint64_t hwm = procStatusBytes("VmHWM")) return hwm;
+#endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);          // bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // kilobytes elsewhere
+#endif
+#endif
+}
+
+// Current RSS; the peak where only the peak is known
+inline uint64_t currentRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.WorkingSetSize : 0;
+#else
+#ifdef __linux__
+    if (uint64_t rss = procStatusBytes("VmRSS")) return rss;
+#endif
+    return peakRssBytes();
+#endif
+}
+
+// Part of the RSS that is file pages (mapped indexes and inputs), which
+// the kernel can drop under pressure; 0 where unknown
+inline uint64_t mappedRssBytes() {
+#ifdef __linux__
+    return procStatusBytes("RssFile");
+#else
+    return 0;
+#endif
+}
+
+// Starts a new peak at the current RSS; false where that is not possible
+inline bool resetPeakRss() {
+#ifdef __linux__
+    std::FILE* f = std::fopen("/proc/self/clear_refs", "w");
+    if (!f) return false;
+    bool ok = std::fputs("5", f) >= 0;
+    return std::fclose(f) == 0 && ok;
+#else
+    return false;
+#endif
+}
+
+// "12.3 MB"
+inline std::string formatBytes(uint64_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (bytes >= (1ull << 30)) out << bytes / double(1ull << 30) << " GB";
+    else if (bytes >= (1ull << 20)) out << bytes / double(1ull << 20) << " MB";
+    else out << bytes / 1024.0 << " KB";
+    return out.str();
+}
+
+// What a budget leaves once the current RSS is accounted for
+inline uint64_t memoryHeadroom(uint64_t budgetBytes) {
+    uint64_t rss = currentRssBytes();
+    return budgetBytes > rss ? budgetBytes - rss : 0;
+}
+
+// -------------------- Structure size estimates --------------------
+// heapBytes(x) is what x owns on the heap, not counting sizeof(x) itself.
+// The templates are declared up front so nested containers find each other.
+
+// Types whose elements need no walk: nothing of theirs is on the heap
+template <typename T> constexpr bool ownsNoHeap = std::is_trivially_copyable_v<T>;
+template <typename A, typename B> constexpr bool ownsNoHeap<std::pair<A, B>> = ownsNoHeap<A> && ownsNoHeap<B>;
+
+template <typename T>
+std::enable_if_t<ownsNoHeap<T>, uint64_t> heapBytes(const T&) { return 0; }
+inline uint64_t heapBytes(const std::string& s);
+template <typename A, typename B>
+std::enable_if_t<!ownsNoHeap<std::pair<A, B>>, uint64_t> heapBytes(const std::pair<A, B>& p);
+template <typename T, typename Alloc> uint64_t heapBytes(const std::vector<T, Alloc>& v);
+template <typename K, typename V, typename H, typename E, typename Alloc>
+uint64_t heapBytes(const std::unordered_map<K, V, H, E, Alloc>& m);
+template <typename K, typename H, typename E, typename Alloc>
+uint64_t heapBytes(const std::unordered_set<K, H, E, Alloc>& s);
+inline uint64_t heapBytes(const nlohmann::json& j);
+
+// Short strings live inside the object (SSO)
+inline uint64_t heapBytes(const std::string& s) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return s.capacity() > inlineCapacity ? s.capacity() + 1 : 0;
+}
+
+template <typename A, typename B>
+std::enable_if_t<!ownsNoHeap<std::pair<A, B>>, uint64_t> heapBytes(const std::pair<A, B>& p) {
+    return heapBytes(p.first) + heapBytes(p.second);
+}
+
+template <typename T, typename Alloc>
+uint64_t heapBytes(const std::vector<T, Alloc>& v) {
+    uint64_t total = v.capacity() * sizeof(T);
+    if constexpr (!ownsNoHeap<T>)
+        for (const T& e : v) total += heapBytes(e);
+    return total;
+}
+
+// One element of a hash container: the value, the next pointer and the
+// cached hash (libstdc++ and MSVC keep one per node for most key types)
+template <typename Container>
+constexpr size_t hashNodeBytes() {
+    return sizeof(typename Container::value_type) + sizeof(void*) + sizeof(size_t);
+}
+
+template <typename K, typename V, typename H, typename E, typename Alloc>
+uint64_t heapBytes(const std::unordered_map<K, V, H, E, Alloc>& m) {
+    using Map = std::unordered_map<K, V, H, E, Alloc>;
+    uint64_t total = m.bucket_count() * sizeof(void*) + m.size() * hashNodeBytes<Map>();
+    if constexpr (!ownsNoHeap<K> || !ownsNoHeap<V>)
+        for (const auto& [key, value] : m) total += heapBytes(key) + heapBytes(value);
+    return total;
+}
+
+template <typename K, typename H, typename E, typename Alloc>
+uint64_t heapBytes(const std::unordered_set<K, H, E, Alloc>& s) {
+    using Set = std::unordered_set<K, H, E, Alloc>;
+    uint64_t total = s.bucket_count() * sizeof(void*) + s.size() * hashNodeBytes<Set>();
+    if constexpr (!ownsNoHeap<K>)
+        for (const K& key : s) total += heapBytes(key);
+    return total;
+}
+
+// A nlohmann DOM: objects are std::maps (a red-black node per member),
+// arrays vectors of 16-byte values, strings separately allocated
+inline uint64_t heapBytes(const nlohmann::json& j) {
+    using json = nlohmann::json;
+    const uint64_t treeNode = 4 * sizeof(void*);    // colour and three links
+    switch (j.type()) {
+    case json::value_t::object: {
+        const auto& object = j.get_ref<const json::object_t&>();
+        uint64_t total = sizeof(json::object_t) + object.size() * (treeNode + sizeof(json::object_t::value_type));
+        for (const auto& [key, value] : object) total += heapBytes(key) + heapBytes(value);
+        return total;
+    }
+    case json::value_t::array: {
+        const auto& array = j.get_ref<const json::array_t&>();
+        uint64_t total = sizeof(json::array_t) + array.capacity() * sizeof(json);
+        for (const json& value : array) total += heapBytes(value);
+        return total;
+    }
+    case json::value_t::string:
+        return sizeof(json::string_t) + heapBytes(j.get_ref<const json::string_t&>());
+    case json::value_t::binary:
+        return sizeof(json::binary_t) + j.get_binary().capacity();
+    default:
+        return 0;
+    }
+}
+
+// -------------------- Report --------------------
+// Collects stage peaks and structure estimates for --memory-report.
+// Disabled, it records nothing, so the estimates (some walk a whole
+// structure) are only computed when asked for.
+class MemoryReport {
+private:
+    struct Line {
+        bool stage;
+        std::string name;
+        uint64_t bytes;     // stage: peak RSS during the stage
+        uint64_t rss;       // stage: RSS at its end
+        uint64_t mapped;    // stage: file pages in that RSS
+    };
+    bool on;
+    uint64_t budget;
+    bool stagePeaks;
+    std::vector<Line> lines;
+
+public:
+    explicit MemoryReport(bool enabled = false, uint64_t budgetBytes = 0)
+        : on(enabled), budget(budgetBytes), stagePeaks(enabled && resetPeakRss()) {}
+
+    bool enabled() const { return on; }
+
+    // Closes a stage: its peak RSS, then a fresh peak for the next one
+    void stage(const std::string& name) {
+        if (!on) return;
+        lines.push_back({true, name, peakRssBytes(), currentRssBytes(), mappedRssBytes()});
+        if (stagePeaks) resetPeakRss();
+    }
+
+    void structure(const std::string& name, uint64_t bytes) {
+        if (on) lines.push_back({false, name, bytes, 0, 0});
+    }
+
+    // Peak RSS of the whole run so far, whatever the stages reset
+    uint64_t peak() const {
+        uint64_t p = peakRssBytes();
+        for (const Line& l : lines) if (l.stage) p = std::max(p, l.bytes);
+        return p;
+    }
+
+    void print(std::ostream& out) const {
+        if (!on) return;
+        out << "Memory: peak RSS " << formatBytes(peak());
+        if (budget) out << " of a " << formatBytes(budget) << " budget";
+        out << (stagePeaks ? "" : " (stage peaks are cumulative here)") << "\n";
+        for (const Line& l : lines) {
+            out << "  " << (l.stage ? "stage " : "      ") << std::left << std::setw(34) << l.name << std::right;
+            if (l.stage) {
+                out << " peak " << std::setw(9) << formatBytes(l.bytes) << ", RSS after " << formatBytes(l.rss);
+                if (l.mapped) out << " (" << formatBytes(l.mapped) << " mapped files)";
+                out << "\n";
+            }
+            else out << " ~" << formatBytes(l.bytes) << "\n";
+        }
+    }
+
+    // "WARNING: ..." on stderr when the run went over its budget
+    void warnOverBudget() const {
+        if (budget && peak() > budget)
+            std::cerr << "WARNING: peak RSS " << formatBytes(peak()) << " exceeded --memory-budget "
+                      << formatBytes(budget) << "\n";
+    }
+};
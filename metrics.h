@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+// ----------------------------------------------------
+// Metrics registry: counters and latency histograms
+//
+// Every metric is split into METRIC_SHARDS cache-line-aligned shards. A
+// thread always writes the shard it was given on first use. Recording is
+// therefore one relaxed atomic add on a line that other threads rarely
+// touch. Reading sums the shards, so only reporting pays.
+//
+// Histograms are HDR-style: values below 16 get exact buckets, and every
+// power of two above that is split into 16 linear buckets. Any recorded
+// value is known to within 1/16 (6.25%), with a fixed 976 buckets
+// covering the whole uint64 range. Latencies are recorded in nanoseconds
+// and exported in seconds (Prometheus) or microseconds (JSON).
+//
+// Naming follows Prometheus: counters end in _total, latency histograms
+// in _seconds.
+// ----------------------------------------------------
+static const int METRIC_SHARDS = 8;
+
+inline int metricShard() {
+    static std::atomic<int> next{0};
+    thread_local int shard = next.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    return shard;
+}
+
+class Counter {
+private:
+    struct alignas(64) Slot { std::atomic<uint64_t> value{0}; };
+    std::array<Slot, METRIC_SHARDS> slots;
+
+public:
+    void add(uint64_t n = 1) { slots[metricShard()].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (auto& s : slots) total += s.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    // Value at quantile q (0..1), as the midpoint of its bucket
+    uint64_t quantile(double q) const;
+    double mean() const { return count ? double(sum) / count : 0.0; }
+};
+
+class Histogram {
+public:
+    static const int SUB_BITS = 4;
+    static const int SUB = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    static int bucketOf(uint64_t v) {
+        if (v < (uint64_t)SUB) return (int)v;
+        int msb = 63 - countLeadingZeros(v);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + (int)((v >> shift) - SUB);
+    }
+
+    static uint64_t bucketLow(int b) {
+        if (b < SUB) return b;
+        int shift = b / SUB - 1;
+        return uint64_t(b % SUB + SUB) << shift;
+    }
+
+    static uint64_t bucketMid(int b) {
+        if (b < SUB) return b;
+        int shift = b / SUB - 1;
+        return bucketLow(b) + (shift ? (uint64_t(1) << (shift - 1)) : 0);
+    }
+
+    void record(uint64_t v) {
+        Shard& s = shards[metricShard()];
+        s.buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+        s.sum.fetch_add(v, std::memory_order_relaxed);
+        uint64_t seen = s.max.load(std::memory_order_relaxed);
+        while (v > seen && !s.max.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {}
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot snap;
+        snap.buckets.assign(BUCKETS, 0);
+        for (auto& s : shards) {
+            for (int b = 0; b < BUCKETS; b++) {
+                uint64_t n = s.buckets[b].load(std::memory_order_relaxed);
+                snap.buckets[b] += n;
+                snap.count += n;
+            }
+            snap.sum += s.sum.load(std::memory_order_relaxed);
+            snap.max = std::max(snap.max, s.max.load(std::memory_order_relaxed));
+        }
+        return snap;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+    std::array<Shard, METRIC_SHARDS> shards;
+
+    static int countLeadingZeros(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(v);
+#endif
+    }
+};
+
+inline uint64_t HistogramSnapshot::quantile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)(q * count + 0.5));
+    uint64_t seen = 0;
+    for (int b = 0; b < (int)buckets.size(); b++) {
+        seen += buckets[b];
+        if (seen >= rank) return std::min(Histogram::bucketMid(b), max);
+    }
+    return max;
+}
+
+// -------------------- Registry --------------------
+class MetricsRegistry {
+private:
+    struct Entry {
+        std::string name, help;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Histogram> histogram;
+    };
+    mutable std::mutex lock;
+    std::vector<Entry> entries;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+    Entry* find(const std::string& name) {
+        for (auto& e : entries) if (e.name == name) return &e;
+        return nullptr;
+    }
+
+public:
+    // Registration takes a lock; keep the returned reference and record
+    // through it on hot paths
+    Counter& counter(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (Entry* e = find(name)) return *e->counter;
+        entries.push_back({name, help, std::make_unique<Counter>(), nullptr});
+        return *entries.back().counter;
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (Entry* e = find(name)) return *e->histogram;
+        entries.push_back({name, help, nullptr, std::make_unique<Histogram>()});
+        return *entries.back().histogram;
+    }
+
+    double uptimeSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    // Counters with their average rate since start; histograms in microseconds
+    nlohmann::json toJson() const {
+        std::lock_guard<std::mutex> guard(lock);
+        double uptime = uptimeSeconds();
+        nlohmann::json out = {{"uptime_seconds", uptime},
+                              {"counters", nlohmann::json::object()},
+                              {"histograms", nlohmann::json::object()}};
+        for (auto& e : entries) {
+            if (e.counter) {
+                uint64_t v = e.counter->value();
+                out["counters"][e.name] = {{"value", v}, {"per_second", uptime > 0 ? v / uptime : 0.0}};
+            } else {
+                HistogramSnapshot s = e.histogram->snapshot();
+                out["histograms"][e.name] = {
+                    {"count", s.count}, {"mean_us", s.mean() / 1e3},
+                    {"p50_us", s.quantile(0.50) / 1e3}, {"p90_us", s.quantile(0.90) / 1e3},
+                    {"p99_us", s.quantile(0.99) / 1e3}, {"p999_us", s.quantile(0.999) / 1e3},
+                    {"max_us", s.max / 1e3}};
+            }
+        }
+        return out;
+    }
+
+    // Prometheus text exposition; histograms as summaries with quantiles
+    std::string toPrometheus() const {
+        std::lock_guard<std::mutex> guard(lock);
+        std::ostringstream out;
+        for (auto& e : entries) {
+            out << "# HELP " << e.name << " " << e.help << "\n";
+            if (e.counter) {
+                out << "# TYPE " << e.name << " counter\n" << e.name << " " << e.counter->value() << "\n";
+                continue;
+            }
+            HistogramSnapshot s = e.histogram->snapshot();
+            out << "# TYPE " << e.name << " summary\n";
+            for (double q : {0.5, 0.9, 0.99, 0.999})
+                out << e.name << "{quantile=\"" << q << "\"} " << s.quantile(q) / 1e9 << "\n";
+            out << e.name << "_sum " << s.sum / 1e9 << "\n";
+            out << e.name << "_count " << s.count << "\n";
+        }
+        return out.str();
+    }
+
+    // .prom files get Prometheus text, anything else JSON
+    bool writeFile(const std::string& path) const {
+        std::ofstream out(path);
+        bool prom = path.size() >= 5 && path.compare(path.size() - 5, 5, ".prom") == 0;
+        out << (prom ? toPrometheus() : toJson().dump(4) + "\n");
+        return static_cast<bool>(out);
+    }
+};
+
+inline MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// Records the time from construction to destruction (or stop())
+class ScopedTimer {
+private:
+    Histogram* histogram;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    explicit ScopedTimer(Histogram& h) : histogram(&h) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() { stop(); }
+
+    void stop() {
+        if (!histogram) return;
+        histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        histogram = nullptr;
+    }
+};
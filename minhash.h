@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "memory_usage.h"
+#include "unicode_text.h"
+
+// ----------------------------------------------------
+// MinHash signatures over word shingles, with LSH banding
+//
+// A document becomes the set of its k-word shingles (the tokenizer's
+// folded words). MINHASH_SIZE hash functions
+// keep their minimum over that set; the fraction of equal minima
+// estimates the Jaccard similarity of two documents.
+//
+// The signature is cut into MINHASH_BANDS bands of MINHASH_ROWS values.
+// Two documents become candidates when any band matches exactly, which
+// for 16 x 8 happens with probability ~0.5 at similarity 0.7 and ~0.98
+// at 0.85. Candidates are then checked on the full signature.
+// ----------------------------------------------------
+static const int MINHASH_SIZE  = 128;
+static const int MINHASH_BANDS = 16;
+static const int MINHASH_ROWS  = MINHASH_SIZE / MINHASH_BANDS;
+
+using MinHashSignature = std::array<uint32_t, MINHASH_SIZE>;
+
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Returns false when the text has no words at all
+inline bool minhashSignature(const std::string& text, int shingleWords, MinHashSignature& sig,
+                             bool stripAccents = false) {
+    // Odd multipliers and offsets of the hash family, fixed for every run
+    static const auto family = [] {
+        std::array<std::pair<uint64_t, uint64_t>, MINHASH_SIZE> f;
+        for (int i = 0; i < MINHASH_SIZE; i++)
+            f[i] = {mixHash(2 * i + 1) | 1, mixHash(2 * i + 2)};
+        return f;
+    }();
+
+    sig.fill(UINT32_MAX);
+    std::vector<uint64_t> window(shingleWords, 0);
+    uint64_t words = 0;
+
+    auto addShingle = [&](uint64_t shingle) {
+        for (int i = 0; i < MINHASH_SIZE; i++) {
+            uint32_t h = static_cast<uint32_t>((family[i].first * shingle + family[i].second) >> 32);
+            if (h < sig[i]) sig[i] = h;
+        }
+    };
+
+    forEachWord(text, [&](std::string_view w) {
+        uint64_t word = 0;
+        for (unsigned char c : w) word = word * 131 + c;
+        window[words % shingleWords] = mixHash(word);
+        words++;
+        if (words >= (uint64_t)shingleWords) {
+            uint64_t shingle = 0;
+            for (uint64_t j = words - shingleWords; j < words; j++)
+                shingle = mixHash(shingle ^ window[j % shingleWords]);
+            addShingle(shingle);
+        }
+    }, stripAccents);
+
+    // Too short for one shingle: the words themselves form the set
+    if (words > 0 && words < (uint64_t)shingleWords) {
+        for (uint64_t j = 0; j < words; j++) addShingle(window[j]);
+    }
+    return words > 0;
+}
+
+inline double estimateJaccard(const MinHashSignature& a, const MinHashSignature& b) {
+    int equal = 0;
+    for (int i = 0; i < MINHASH_SIZE; i++) equal += a[i] == b[i];
+    return double(equal) / MINHASH_SIZE;
+}
+
+// ----------------------------------------------------
+// Online near-duplicate detection
+// Each document is checked against the canonical documents seen so far
+// and, if it has no near-duplicate, becomes canonical itself. Only
+// canonical documents are kept in the buckets, so work stays linear in
+// the number of documents.
+// ----------------------------------------------------
+class NearDuplicateIndex {
+private:
+    double threshold;
+    std::unordered_map<uint64_t, std::vector<int>> buckets;   // band key → canonical docIDs
+    std::unordered_map<int, MinHashSignature> signatures;
+    uint64_t comparisons = 0;
+
+    static uint64_t bandKey(const MinHashSignature& sig, int band) {
+        uint64_t h = mixHash(band + 1);
+        for (int r = 0; r < MINHASH_ROWS; r++) h = mixHash(h ^ sig[band * MINHASH_ROWS + r]);
+        return h;
+    }
+
+public:
+    explicit NearDuplicateIndex(double similarity) : threshold(similarity) {}
+
+    // Canonical docID this document duplicates, or 0 if it is new
+    int check(int docID, const MinHashSignature& sig) {
+        uint64_t keys[MINHASH_BANDS];
+        for (int b = 0; b < MINHASH_BANDS; b++) {
+            keys[b] = bandKey(sig, b);
+            auto it = buckets.find(keys[b]);
+            if (it == buckets.end()) continue;
+            for (int candidate : it->second) {
+                comparisons++;
+                if (estimateJaccard(sig, signatures[candidate]) >= threshold) return candidate;
+            }
+        }
+
+        signatures[docID] = sig;
+        for (int b = 0; b < MINHASH_BANDS; b++) buckets[keys[b]].push_back(docID);
+        return 0;
+    }
+
+    uint64_t candidateChecks() const { return comparisons; }
+    size_t canonicalDocs() const { return signatures.size(); }
+    uint64_t memoryBytes() const { return heapBytes(buckets) + heapBytes(signatures); }
+};
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include "forward_index.h"
+#include "shared_index.h"
+#include "ranking.h"
+#include "doc_store.h"
+
+// ----------------------------------------------------
+// Pick the document's most characteristic terms: tf-idf weighted,
+// strongest first
+// ----------------------------------------------------
+struct WeightedTerm {
+    uint32_t lexID;
+    double weight;
+};
+
+std::vector<WeightedTerm> selectQueryTerms(
+    const ForwardIndex& forward,
+    const Bm25& bm25,
+    uint32_t docID,
+    size_t maxTerms)
+{
+    TermVector terms;
+    std::vector<WeightedTerm> weighted;
+    if (!forward.termVector(docID, terms)) return weighted;
+
+    for (auto& [lexID, freq] : terms) {
+        uint32_t df = forward.df(lexID);
+        if (df == 0) continue;
+        weighted.push_back({lexID, (1.0 + std::log(double(freq))) * bm25.idf(df)});
+    }
+
+    std::sort(weighted.begin(), weighted.end(),
+              [](const WeightedTerm& a, const WeightedTerm& b) { return a.weight > b.weight; });
+    if (weighted.size() > maxTerms) weighted.resize(maxTerms);
+    return weighted;
+}
+
+// -------------------- Main --------------------
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args;
+    std::string docStoreFile;
+    size_t maxTerms = 20;
+    size_t topK = 10;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--terms" && i + 1 < argc) maxTerms = std::stoul(argv[++i]);
+        else if (arg == "--top" && i + 1 < argc) topK = std::stoul(argv[++i]);
+        else if (arg == "--docs" && i + 1 < argc) docStoreFile = argv[++i];
+        else args.push_back(arg);
+    }
+
+    if (args.size() < 3) {
+        std::cout << "Usage: more_like_this <docID> <forward_index.bin> <search_index.bin>\n"
+                  << "       [--terms <n>] [--top <k>] [--docs <docstore.bin>]\n";
+        return 1;
+    }
+
+    uint32_t docID = std::stoul(args[0]);
+
+    ForwardIndex forward;
+    SharedIndex index;
+    DocStore docStore;
+    std::string error;
+    if (!forward.open(args[1], error) || !index.open(args[2], error) ||
+        (!docStoreFile.empty() && !docStore.open(docStoreFile, error))) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+
+    if (!forward.hasDoc(docID)) {
+        std::cout << "Doc " << docID << " is not in the forward index.\n";
+        return 1;
+    }
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    Bm25 bm25;
+    bm25.docCount = forward.indexedDocs();
+    bm25.avgDocLength = forward.averageDocLength();
+
+    // STEP 1: the source document's strongest terms become the query
+    auto selected = selectQueryTerms(forward, bm25, docID, maxTerms);
+    if (selected.empty()) {
+        std::cout << "Doc " << docID << " has no indexed terms.\n";
+        return 0;
+    }
+
+    std::vector<QueryTerm> query;
+    double topWeight = selected.front().weight;
+    std::cout << "Query terms from doc " << docID << ":\n";
+    for (auto& s : selected) {
+        const TermEntry* t = index.findTermByLexID(s.lexID);
+        if (!t || t->postingCount == 0) continue;
+
+        QueryTerm q;
+        q.postings   = index.postings(*t);
+        q.count      = t->postingCount;
+        q.weight     = s.weight / topWeight;
+        q.idf        = bm25.idf(forward.df(s.lexID));
+        q.upperBound = q.weight * bm25.maxScore(q.idf);
+        query.push_back(q);
+
+        std::cout << "  " << index.word(*t) << " (weight: " << q.weight << ")\n";
+    }
+
+    // STEP 2: pruned ranked query, the source document itself excluded
+    RankStats stats;
+    auto results = maxScoreTopK(query, topK, bm25,
+        [&](uint32_t d) { return forward.docLength(d); }, docID, &stats);
+
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "\n=== MORE LIKE DOC " << docID << " ===\n";
+    StoredDocument doc;
+    for (auto& r : results) {
+        std::cout << "Doc " << r.docID << " (score: " << r.score << ")\n";
+        if (!docStoreFile.empty() && docStore.fetch(r.docID, doc)) {
+            if (!doc.title.empty()) std::cout << "    Title: " << doc.title << "\n";
+            std::cout << "    Path:  " << doc.path << "\n";
+        }
+    }
+
+    std::cout << "\nCandidates scored: " << stats.candidates
+              << ", postings scored: " << stats.postingsScored << "\n";
+    std::cout << "Time taken: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+              << " microseconds\n";
+    return 0;
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped_file.h"
+#include "term_arena.h"
+#include "varint.h"
+
+// ----------------------------------------------------
+// Query completion index (completions.bin)
+//
+// Holds frequent word n-grams ("severe acute respiratory syndrome") with
+// their collection counts, so a partial query completes to whole
+// phrases rather than to one word.
+//
+// [PhraseIndexHeader]
+// [phrase blocks]         16 phrases per block, sorted, front-coded:
+//                         varint shared prefix, varint suffix length,
+//                         suffix bytes, varint count
+// [PhraseBlock x blocks]  offset of every block and its highest count
+//
+// A completion binary-searches the blocks holding the prefix, then
+// decodes them best block first and stops once no remaining block can
+// beat the k-th completion found so far.
+// ----------------------------------------------------
+static const char PHRASE_INDEX_MAGIC[8] = {'S','E','P','H','R','0','1','\0'};
+static const uint32_t PHRASES_PER_BLOCK = 16;
+
+struct PhraseIndexHeader {
+    char     magic[8];
+    uint32_t phraseCount;
+    uint32_t blockCount;
+    uint32_t maxWords;
+    uint32_t minCount;          // phrases seen fewer times were pruned
+    uint64_t blocksOffset;
+    uint64_t fileSize;
+};
+
+struct PhraseBlock {
+    uint64_t offset;
+    uint32_t maxCount;
+    uint32_t reserved;
+};
+
+struct PhraseCompletion {
+    std::string phrase;
+    uint32_t count;
+};
+
+// -------------------- Phrase text --------------------
+// Words are the tokenizer's (forEachWord). Phrases never cross sentence
+// punctuation or a blank line.
+template <typename Word, typename Boundary>
+void forEachPhraseWord(std::string_view text, Word onWord, Boundary onBoundary, bool stripAccents = false) {
+    int newlines = 0;
+    scanWords(text, [&](std::string_view w) {
+        newlines = 0;
+        onWord(w);
+    }, [&](std::string_view gap) {
+        for (char c : gap) {
+            if (c == '\n') newlines++;
+            else if (c != '\r' && c != ' ' && c != '\t') newlines = 0;
+            if (c == '.' || c == '!' || c == '?' || c == ';' || c == ':' || newlines == 2) onBoundary();
+        }
+    }, stripAccents);
+}
+
+// Folded words joined by single spaces. A trailing separator is kept
+// as one space, so "severe acute " asks for the word after "acute".
+inline std::string normalizePhrasePrefix(std::string_view query, bool stripAccents = false) {
+    std::string prefix;
+    bool endsInGap = false;
+    scanWords(query, [&](std::string_view w) {
+        if (!prefix.empty()) prefix += ' ';
+        prefix += w;
+        endsInGap = false;
+    }, [&](std::string_view) { endsInGap = true; }, stripAccents);
+    if (!prefix.empty() && endsInGap) prefix += ' ';
+    return prefix;
+}
+
+// What one counted phrase costs in a PhraseCounter: its slot with table
+// slack, its place in the insertion order and its key bytes. Pruning
+// briefly holds a second table, so callers sizing maxEntries from a
+// memory budget should leave room for that.
+static const size_t PHRASE_ENTRY_BYTES = 128;
+
+// ----------------------------------------------------
+// Counts every 1..maxWords-gram while the forward index is built
+//
+// Memory is capped at maxEntries distinct phrases: when the table
+// outgrows it, phrases below the pruning floor are dropped, and the
+// floor rises until at most half the cap remains. A phrase pruned early
+// restarts its count if it comes back, so counts near the floor are
+// lower bounds; frequent phrases are unaffected.
+// ----------------------------------------------------
+class PhraseCounter {
+private:
+    FlatTermMap<uint32_t> counts;
+    uint32_t maxWords;
+    size_t maxEntries;
+    uint32_t floor;             // the minimum count, raised by pruning
+    bool stripAccents;
+    uint64_t prunings = 0;
+
+    std::vector<std::string> window;    // last maxWords words, oldest first
+    std::string key;
+
+    void prune() {
+        while (counts.size() > maxEntries / 2) {
+            FlatTermMap<uint32_t> kept;
+            for (auto p : counts)
+                if (p.second >= floor) kept[p.first] = p.second;
+            bool shrank = kept.size() < counts.size();
+            counts = std::move(kept);
+            if (counts.size() > maxEntries / 2 || !shrank) floor++;
+        }
+        prunings++;
+    }
+
+public:
+    PhraseCounter(uint32_t words = 3, uint32_t minimum = 3, size_t entries = 4000000, bool strip = false)
+        : maxWords(std::max<uint32_t>(1, words)),
+          maxEntries(std::max<size_t>(1024, entries)), floor(std::max<uint32_t>(1, minimum)),
+          stripAccents(strip) {}
+
+    void addText(std::string_view text) {
+        window.clear();
+        forEachPhraseWord(text, [&](std::string_view w) {
+            if (window.size() == maxWords) window.erase(window.begin());
+            window.emplace_back(w);
+
+            // Every phrase ending at this word, shortest first
+            key.clear();
+            for (size_t n = 1; n <= window.size(); n++) {
+                const std::string& first = window[window.size() - n];
+                if (n == 1) key = first;
+                else key.insert(0, first + " ");
+                counts[key]++;
+            }
+            if (counts.size() > maxEntries) prune();
+        }, [&] { window.clear(); }, stripAccents);
+    }
+
+    size_t size() const { return counts.size(); }
+    size_t memoryBytes() const { return counts.memoryBytes(); }
+    uint32_t wordsPerPhrase() const { return maxWords; }
+    uint32_t minimumCount() const { return floor; }
+    uint64_t pruneCount() const { return prunings; }
+
+    // Phrases counted at least minimumCount() times, sorted
+    std::vector<PhraseCompletion> frequent() {
+        std::vector<PhraseCompletion> phrases;
+        for (auto p : counts)
+            if (p.second >= floor) phrases.push_back({std::string(p.first), p.second});
+        std::sort(phrases.begin(), phrases.end(),
+                  [](const PhraseCompletion& a, const PhraseCompletion& b) { return a.phrase < b.phrase; });
+        return phrases;
+    }
+};
+
+// -------------------- Writer --------------------
+inline bool writePhraseIndex(const std::string& path, const std::vector<PhraseCompletion>& phrases,
+                             uint32_t maxWords, uint32_t minCount, uint64_t* fileBytes = nullptr) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    PhraseIndexHeader header{};
+    std::memcpy(header.magic, PHRASE_INDEX_MAGIC, sizeof(PHRASE_INDEX_MAGIC));
+    header.phraseCount = phrases.size();
+    header.maxWords = maxWords;
+    header.minCount = minCount;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t pos = sizeof(header);
+    std::vector<PhraseBlock> blocks;
+    std::string coded;
+    for (size_t i = 0; i < phrases.size(); i += PHRASES_PER_BLOCK) {
+        PhraseBlock block{pos, 0, 0};
+        coded.clear();
+        size_t end = std::min(phrases.size(), i + PHRASES_PER_BLOCK);
+        for (size_t j = i; j < end; j++) {
+            const std::string& p = phrases[j].phrase;
+            uint32_t shared = 0;
+            if (j > i) {
+                const std::string& prev = phrases[j - 1].phrase;
+                while (shared < prev.size() && shared < p.size() && prev[shared] == p[shared]) shared++;
+            }
+            putVarint(coded, shared);
+            putVarint(coded, p.size() - shared);
+            coded.append(p, shared, std::string::npos);
+            putVarint(coded, phrases[j].count);
+            block.maxCount = std::max(block.maxCount, phrases[j].count);
+        }
+        out.write(coded.data(), coded.size());
+        pos += coded.size();
+        blocks.push_back(block);
+    }
+
+    std::string padding((8 - pos % 8) % 8, '\0');
+    out.write(padding.data(), padding.size());
+    pos += padding.size();
+
+    header.blockCount = blocks.size();
+    header.blocksOffset = pos;
+    out.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(PhraseBlock));
+    pos += blocks.size() * sizeof(PhraseBlock);
+    header.fileSize = pos;
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (fileBytes) *fileBytes = pos;
+    return static_cast<bool>(out);
+}
+
+// -------------------- Reader --------------------
+class PhraseIndex {
+private:
+    MappedFile file;
+    const PhraseIndexHeader* header = nullptr;
+    const PhraseBlock* blocks = nullptr;
+
+    // First phrase of a block, stored in full
+    std::string_view firstPhrase(uint32_t b) const {
+        const char* p = file.data() + blocks[b].offset;
+        getVarint(p);
+        uint32_t length = getVarint(p);
+        return std::string_view(p, length);
+    }
+
+    uint32_t blockSize(uint32_t b) const {
+        return std::min(PHRASES_PER_BLOCK, header->phraseCount - b * PHRASES_PER_BLOCK);
+    }
+
+    static bool startsWith(std::string_view s, std::string_view prefix) {
+        return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path) || file.size() < sizeof(PhraseIndexHeader)) {
+            error = "Cannot map completion index " + path;
+            return false;
+        }
+        header = reinterpret_cast<const PhraseIndexHeader*>(file.data());
+        if (std::memcmp(header->magic, PHRASE_INDEX_MAGIC, sizeof(PHRASE_INDEX_MAGIC)) != 0 ||
+            header->fileSize != file.size()) {
+            error = "Not a completion index (bad magic or size): " + path;
+            return false;
+        }
+        blocks = reinterpret_cast<const PhraseBlock*>(file.data() + header->blocksOffset);
+        return true;
+    }
+
+    uint32_t phraseCount() const { return header->phraseCount; }
+    uint32_t maxWords() const { return header->maxWords; }
+    uint32_t minCount() const { return header->minCount; }
+    size_t mappedBytes() const { return file.size(); }
+
+    // Top k phrases starting with the (normalized) partial query, most
+    // frequent first; ties alphabetical. stripAccents is the index's.
+    std::vector<PhraseCompletion> complete(const std::string& query, size_t k = 5, bool stripAccents = false) const {
+        std::vector<PhraseCompletion> best;
+        std::string prefix = normalizePhrasePrefix(query, stripAccents);
+        if (prefix.empty() || k == 0 || header->blockCount == 0) return best;
+
+        // Blocks [lo, hi) can hold the prefix: lo is the last block whose
+        // first phrase sorts before it, hi the first one past every match
+        uint32_t lo = 0, hi = header->blockCount;
+        {
+            uint32_t a = 0, b = header->blockCount;
+            while (a < b) {
+                uint32_t mid = a + (b - a) / 2;
+                if (firstPhrase(mid) < prefix) a = mid + 1;
+                else b = mid;
+            }
+            lo = a > 0 ? a - 1 : 0;
+            a = lo;
+            b = header->blockCount;
+            while (a < b) {
+                uint32_t mid = a + (b - a) / 2;
+                std::string_view first = firstPhrase(mid);
+                if (first < prefix || startsWith(first, prefix)) a = mid + 1;
+                else b = mid;
+            }
+            hi = a;
+        }
+
+        // Best block first; a heap, since a short prefix spans many blocks
+        // and only the first few are usually decoded
+        std::vector<uint32_t> pending;
+        pending.reserve(hi - lo);
+        for (uint32_t b = lo; b < hi; b++) pending.push_back(b);
+        auto lowerBlock = [&](uint32_t x, uint32_t y) {
+            return blocks[x].maxCount != blocks[y].maxCount ? blocks[x].maxCount < blocks[y].maxCount : x > y;
+        };
+        std::make_heap(pending.begin(), pending.end(), lowerBlock);
+
+        auto better = [](const PhraseCompletion& a, const PhraseCompletion& b) {
+            return a.count != b.count ? a.count > b.count : a.phrase < b.phrase;
+        };
+        std::string phrase;
+        while (!pending.empty()) {
+            std::pop_heap(pending.begin(), pending.end(), lowerBlock);
+            uint32_t b = pending.back();
+            pending.pop_back();
+            if (best.size() == k && blocks[b].maxCount < best.back().count) break;
+            const char* p = file.data() + blocks[b].offset;
+            phrase.clear();
+            for (uint32_t i = 0; i < blockSize(b); i++) {
+                uint32_t shared = getVarint(p);
+                uint32_t suffix = getVarint(p);
+                phrase.resize(shared);
+                phrase.append(p, suffix);
+                p += suffix;
+                uint32_t count = getVarint(p);
+                if (!startsWith(phrase, prefix)) continue;
+
+                PhraseCompletion c{phrase, count};
+                if (best.size() == k && !better(c, best.back())) continue;
+                best.insert(std::upper_bound(best.begin(), best.end(), c, better), c);
+                if (best.size() > k) best.pop_back();
+            }
+        }
+        return best;
+    }
+};
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "shared_index.h"
+#include "doc_filter.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ----------------------------------------------------
+// Roaring-style docID containers for dense terms
+//
+// The docID space is cut into 64K chunks (high 16 bits). Each chunk a
+// term appears in is stored either as a sorted array of the low 16 bits
+// or, once it holds more than `arrayMax` docs, as a 65536-bit bitmap.
+// Above 4096 docs the bitmap (8 KiB) is also the smaller of the two.
+//
+// Block layout (8-byte aligned in the file):
+// [u32 chunkCount][u32 cardinality][ContainerChunk x chunkCount][payloads]
+// ----------------------------------------------------
+static const uint32_t CONTAINER_ARRAY_MAX = 4096;
+static const uint32_t BITMAP_WORDS = 65536 / 64;
+
+struct ContainerChunk {
+    uint16_t key;               // docID >> 16
+    uint16_t isBitmap;
+    uint32_t cardinality;
+    uint64_t offset;            // payload position from the start of the block
+};
+
+// True when at least one chunk of the list is dense enough for a bitmap
+inline bool needsContainers(const Posting* p, uint32_t count, uint32_t arrayMax) {
+    uint32_t i = 0;
+    while (i < count) {
+        uint32_t key = p[i].docID >> 16, start = i;
+        while (i < count && (p[i].docID >> 16) == key) i++;
+        if (i - start > arrayMax) return true;
+    }
+    return false;
+}
+
+inline std::string encodeContainers(const Posting* p, uint32_t count, uint32_t arrayMax) {
+    std::vector<ContainerChunk> chunks;
+    std::string payload;
+
+    uint32_t i = 0;
+    while (i < count) {
+        uint32_t key = p[i].docID >> 16, start = i;
+        while (i < count && (p[i].docID >> 16) == key) i++;
+
+        ContainerChunk c{static_cast<uint16_t>(key), 0, i - start, payload.size()};
+        if (c.cardinality > arrayMax) {
+            c.isBitmap = 1;
+            std::vector<uint64_t> words(BITMAP_WORDS, 0);
+            for (uint32_t j = start; j < i; j++) {
+                uint32_t low = p[j].docID & 0xFFFF;
+                words[low >> 6] |= uint64_t(1) << (low & 63);
+            }
+            payload.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+        } else {
+            for (uint32_t j = start; j < i; j++) {
+                uint16_t low = p[j].docID & 0xFFFF;
+                payload.append(reinterpret_cast<const char*>(&low), sizeof(low));
+            }
+            payload.append((8 - payload.size() % 8) % 8, '\0');
+        }
+        chunks.push_back(c);
+    }
+
+    uint32_t head[2] = {static_cast<uint32_t>(chunks.size()), count};
+    size_t payloadStart = sizeof(head) + chunks.size() * sizeof(ContainerChunk);
+    for (auto& c : chunks) c.offset += payloadStart;
+
+    std::string block(reinterpret_cast<const char*>(head), sizeof(head));
+    block.append(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(ContainerChunk));
+    block += payload;
+    return block;
+}
+
+inline uint32_t countTrailingZeros(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// -------------------- Read-only view of one block --------------------
+class ContainerSet {
+private:
+    const char* base = nullptr;
+    uint32_t chunkCount = 0;
+    uint32_t total = 0;
+    const ContainerChunk* chunkTable = nullptr;
+
+public:
+    ContainerSet() = default;
+    explicit ContainerSet(const char* block) : base(block) {
+        if (!block) return;
+        std::memcpy(&chunkCount, block, sizeof(uint32_t));
+        std::memcpy(&total, block + sizeof(uint32_t), sizeof(uint32_t));
+        chunkTable = reinterpret_cast<const ContainerChunk*>(block + 2 * sizeof(uint32_t));
+    }
+
+    bool valid() const { return base != nullptr; }
+    uint32_t cardinality() const { return total; }
+    uint32_t chunks() const { return chunkCount; }
+    const ContainerChunk& chunk(uint32_t i) const { return chunkTable[i]; }
+
+    const uint64_t* bitmap(const ContainerChunk& c) const {
+        return reinterpret_cast<const uint64_t*>(base + c.offset);
+    }
+    const uint16_t* array(const ContainerChunk& c) const {
+        return reinterpret_cast<const uint16_t*>(base + c.offset);
+    }
+
+    const ContainerChunk* findChunk(uint16_t key) const {
+        const ContainerChunk* end = chunkTable + chunkCount;
+        const ContainerChunk* c = std::lower_bound(chunkTable, end, key,
+            [](const ContainerChunk& a, uint16_t k) { return a.key < k; });
+        return (c != end && c->key == key) ? c : nullptr;
+    }
+
+    bool contains(uint32_t docID) const {
+        const ContainerChunk* c = findChunk(docID >> 16);
+        if (!c) return false;
+        uint16_t low = docID & 0xFFFF;
+        if (c->isBitmap) return (bitmap(*c)[low >> 6] >> (low & 63)) & 1;
+        const uint16_t* a = array(*c);
+        return std::binary_search(a, a + c->cardinality, low);
+    }
+};
+
+// ----------------------------------------------------
+// Intersection kernels
+// ----------------------------------------------------
+struct IntersectStats {
+    uint32_t bitmapAnd = 0;     // chunk pairs ANDed word by word
+    uint32_t galloping = 0;     // sorted list pairs
+    uint32_t mixed = 0;         // sorted list probed against a bitmap/array chunk
+};
+
+// Galloping search of the smaller sorted sequence into the larger.
+// KeyA / KeyB turn an element into its docID.
+template <typename A, typename B, typename KeyA, typename KeyB>
+void gallopIntersect(const A* a, size_t na, const B* b, size_t nb,
+                     KeyA keyA, KeyB keyB, std::vector<uint32_t>& out, uint32_t high = 0)
+{
+    if (na > nb) {
+        gallopIntersect(b, nb, a, na, keyB, keyA, out, high);
+        return;
+    }
+    size_t j = 0;
+    for (size_t i = 0; i < na && j < nb; i++) {
+        uint32_t target = keyA(a[i]);
+        size_t step = 1, lo = j, hi = j;
+        while (hi < nb && keyB(b[hi]) < target) { lo = hi + 1; hi += step; step *= 2; }
+        if (hi > nb) hi = nb;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (keyB(b[mid]) < target) lo = mid + 1; else hi = mid;
+        }
+        j = lo;
+        if (j < nb && keyB(b[j]) == target) out.push_back(high | target);
+    }
+}
+
+// With a filter, its bitset is ANDed into bitmap pairs word by word and
+// probed for everything else, so only allowed docs come out
+inline void intersectContainers(const ContainerSet& a, const ContainerSet& b,
+                                std::vector<uint32_t>& out, IntersectStats& stats,
+                                const DocFilter* filter = nullptr)
+{
+    uint32_t i = 0, j = 0;
+    while (i < a.chunks() && j < b.chunks()) {
+        const ContainerChunk& ca = a.chunk(i);
+        const ContainerChunk& cb = b.chunk(j);
+        if (ca.key < cb.key) { i++; continue; }
+        if (cb.key < ca.key) { j++; continue; }
+
+        uint32_t high = uint32_t(ca.key) << 16;
+        auto low = [](uint16_t v) { return uint32_t(v); };
+
+        if (ca.isBitmap && cb.isBitmap) {
+            stats.bitmapAnd++;
+            const uint64_t* wa = a.bitmap(ca);
+            const uint64_t* wb = b.bitmap(cb);
+            size_t filterBase = size_t(ca.key) * BITMAP_WORDS;
+            for (uint32_t w = 0; w < BITMAP_WORDS; w++) {
+                uint64_t bits = wa[w] & wb[w];
+                if (filter) bits &= filter->word(filterBase + w);
+                while (bits) {
+                    out.push_back(high | (w << 6) | countTrailingZeros(bits));
+                    bits &= bits - 1;
+                }
+            }
+        } else if (ca.isBitmap || cb.isBitmap) {
+            stats.mixed++;
+            const ContainerChunk& arr = ca.isBitmap ? cb : ca;
+            const uint16_t* values = (ca.isBitmap ? b : a).array(arr);
+            const uint64_t* words = ca.isBitmap ? a.bitmap(ca) : b.bitmap(cb);
+            for (uint32_t k = 0; k < arr.cardinality; k++) {
+                uint16_t v = values[k];
+                if (((words[v >> 6] >> (v & 63)) & 1) && (!filter || filter->allows(high | v))) out.push_back(high | v);
+            }
+        } else {
+            stats.galloping++;
+            size_t from = out.size();
+            gallopIntersect(a.array(ca), ca.cardinality, b.array(cb), cb.cardinality, low, low, out, high);
+            if (filter) out.erase(std::remove_if(out.begin() + from, out.end(),
+                                  [&](uint32_t d) { return !filter->allows(d); }), out.end());
+        }
+        i++;
+        j++;
+    }
+}
+
+// ----------------------------------------------------
+// Conjunctive (AND) query over terms of the shared index.
+// Terms are intersected rarest first. Each pair uses the kernel that
+// suits its representation: bitmap AND for dense chunks on both sides,
+// a probe of the sparse side into the dense side's containers, or
+// galloping between two sorted lists.
+// A filter is one more operand of the first pair: bitmap chunks AND its
+// bitset in word by word, the other kernels drop disallowed docs as they
+// emit them. Later terms then only probe the survivors, so a filtered
+// query does no more work than an unfiltered one.
+// ----------------------------------------------------
+struct TermDocs {
+    const Posting* postings = nullptr;
+    uint32_t count = 0;
+    ContainerSet containers;    // valid() only for dense terms
+};
+
+inline TermDocs termDocs(const SharedIndex& index, const TermEntry& t) {
+    TermDocs d;
+    d.postings   = index.postings(t);
+    d.count      = t.postingCount;
+    d.containers = ContainerSet(index.containerBlock(t));
+    return d;
+}
+
+inline std::vector<uint32_t> intersectTerms(std::vector<TermDocs> terms, IntersectStats& stats,
+                                            const DocFilter* filter = nullptr) {
+    std::vector<uint32_t> result;
+    if (terms.empty()) return result;
+
+    std::sort(terms.begin(), terms.end(),
+              [](const TermDocs& a, const TermDocs& b) { return a.count < b.count; });
+
+    auto docOf = [](const Posting& p) { return p.docID; };
+    auto self  = [](uint32_t d) { return d; };
+
+    size_t nextTerm;
+    if (terms.size() == 1) {
+        // A single list has nothing to intersect with: one filtered pass
+        for (uint32_t i = 0; i < terms[0].count; i++) {
+            uint32_t d = terms[0].postings[i].docID;
+            if (!filter || filter->allows(d)) result.push_back(d);
+        }
+        nextTerm = 1;
+    } else {
+        // First pair straight from the stored representations
+        const TermDocs& a = terms[0];
+        const TermDocs& b = terms[1];
+        if (a.containers.valid() && b.containers.valid()) {
+            intersectContainers(a.containers, b.containers, result, stats, filter);
+        } else if (b.containers.valid()) {
+            stats.mixed++;
+            for (uint32_t i = 0; i < a.count; i++) {
+                uint32_t d = a.postings[i].docID;
+                if ((!filter || filter->allows(d)) && b.containers.contains(d)) result.push_back(d);
+            }
+        } else {
+            stats.galloping++;
+            gallopIntersect(a.postings, a.count, b.postings, b.count, docOf, docOf, result);
+            if (filter) result.erase(std::remove_if(result.begin(), result.end(),
+                                     [&](uint32_t d) { return !filter->allows(d); }), result.end());
+        }
+        nextTerm = 2;
+    }
+
+    // Remaining terms filter the (already small) running result
+    std::vector<uint32_t> next;
+    for (size_t t = nextTerm; t < terms.size() && !result.empty(); t++) {
+        next.clear();
+        if (terms[t].containers.valid()) {
+            stats.mixed++;
+            for (uint32_t d : result)
+                if (terms[t].containers.contains(d)) next.push_back(d);
+        } else {
+            stats.galloping++;
+            gallopIntersect(result.data(), result.size(), terms[t].postings, terms[t].count, self, docOf, next);
+        }
+        result.swap(next);
+    }
+    return result;
+}
+
+// Frequency of docID in a docID-sorted list (0 if absent)
+inline uint32_t postingFreq(const Posting* p, uint32_t count, uint32_t docID) {
+    const Posting* it = std::lower_bound(p, p + count, docID,
+        [](const Posting& a, uint32_t d) { return a.docID < d; });
+    return (it != p + count && it->docID == docID) ? it->freq : 0;
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bounded_queue.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup)
+#define POSTING_IO_URING 1
+#endif
+#endif
+
+// ----------------------------------------------------
+// Batched posting-list reads
+//
+// All reads a query needs are handed over at once with submit(); next()
+// then returns them in completion order, so the caller can decode the
+// first barrel while the others are still in flight. On Linux the batch
+// goes through io_uring (raw syscalls, no liburing); anywhere io_uring
+// is unavailable a small thread pool does positional reads instead.
+// ----------------------------------------------------
+struct ReadRequest {
+    std::string path;
+    uint64_t offset = 0;
+    uint64_t length = 0;        // 0 = up to the end of the file
+    std::string data;
+    bool ok = false;
+};
+
+// Blocking read of one request; the fallback path and io_uring's
+// recovery path for short or refused reads
+inline bool readRange(ReadRequest& r, uint64_t done = 0) {
+#ifndef _WIN32
+    int fd = ::open(r.path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    if (r.length == 0) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        r.length = st.st_size > (off_t)r.offset ? st.st_size - r.offset : 0;
+    }
+    r.data.resize(r.length);
+    while (done < r.length) {
+        ssize_t n = pread(fd, &r.data[done], r.length - done, r.offset + done);
+        if (n <= 0) break;
+        done += n;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(r.path, std::ios::binary);
+    if (!in) return false;
+    if (r.length == 0) {
+        in.seekg(0, std::ios::end);
+        uint64_t size = static_cast<uint64_t>(in.tellg());
+        r.length = size > r.offset ? size - r.offset : 0;
+    }
+    r.data.resize(r.length);
+    in.seekg(r.offset + done);
+    in.read(&r.data[done], r.length - done);
+    done += in.gcount();
+#endif
+    r.data.resize(done);
+    return done == r.length;
+}
+
+class PostingReader {
+private:
+    std::vector<ReadRequest>* batch = nullptr;
+    size_t remaining = 0;
+
+    // -------------------- Thread pool fallback --------------------
+    BoundedQueue<int> jobs{1024};
+    BoundedQueue<int> finished{1024};
+    std::vector<std::thread> workers;
+
+    void startPool(unsigned threads) {
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back([this] {
+                int index;
+                while (jobs.pop(index)) {
+                    ReadRequest& r = (*batch)[index];
+                    r.ok = readRange(r);
+                    finished.push(index);
+                }
+            });
+        }
+    }
+
+#if defined(POSTING_IO_URING)
+    // -------------------- io_uring --------------------
+    int ring = -1;
+    io_uring_params params{};
+    char* sqRing = nullptr;
+    char* cqRing = nullptr;
+    size_t sqRingBytes = 0, cqRingBytes = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::vector<int> fds;           // one per request, closed on completion
+    size_t nextToQueue = 0;
+    unsigned inFlight = 0;
+
+    std::atomic<unsigned>* sqTail() { return reinterpret_cast<std::atomic<unsigned>*>(sqRing + params.sq_off.tail); }
+    std::atomic<unsigned>* cqHead() { return reinterpret_cast<std::atomic<unsigned>*>(cqRing + params.cq_off.head); }
+    std::atomic<unsigned>* cqTail() { return reinterpret_cast<std::atomic<unsigned>*>(cqRing + params.cq_off.tail); }
+
+    bool setupRing(unsigned entries) {
+        ring = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring < 0) return false;
+
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+
+        void* sq = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+        void* cq = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq :
+            mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+        void* se = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+        if (sq == MAP_FAILED || cq == MAP_FAILED || se == MAP_FAILED) {
+            ::close(ring);
+            ring = -1;
+            return false;
+        }
+        sqRing = static_cast<char*>(sq);
+        cqRing = static_cast<char*>(cq);
+        sqes   = static_cast<io_uring_sqe*>(se);
+        return true;
+    }
+
+    // Queues as many pending requests as the ring has room for
+    void queueReads() {
+        unsigned mask = *reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+        unsigned* array = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+        unsigned tail = sqTail()->load(std::memory_order_relaxed);
+        unsigned queued = 0;
+
+        while (nextToQueue < batch->size() && inFlight < params.sq_entries) {
+            int index = static_cast<int>(nextToQueue++);
+            ReadRequest& r = (*batch)[index];
+
+            fds[index] = ::open(r.path.c_str(), O_RDONLY);
+            struct stat st;
+            if (fds[index] < 0 || fstat(fds[index], &st) != 0) {
+                readBlocking(index);
+                readyNow.push_back(index);
+                continue;
+            }
+            if (r.length == 0) r.length = st.st_size > (off_t)r.offset ? st.st_size - r.offset : 0;
+            r.data.resize(r.length);
+
+            io_uring_sqe& sqe = sqes[tail & mask];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode    = IORING_OP_READ;
+            sqe.fd        = fds[index];
+            sqe.off       = r.offset;
+            sqe.addr      = reinterpret_cast<uint64_t>(r.data.data());
+            sqe.len       = static_cast<uint32_t>(r.length);
+            sqe.user_data = index;
+            array[tail & mask] = tail & mask;
+            tail++;
+            queued++;
+            inFlight++;
+        }
+        if (queued == 0) return;
+
+        sqTail()->store(tail, std::memory_order_release);
+        syscall(__NR_io_uring_enter, ring, queued, 0, 0, nullptr, 0);
+    }
+
+    // Failed opens and refused reads are finished synchronously
+    std::vector<int> readyNow;
+    void readBlocking(int index) {
+        ReadRequest& r = (*batch)[index];
+        if (fds[index] >= 0) { ::close(fds[index]); fds[index] = -1; }
+        r.data.clear();
+        r.ok = readRange(r);
+    }
+
+    int nextFromRing() {
+        if (!readyNow.empty()) {
+            int index = readyNow.back();
+            readyNow.pop_back();
+            return index;
+        }
+
+        unsigned head = cqHead()->load(std::memory_order_relaxed);
+        while (head == cqTail()->load(std::memory_order_acquire))
+            syscall(__NR_io_uring_enter, ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+        unsigned mask = *reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+        io_uring_cqe cqe = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes)[head & mask];
+        cqHead()->store(head + 1, std::memory_order_release);
+        inFlight--;
+
+        int index = static_cast<int>(cqe.user_data);
+        ReadRequest& r = (*batch)[index];
+        if (cqe.res < 0) {
+            // e.g. a kernel without IORING_OP_READ
+            readBlocking(index);
+        } else {
+            ::close(fds[index]);
+            fds[index] = -1;
+            r.ok = (uint64_t)cqe.res == r.length || readRange(r, cqe.res);
+        }
+        queueReads();
+        return index;
+    }
+#endif
+
+public:
+    // ringEntries = 0 skips io_uring and always uses the thread pool
+    explicit PostingReader(unsigned threads = 4, unsigned ringEntries = 64) {
+#if defined(POSTING_IO_URING)
+        if (ringEntries > 0 && setupRing(ringEntries)) return;
+#endif
+        (void)ringEntries;
+        startPool(threads);
+    }
+
+    ~PostingReader() {
+        jobs.close();
+        for (auto& w : workers) w.join();
+#if defined(POSTING_IO_URING)
+        if (ring >= 0) {
+            munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+            if (cqRing != sqRing) munmap(cqRing, cqRingBytes);
+            munmap(sqRing, sqRingBytes);
+            ::close(ring);
+        }
+#endif
+    }
+
+    const char* backend() const {
+#if defined(POSTING_IO_URING)
+        if (ring >= 0) return "io_uring";
+#endif
+        return "thread pool";
+    }
+
+    // Starts every read of the batch; the vector must outlive the reads
+    void submit(std::vector<ReadRequest>& requests) {
+        batch = &requests;
+        remaining = requests.size();
+#if defined(POSTING_IO_URING)
+        if (ring >= 0) {
+            fds.assign(requests.size(), -1);
+            nextToQueue = 0;
+            queueReads();
+            return;
+        }
+#endif
+        for (size_t i = 0; i < requests.size(); i++) jobs.push(static_cast<int>(i));
+    }
+
+    // Index of the next finished request, -1 once the batch is done
+    int next() {
+        if (remaining == 0) return -1;
+        remaining--;
+#if defined(POSTING_IO_URING)
+        if (ring >= 0) return nextFromRing();
+#endif
+        int index = -1;
+        finished.pop(index);
+        return index;
+    }
+};
@@ -0,0 +1,443 @@
+#include <iostream>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include "nlohmann/json.hpp"
+#include "index_files.h"
+#include "stream_writer.h"
+#include "mapped_file.h"
+#include "inverted_index_sax.h"
+#include "ranking.h"
+#include "query_cache.h"
+#include "memory_usage.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+// ----------------------------------------------------
+// Static index pruning
+//
+// Writes a smaller barrel set for query nodes that cannot keep every
+// barrel hot. Each posting is scored by its BM25 contribution with the
+// statistics of the full index (document lengths, df); low scorers are
+// dropped by one of:
+//   --min-score <s>       a global threshold
+//   --term-epsilon <e>    per term: below e x the term's k-th best score
+//                         (--term-k, default 10), so every term keeps
+//                         what can reach its top k
+//   --keep <fraction>     the global threshold that keeps that fraction
+// Every term keeps at least --min-postings (default 1) of its best
+// postings, so the lexicon and barrel mapping stay valid as they are:
+// the output directory gets the pruned barrels, the mapping, a lexicon
+// whose df and cf count the postings left, and index_stats.json with
+// the full index's document lengths, document count and df.
+// build_shared_index scores with those, so a posting that survives keeps
+// exactly the score it had; only dropped postings change results.
+//
+// The report compares top-k BM25 results of the full and the pruned
+// index on a query sample, both scored with the full statistics as the
+// index build_shared_index packs from the output would score them.
+// ----------------------------------------------------
+
+// -------------------- Barrel reading --------------------
+// Every term of barrel b with its postings in docID order; a missing
+// or empty barrel has no terms
+template <typename OnTerm>
+bool forEachBarrelTerm(const std::string& barrelsDir, int b, OnTerm onTerm, std::string& error) {
+    std::string path = barrelsDir + "/barrel_" + std::to_string(b) + ".json";
+    std::error_code ec;
+    if (!fs::exists(path, ec) || fs::file_size(path, ec) == 0) return true;
+    MappedFile in;
+    if (!in.open(path)) {
+        error = "Cannot open barrel " + path;
+        return false;
+    }
+    auto handle = [&](TermRecord& term) {
+        std::sort(term.postings.begin(), term.postings.end());
+        onTerm(term);
+        return true;
+    };
+    InvertedIndexSax<decltype(handle)> sax(handle);
+    if (!json::sax_parse(in.data(), in.data() + in.size(), &sax)) {
+        error = "Failed to parse barrel " + std::to_string(b) + ": " + sax.error;
+        return false;
+    }
+    return true;
+}
+
+inline uint64_t barrelBytes(const std::string& barrelsDir, int b) {
+    std::error_code ec;
+    uint64_t size = fs::file_size(barrelsDir + "/barrel_" + std::to_string(b) + ".json", ec);
+    return ec ? 0 : size;
+}
+
+// -------------------- Index statistics --------------------
+// What BM25 needs, as build_shared_index computes it: length = sum of
+// term frequencies, and documents without postings do not count
+struct IndexStats {
+    std::vector<uint32_t> docLengths{0};
+    std::vector<uint32_t> df;       // df[lexID]
+    std::vector<uint64_t> cf;       // cf[lexID], sum of term frequencies
+    uint64_t postings = 0;
+
+    explicit IndexStats(size_t lexiconSize) : df(lexiconSize + 1, 0), cf(lexiconSize + 1, 0) {}
+
+    void add(int lexID, uint32_t docID, uint32_t freq) {
+        if (docID >= docLengths.size()) docLengths.resize(docID + 1, 0);
+        docLengths[docID] += freq;
+        df[lexID]++;
+        cf[lexID] += freq;
+        postings++;
+    }
+
+    Bm25 bm25() const {
+        Bm25 bm25;
+        uint64_t docs = 0, tokens = 0;
+        for (uint32_t length : docLengths) {
+            if (!length) continue;
+            docs++;
+            tokens += length;
+        }
+        bm25.docCount = docs;
+        bm25.avgDocLength = docs ? double(tokens) / docs : 1.0;
+        return bm25;
+    }
+};
+
+// -------------------- Pruning rule --------------------
+struct PruneRule {
+    enum Mode { None, MinScore, TermEpsilon, Keep } mode = None;
+    double minScore = 0.0;
+    double epsilon = 0.0;
+    size_t termK = 10;
+    double keepFraction = 1.0;
+    size_t minPostings = 1;
+};
+
+// The lowest score a term keeps: the rule's threshold, lowered so the
+// best minPostings postings always stay
+inline double termThreshold(const PruneRule& rule, double globalThreshold, const std::vector<double>& scores) {
+    auto nthBest = [&](size_t n) {
+        if (n == 1) return *std::max_element(scores.begin(), scores.end());
+        std::vector<double> ranked(scores);
+        std::nth_element(ranked.begin(), ranked.begin() + (n - 1), ranked.end(), std::greater<double>());
+        return ranked[n - 1];
+    };
+    double threshold = globalThreshold;
+    if (rule.mode == PruneRule::TermEpsilon)
+        threshold = scores.size() <= rule.termK ? 0.0 : rule.epsilon * nthBest(rule.termK);
+    if (rule.minPostings > 0 && !scores.empty())
+        threshold = std::min(threshold, nthBest(std::min(rule.minPostings, scores.size())));
+    return threshold;
+}
+
+// -------------------- Query sample --------------------
+// lexIDs of each query, known words only
+using SampleQuery = std::vector<int>;
+
+std::vector<SampleQuery> loadQueries(const std::string& file, const std::unordered_map<std::string, int>& lexIDs,
+                                     bool stripAccents, std::string& error) {
+    std::vector<SampleQuery> queries;
+    std::ifstream in(file);
+    if (!in) {
+        error = "Cannot open query file " + file;
+        return queries;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        SampleQuery q;
+        for (const std::string& w : queryTerms(line, stripAccents)) {
+            auto it = lexIDs.find(w);
+            if (it != lexIDs.end()) q.push_back(it->second);
+        }
+        if (!q.empty()) queries.push_back(q);
+    }
+    if (queries.empty()) error = "No query in " + file + " has a word of the lexicon";
+    return queries;
+}
+
+// One to three words with log-uniform frequency ranks: lexIDs follow
+// collection frequency, so common and rare words both come up. Fixed
+// seed, so runs with different rules are compared on the same queries.
+std::vector<SampleQuery> sampleQueries(size_t count, const std::vector<uint32_t>& df) {
+    std::vector<SampleQuery> queries;
+    size_t terms = df.size() - 1;
+    if (terms == 0) return queries;
+    std::mt19937_64 rng(20200313);
+    std::uniform_real_distribution<double> logRank(0.0, std::log(double(terms)));
+    for (size_t attempts = 0; queries.size() < count && attempts < count * 100; attempts++) {
+        SampleQuery q;
+        size_t words = 1 + rng() % 3;
+        for (size_t i = 0; i < words; i++) {
+            int lexID = std::min<size_t>(terms, size_t(std::exp(logRank(rng))));
+            if (df[lexID] > 0 && std::find(q.begin(), q.end(), lexID) == q.end()) q.push_back(lexID);
+        }
+        if (!q.empty()) queries.push_back(q);
+    }
+    return queries;
+}
+
+// Top-k documents of a ranked OR query, as search --ranked scores it
+std::vector<uint32_t> topDocs(const SampleQuery& query, size_t k, const IndexStats& stats, const Bm25& bm25,
+                              const std::unordered_map<int, std::vector<Posting>>& lists) {
+    std::vector<QueryTerm> terms;
+    for (int lexID : query) {
+        const std::vector<Posting>& list = lists.at(lexID);
+        if (list.empty()) continue;
+        QueryTerm t;
+        t.postings = list.data();
+        t.count = list.size();
+        t.idf = bm25.idf(stats.df[lexID]);
+        t.upperBound = bm25.maxScore(t.idf);
+        terms.push_back(t);
+    }
+    std::vector<uint32_t> docs;
+    auto length = [&](uint32_t docID) { return docID < stats.docLengths.size() ? stats.docLengths[docID] : 0; };
+    for (const ScoredDoc& d : maxScoreTopK(terms, k, bm25, length)) docs.push_back(d.docID);
+    return docs;
+}
+
+// -------------------- Main --------------------
+int main(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cout << "Usage: prune_index <lexicon.json> <barrel_mapping.json> <barrels_directory> <output_directory>\n"
+                  << "       (--min-score <s> | --term-epsilon <e> [--term-k <k>] | --keep <fraction>)\n"
+                  << "       [--min-postings <n>] [--queries <file> | --sample <n>] [--top <k>] [--compact]\n";
+        return 1;
+    }
+
+    std::string lexFile    = argv[1];
+    std::string mapFile    = argv[2];
+    std::string barrelsDir = argv[3];
+    std::string outDir     = argv[4];
+    OutputFormat format    = parseOutputFormat(argc, argv, 5);
+    PruneRule rule;
+    std::string queryFile;
+    size_t sampleSize = 200;
+    size_t topK = 10;
+    for (int i = 5; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--min-score" && i + 1 < argc) { rule.mode = PruneRule::MinScore; rule.minScore = std::stod(argv[++i]); }
+        else if (arg == "--term-epsilon" && i + 1 < argc) { rule.mode = PruneRule::TermEpsilon; rule.epsilon = std::stod(argv[++i]); }
+        else if (arg == "--term-k" && i + 1 < argc) rule.termK = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--keep" && i + 1 < argc) { rule.mode = PruneRule::Keep; rule.keepFraction = std::stod(argv[++i]); }
+        else if (arg == "--min-postings" && i + 1 < argc) rule.minPostings = std::stoul(argv[++i]);
+        else if (arg == "--queries" && i + 1 < argc) queryFile = argv[++i];
+        else if (arg == "--sample" && i + 1 < argc) sampleSize = std::stoul(argv[++i]);
+        else if (arg == "--top" && i + 1 < argc) topK = std::max(1, std::stoi(argv[++i]));
+    }
+    if (rule.mode == PruneRule::None) {
+        std::cerr << "ERROR: Give a pruning rule: --min-score, --term-epsilon or --keep\n";
+        return 1;
+    }
+    if (rule.mode == PruneRule::Keep && (rule.keepFraction <= 0.0 || rule.keepFraction > 1.0)) {
+        std::cerr << "ERROR: --keep takes a fraction in (0, 1]\n";
+        return 1;
+    }
+    // Barrels are read back with json::parse
+    if (format == OutputFormat::MsgPack) {
+        std::cerr << "ERROR: Barrels are JSON; use --compact for the smaller encoding\n";
+        return 1;
+    }
+    std::error_code ec;
+    if (fs::equivalent(barrelsDir, outDir, ec)) {
+        std::cerr << "ERROR: The output directory must not be the barrels directory\n";
+        return 1;
+    }
+
+    std::vector<std::string> words;
+    std::unordered_map<int,int> barrelMap;
+    std::string error;
+    bool stripAccents = false;
+    if (!loadLexiconWords(lexFile, words, error, nullptr, &stripAccents) ||
+        !loadBarrelMapping(mapFile, barrelMap, error)) {
+        std::cerr << "ERROR: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Loaded lexicon size: " << words.size() << "\n";
+    auto t0 = std::chrono::steady_clock::now();
+
+    // -------------------- Full index statistics --------------------
+    IndexStats full(words.size());
+    uint64_t bytesBefore = 0;
+    for (int b = 0; b < BARREL_COUNT; b++) {
+        bool ok = forEachBarrelTerm(barrelsDir, b, [&](TermRecord& term) {
+            if (term.lexID < 1 || term.lexID > (int)words.size()) return;
+            for (auto& [docID, freq] : term.postings) full.add(term.lexID, docID, freq);
+        }, error);
+        if (!ok) {
+            std::cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+        bytesBefore += barrelBytes(barrelsDir, b);
+    }
+    Bm25 bm25 = full.bm25();
+    std::cout << "Full index: " << full.postings << " postings, " << bm25.docCount << " documents\n";
+
+    auto scoreTerm = [&](const TermRecord& term, std::vector<double>& scores) {
+        double idf = bm25.idf(full.df[term.lexID]);
+        scores.clear();
+        for (auto& [docID, freq] : term.postings) scores.push_back(bm25.score(freq, full.docLengths[docID], idf));
+    };
+
+    // -------------------- Global threshold --------------------
+    double globalThreshold = rule.minScore;
+    std::vector<double> scores;
+    if (rule.mode == PruneRule::Keep) {
+        // Every score once, as floats: 4 bytes a posting for one pass
+        std::vector<float> all;
+        all.reserve(full.postings);
+        for (int b = 0; b < BARREL_COUNT; b++) {
+            bool ok = forEachBarrelTerm(barrelsDir, b, [&](TermRecord& term) {
+                if (term.lexID < 1 || term.lexID > (int)words.size()) return;
+                scoreTerm(term, scores);
+                all.insert(all.end(), scores.begin(), scores.end());
+            }, error);
+            if (!ok) {
+                std::cerr << "ERROR: " << error << "\n";
+                return 1;
+            }
+        }
+        size_t keep = std::min(all.size(), size_t(std::ceil(rule.keepFraction * all.size())));
+        if (keep == 0 || keep == all.size()) globalThreshold = 0.0;
+        else {
+            std::nth_element(all.begin(), all.begin() + (all.size() - keep), all.end());
+            globalThreshold = all[all.size() - keep];
+        }
+        std::cout << "Keeping " << rule.keepFraction * 100 << "% of postings: score threshold "
+                  << globalThreshold << "\n";
+    }
+
+    // -------------------- Sample queries --------------------
+    std::vector<SampleQuery> queries;
+    if (!queryFile.empty()) {
+        queries = loadQueries(queryFile, lexiconMap(words), stripAccents, error);
+        if (queries.empty()) {
+            std::cerr << "ERROR: " << error << "\n";
+            return 1;
+        }
+    } else {
+        queries = sampleQueries(sampleSize, full.df);
+    }
+    std::unordered_set<int> queryLexIDs;
+    for (const SampleQuery& q : queries) queryLexIDs.insert(q.begin(), q.end());
+    std::unordered_map<int, std::vector<Posting>> fullLists, prunedLists;
+    for (int lexID : queryLexIDs) {
+        fullLists[lexID];
+        prunedLists[lexID];
+    }
+
+    // -------------------- Write pruned barrels --------------------
+    fs::create_directories(outDir, ec);
+    if (ec) {
+        std::cerr << "ERROR: Cannot create " << outDir << ": " << ec.message() << "\n";
+        return 1;
+    }
+    IndexStats pruned(words.size());
+    uint64_t bytesAfter = 0;
+    for (int b = 0; b < BARREL_COUNT; b++) {
+        std::string filename = outDir + "/barrel_" + std::to_string(b) + ".json";
+        BufferedWriter out(256 * 1024);
+        if (!out.open(filename)) {
+            std::cerr << "ERROR: Cannot write " << filename << "\n";
+            return 1;
+        }
+        RecordWriter writer(out, format);
+        writer.beginObject();
+        bool ok = forEachBarrelTerm(barrelsDir, b, [&](TermRecord& term) {
+            if (term.lexID < 1 || term.lexID > (int)words.size()) return;
+            scoreTerm(term, scores);
+            double threshold = termThreshold(rule, globalThreshold, scores);
+            auto query = fullLists.find(term.lexID);
+
+            writer.key(term.lexID);
+            writer.beginObject();
+            for (size_t i = 0; i < term.postings.size(); i++) {
+                auto [docID, freq] = term.postings[i];
+                if (query != fullLists.end()) query->second.push_back({docID, freq});
+                if (scores[i] < threshold) continue;
+                writer.key(docID);
+                writer.value(freq);
+                pruned.add(term.lexID, docID, freq);
+                if (query != fullLists.end()) prunedLists[term.lexID].push_back({docID, freq});
+            }
+            writer.endObject();
+        }, error);
+        writer.endObject();
+        bytesAfter += out.bytesWritten();
+        if (!out.close() || !ok) {
+            std::cerr << "ERROR: " << (ok ? "Cannot write " + filename : error) << "\n";
+            return 1;
+        }
+    }
+
+    // The mapping is unchanged; the lexicon's df and cf follow the postings
+    // left, and the full index's statistics go along for BM25
+    json lexJson;
+    {
+        std::ifstream in(lexFile);
+        in >> lexJson;
+    }
+    json df = json::array(), cf = json::array(), fullDf = json::array();
+    for (size_t lexID = 1; lexID < pruned.df.size(); lexID++) {
+        df.push_back(pruned.df[lexID]);
+        cf.push_back(pruned.cf[lexID]);
+        fullDf.push_back(full.df[lexID]);
+    }
+    lexJson["df"] = df;
+    lexJson["cf"] = cf;
+    std::ofstream lexOut(outDir + "/lexicon.json");
+    lexOut << lexJson.dump(4);
+    json statsJson;
+    statsJson["doc_count"] = uint64_t(bm25.docCount);
+    statsJson["doc_lengths"] = full.docLengths;
+    statsJson["df"] = fullDf;
+    std::ofstream statsOut(outDir + "/index_stats.json");
+    statsOut << statsJson.dump();
+    fs::copy_file(mapFile, outDir + "/barrel_mapping.json", fs::copy_options::overwrite_existing, ec);
+    if (!lexOut || !statsOut || ec) {
+        std::cerr << "ERROR: Cannot write the lexicon, statistics or mapping to " << outDir << "\n";
+        return 1;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // -------------------- Report --------------------
+    auto percent = [](double part, double whole) { return whole > 0 ? 100.0 * part / whole : 0.0; };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Postings: " << pruned.postings << " of " << full.postings << " kept ("
+              << percent(pruned.postings, full.postings) << "%)\n";
+    std::cout << "Barrels: " << formatBytes(bytesBefore) << " -> " << formatBytes(bytesAfter) << " ("
+              << percent(bytesBefore - std::min(bytesBefore, bytesAfter), bytesBefore) << "% smaller)\n";
+
+    size_t evaluated = 0, identical = 0;
+    double overlapSum = 0.0, worst = 1.0;
+    for (const SampleQuery& q : queries) {
+        std::vector<uint32_t> a = topDocs(q, topK, full, bm25, fullLists);
+        if (a.empty()) continue;
+        std::vector<uint32_t> b = topDocs(q, topK, full, bm25, prunedLists);
+        size_t common = 0;
+        for (uint32_t d : a) common += std::find(b.begin(), b.end(), d) != b.end();
+        double overlap = double(common) / a.size();
+        overlapSum += overlap;
+        worst = std::min(worst, overlap);
+        identical += common == a.size() && b.size() == a.size();
+        evaluated++;
+    }
+    if (evaluated) {
+        std::cout << std::setprecision(3) << "Top-" << topK << " overlap on " << evaluated << " queries: mean "
+                  << overlapSum / evaluated << ", worst " << worst << ", " << identical
+                  << " with the same top " << topK << "\n";
+    } else {
+        std::cout << "Top-" << topK << " overlap: no sample query has results\n";
+    }
+    std::cout << "✓ Pruned barrels in " << outDir << " (" << std::setprecision(2) << elapsed << " s)\n";
+    return 0;
+}
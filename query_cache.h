@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "unicode_text.h"
+
+// ----------------------------------------------------
+// Query normalization
+// Words are split and folded like the index builders do (forEachWord),
+// with the accent stripping of the index being queried.
+// AND and ranked OR queries are commutative, so terms are sorted and
+// deduplicated and "b a" shares an entry with "a b". The mode and top-k are part of the key.
+// ----------------------------------------------------
+inline std::vector<std::string> queryTerms(const std::string& query, bool stripAccents = false) {
+    std::vector<std::string> terms;
+    forEachWord(query, [&](std::string_view word) { terms.emplace_back(word); }, stripAccents);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
+
+inline std::string queryKey(const std::string& mode, const std::vector<std::string>& terms, int topK) {
+    std::string key = mode + "|" + std::to_string(topK);
+    for (const std::string& t : terms) key += "|" + t;
+    return key;
+}
+
+// ----------------------------------------------------
+// TinyLFU frequency sketch: a count-min sketch of 4-bit counters.
+// Counters are halved every `sampleSize` increments so popularity
+// decays and yesterday's hot queries can be displaced.
+// ----------------------------------------------------
+class FrequencySketch {
+private:
+    std::vector<uint64_t> table;    // 16 counters of 4 bits per word
+    uint64_t mask = 0;
+    uint64_t additions = 0;
+    uint64_t sampleSize = 0;
+
+    static uint64_t mix(uint64_t h, uint64_t seed) {
+        h ^= seed;
+        h *= 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    uint32_t counterAt(uint64_t index) const {
+        return (table[index >> 4] >> ((index & 15) * 4)) & 0xF;
+    }
+
+public:
+    explicit FrequencySketch(size_t expectedEntries = 1024) {
+        size_t words = 1;
+        while (words * 16 < expectedEntries * 4) words *= 2;
+        table.assign(words, 0);
+        mask = words * 16 - 1;
+        sampleSize = expectedEntries * 10;
+    }
+
+    void increment(uint64_t hash) {
+        for (uint64_t seed = 1; seed <= 4; seed++) {
+            uint64_t index = mix(hash, seed) & mask;
+            uint32_t shift = (index & 15) * 4;
+            if (((table[index >> 4] >> shift) & 0xF) < 15)
+                table[index >> 4] += uint64_t(1) << shift;
+        }
+        if (++additions >= sampleSize) {
+            // Halve every counter: shift each nibble right, clearing the
+            // bit that crossed over from its neighbour
+            for (auto& w : table) w = (w >> 1) & 0x7777777777777777ull;
+            additions /= 2;
+        }
+    }
+
+    uint32_t estimate(uint64_t hash) const {
+        uint32_t best = 15;
+        for (uint64_t seed = 1; seed <= 4; seed++)
+            best = std::min(best, counterAt(mix(hash, seed) & mask));
+        return best;
+    }
+};
+
+// ----------------------------------------------------
+// Result cache with a byte budget
+// LRU order for eviction; a new entry that would push something out is
+// only admitted when the sketch has seen it more often than the LRU
+// victim, so one-off queries cannot flush the popular ones. Every entry
+// belongs to one index generation; loading a new generation empties
+// the cache.
+// ----------------------------------------------------
+struct QueryCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t admitted = 0;
+    uint64_t rejected = 0;
+    uint64_t evicted = 0;
+    uint64_t invalidations = 0;
+};
+
+template <typename Value>
+class QueryCache {
+private:
+    struct Entry {
+        std::string key;
+        Value value;
+        size_t bytes;
+    };
+
+    size_t budget;
+    size_t used = 0;
+    uint64_t generation = 0;
+    std::list<Entry> lru;           // most recently used first
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> entries;
+    FrequencySketch sketch;
+    QueryCacheStats counters;
+
+    void evictLast() {
+        used -= lru.back().bytes;
+        entries.erase(lru.back().key);
+        lru.pop_back();
+        counters.evicted++;
+    }
+
+public:
+    explicit QueryCache(size_t budgetBytes)
+        : budget(budgetBytes), sketch(std::max<size_t>(budgetBytes / 1024, 64)) {}
+
+    // Drops every entry when the index generation changed
+    void setGeneration(uint64_t g) {
+        if (g == generation) return;
+        if (!lru.empty()) counters.invalidations++;
+        lru.clear();
+        entries.clear();
+        used = 0;
+        generation = g;
+    }
+
+    const Value* get(const std::string& key) {
+        sketch.increment(std::hash<std::string>()(key));
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            counters.misses++;
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        counters.hits++;
+        return &it->second->value;
+    }
+
+    // bytes: the caller's estimate of the value's footprint
+    void put(const std::string& key, Value value, size_t bytes) {
+        bytes += key.size() + sizeof(Entry) + 64; // list node and map bucket overhead
+        if (bytes > budget || entries.count(key)) return;
+
+        // TinyLFU admission against the entries that would be evicted
+        if (used + bytes > budget) {
+            uint32_t candidate = sketch.estimate(std::hash<std::string>()(key));
+            size_t freed = 0;
+            for (auto it = lru.rbegin(); it != lru.rend() && used - freed + bytes > budget; ++it) {
+                if (sketch.estimate(std::hash<std::string>()(it->key)) >= candidate) {
+                    counters.rejected++;
+                    return;
+                }
+                freed += it->bytes;
+            }
+            while (used + bytes > budget) evictLast();
+        }
+
+        lru.push_front({key, std::move(value), bytes});
+        entries[key] = lru.begin();
+        used += bytes;
+        counters.admitted++;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t size() const { return entries.size(); }
+    const QueryCacheStats& stats() const { return counters; }
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "shared_index.h"
+#include "doc_filter.h"
+
+// ----------------------------------------------------
+// BM25 scoring
+// idf uses the log(1 + ...) form so it never goes negative, which keeps
+// every per-term upper bound below valid for pruning.
+// ----------------------------------------------------
+struct Bm25 {
+    double k1 = 1.2;
+    double b = 0.75;
+    double docCount = 1;
+    double avgDocLength = 1;
+
+    double idf(uint32_t df) const {
+        return std::log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+    }
+
+    double score(uint32_t tf, uint32_t docLength, double termIdf) const {
+        double norm = k1 * (1.0 - b + b * docLength / avgDocLength);
+        return termIdf * tf * (k1 + 1.0) / (tf + norm);
+    }
+
+    // No posting of a term can score above this, whatever tf and length are
+    double maxScore(double termIdf) const {
+        return termIdf * (k1 + 1.0);
+    }
+};
+
+struct ScoredDoc {
+    uint32_t docID;
+    double score;
+};
+
+// One query term over a docID-sorted posting list
+struct QueryTerm {
+    const Posting* postings = nullptr;
+    uint32_t count = 0;
+    double weight = 1.0;        // query-side weight
+    double idf = 0.0;
+    double upperBound = 0.0;    // weight * Bm25::maxScore(idf)
+};
+
+struct RankStats {
+    uint64_t candidates = 0;    // documents taken from essential lists
+    uint64_t postingsScored = 0;
+};
+
+// -------------------- Galloping seek --------------------
+// First index >= from whose docID is >= target
+inline uint32_t seekPosting(const Posting* p, uint32_t count, uint32_t from, uint32_t target) {
+    uint32_t step = 1, lo = from, hi = from;
+    while (hi < count && p[hi].docID < target) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > count) hi = count;
+    return static_cast<uint32_t>(std::lower_bound(p + lo, p + hi, target,
+        [](const Posting& a, uint32_t d) { return a.docID < d; }) - p);
+}
+
+// ----------------------------------------------------
+// Top-k disjunctive query with MaxScore pruning.
+// Terms are ordered by upper bound; once the k-th best score beats the
+// combined bound of the weakest lists, those lists stop producing
+// candidates and are only probed for documents found elsewhere.
+// docLength(docID) supplies BM25 length normalisation; documents the
+// optional filter rejects are skipped before they are scored.
+// ----------------------------------------------------
+template <typename DocLengthFn>
+std::vector<ScoredDoc> maxScoreTopK(
+    std::vector<QueryTerm> terms,
+    size_t k,
+    const Bm25& bm25,
+    DocLengthFn docLength,
+    uint32_t excludeDoc = 0,
+    RankStats* stats = nullptr,
+    const DocFilter* filter = nullptr)
+{
+    std::sort(terms.begin(), terms.end(),
+              [](const QueryTerm& a, const QueryTerm& b) { return a.upperBound < b.upperBound; });
+
+    size_t n = terms.size();
+    std::vector<double> cumulative(n);
+    for (size_t i = 0; i < n; i++)
+        cumulative[i] = terms[i].upperBound + (i ? cumulative[i - 1] : 0.0);
+
+    std::vector<uint32_t> pos(n, 0);
+    auto worse = [](const ScoredDoc& a, const ScoredDoc& b) { return a.score > b.score; };
+    std::priority_queue<ScoredDoc, std::vector<ScoredDoc>, decltype(worse)> heap(worse);
+    double threshold = 0.0;
+    size_t firstEssential = 0;
+
+    while (k > 0) {
+        if (heap.size() == k) {
+            while (firstEssential < n && cumulative[firstEssential] <= threshold) firstEssential++;
+        }
+        if (firstEssential == n) break;
+
+        uint32_t doc = UINT32_MAX;
+        for (size_t i = firstEssential; i < n; i++)
+            if (pos[i] < terms[i].count) doc = std::min(doc, terms[i].postings[pos[i]].docID);
+        if (doc == UINT32_MAX) break;
+
+        if (filter && !filter->allows(doc)) {
+            for (size_t i = firstEssential; i < n; i++)
+                if (pos[i] < terms[i].count && terms[i].postings[pos[i]].docID == doc) pos[i]++;
+            continue;
+        }
+
+        if (stats) stats->candidates++;
+        uint32_t length = docLength(doc);
+        double score = 0.0;
+
+        for (size_t i = firstEssential; i < n; i++) {
+            QueryTerm& t = terms[i];
+            if (pos[i] < t.count && t.postings[pos[i]].docID == doc) {
+                score += t.weight * bm25.score(t.postings[pos[i]].freq, length, t.idf);
+                pos[i]++;
+                if (stats) stats->postingsScored++;
+            }
+        }
+
+        // Non-essential lists, strongest first, while the doc can still make it
+        for (size_t i = firstEssential; i-- > 0; ) {
+            if (heap.size() == k && score + cumulative[i] <= threshold) break;
+            QueryTerm& t = terms[i];
+            pos[i] = seekPosting(t.postings, t.count, pos[i], doc);
+            if (pos[i] < t.count && t.postings[pos[i]].docID == doc) {
+                score += t.weight * bm25.score(t.postings[pos[i]].freq, length, t.idf);
+                if (stats) stats->postingsScored++;
+            }
+        }
+
+        if (doc == excludeDoc) continue;
+        if (heap.size() < k) {
+            heap.push({doc, score});
+        } else if (score > threshold) {
+            heap.pop();
+            heap.push({doc, score});
+        }
+        if (heap.size() == k) threshold = heap.top().score;
+    }
+
+    std::vector<ScoredDoc> results;
+    while (!heap.empty()) { results.push_back(heap.top()); heap.pop(); }
+    std::reverse(results.begin(), results.end());
+    return results;
+}
+
+// ----------------------------------------------------
+// Top-k BM25 query answered from the impact tiers of search_index.bin.
+// Every document in some term's tier (or in a list too short for a tier)
+// is scored exactly. Any other document can score at most the sum of
+// the terms' restMaxImpact, so once the k-th exact score reaches that
+// bound the top k is proven; otherwise the query falls back to MaxScore
+// over the full docID-ordered lists.
+// ----------------------------------------------------
+struct TierStats {
+    bool fromTier = false;
+    uint64_t candidates = 0;
+    double restBound = 0.0;     // best possible score outside the candidates
+    RankStats fallback;
+};
+
+inline std::vector<ScoredDoc> tieredTopK(
+    const SharedIndex& index,
+    const std::vector<const TermEntry*>& terms,
+    size_t k,
+    TierStats* stats = nullptr,
+    const DocFilter* filter = nullptr)
+{
+    TierStats local;
+    if (!stats) stats = &local;
+
+    Bm25 bm25;
+    bm25.docCount = index.indexedDocs();
+    bm25.avgDocLength = index.averageDocLength();
+
+    std::vector<uint32_t> candidates;
+    double restBound = 0.0;
+    for (const TermEntry* t : terms) {
+        if (t->tierOffset) {
+            const ImpactPosting* tier = index.tier(*t);
+            for (uint32_t i = 0; i < t->tierCount; i++) candidates.push_back(tier[i].docID);
+            restBound += t->restMaxImpact / index.impactScale();
+        } else {
+            const Posting* p = index.postings(*t);
+            for (uint32_t i = 0; i < t->postingCount; i++) candidates.push_back(p[i].docID);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (filter) {
+        // The bound still holds: filtering only removes documents
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+            [&](uint32_t d) { return !filter->allows(d); }), candidates.end());
+    }
+    stats->candidates = candidates.size();
+    stats->restBound = restBound;
+
+    // Exact scores from the docID-ordered lists
+    std::vector<ScoredDoc> scored;
+    scored.reserve(candidates.size());
+    for (uint32_t doc : candidates) {
+        uint32_t length = index.docLength(doc);
+        double score = 0.0;
+        for (const TermEntry* t : terms) {
+            const Posting* p = index.postings(*t);
+            uint32_t i = seekPosting(p, t->postingCount, 0, doc);
+            if (i < t->postingCount && p[i].docID == doc)
+                score += bm25.score(p[i].freq, length, bm25.idf(t->df));
+        }
+        scored.push_back({doc, score});
+    }
+
+    auto better = [](const ScoredDoc& a, const ScoredDoc& b) {
+        return a.score != b.score ? a.score > b.score : a.docID < b.docID;
+    };
+    size_t top = std::min(k, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + top, scored.end(), better);
+    scored.resize(top);
+
+    if (restBound == 0.0 || (top == k && k > 0 && scored.back().score >= restBound)) {
+        stats->fromTier = true;
+        return scored;
+    }
+
+    // Not provable from the tiers: full lists
+    std::vector<QueryTerm> query;
+    for (const TermEntry* t : terms) {
+        QueryTerm q;
+        q.postings   = index.postings(*t);
+        q.count      = t->postingCount;
+        q.idf        = bm25.idf(t->df);
+        q.upperBound = bm25.maxScore(q.idf);
+        query.push_back(q);
+    }
+    return maxScoreTopK(query, k, bm25,
+        [&](uint32_t d) { return index.docLength(d); }, 0, &stats->fallback, filter);
+}
@@ -0,0 +1,754 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "shared_index.h"
+#include "shared_index_writer.h"
+#include "posting_containers.h"
+#include "ranking.h"
+#include "doc_store.h"
+#include "doc_attributes.h"
+#include "doc_filter.h"
+#include "query_cache.h"
+#include "autocomplete.h"
+#include "phrase_index.h"
+#include "metrics.h"
+#include "document_text.h"
+#include "document_source.h"
+#include "index_files.h"
+#include "posting_io.h"
+
+// ----------------------------------------------------
+// In-process search library
+//
+//   std::string error;
+//   auto index = SearchIndex::open("index_dir", error);  // nullptr + error on failure
+//   SearchResults r = index->search("covid vaccine", 10);
+//   std::vector<std::string> s = index->suggest("vacc", 5);
+//
+// BarrelIndex answers the same queries from the JSON barrels the search
+// tool reads without --shared.
+//
+// An index directory holds search_index.bin and, when present,
+// docstore.bin (paths, titles, snippets), docattrs.bin (filters) and
+// completions.bin (multi-word suggestions).
+// open() maps them once; every query after that reads the mappings in
+// place. search() and suggest() are const and take no locks, so one
+// SearchIndex can serve any number of threads. To pick up a rebuilt
+// index, open it again and swap the shared_ptr; queries still holding
+// the old one keep their mapping. Queries are tokenized the way the
+// index was built (accent stripping is recorded in search_index.bin), so
+// indexes of either kind can be open in one process.
+//
+// IndexWriter builds such a directory from documents in memory.
+// ----------------------------------------------------
+
+struct SearchOptions {
+    enum Mode { Ranked, And };
+    Mode mode = Ranked;                 // BM25 top-k, or an AND of the words
+    size_t k = 10;                      // 0 with And: every match, in docID order
+    const DocFilter* filter = nullptr;  // see SearchIndex::buildFilter
+    bool fetchDocuments = true;         // fill path/title/snippet from docstore.bin
+};
+
+struct SearchHit {
+    uint32_t docID = 0;
+    double score = 0.0;     // BM25 score (Ranked); the summed term frequency (And)
+    uint32_t freq = 0;      // summed term frequency (And only)
+    std::string path;       // these three need docstore.bin
+    std::string title;
+    std::string snippet;
+};
+
+struct SearchResults {
+    std::vector<std::string> terms;     // the query as searched: folded, deduplicated
+    std::vector<SearchHit> hits;        // best first
+    std::vector<std::string> notes;     // how the query was answered, for debug output
+    std::string message;                // why nothing matched, when that is known
+    std::string error;                  // the index could not be read (BarrelIndex)
+};
+
+// ----------------------------------------------------
+// Completions of a partial query, behind SearchIndex::suggest and the
+// auto_complete tool: the most frequent phrases of completions.bin when
+// one is open, otherwise the words added to the trie, alphabetically
+// ----------------------------------------------------
+struct Suggestion {
+    std::string text;
+    uint32_t count = 0;     // how often the phrase occurs; 0 for a word
+};
+
+class Suggester {
+private:
+    AutocompleteEngine trie;
+    PhraseIndex phrases;
+    bool hasPhrases = false;
+    bool stripAccents;
+
+public:
+    // Prefixes are folded the way the lexicon's words were
+    explicit Suggester(bool stripAccents = false) : trie(stripAccents), stripAccents(stripAccents) {}
+
+    bool openPhrases(const std::string& phrasesFile, std::string& error) {
+        hasPhrases = phrases.open(phrasesFile, error);
+        return hasPhrases;
+    }
+
+    // Words only matter without phrases; add them all before the first suggest()
+    void addWord(const std::string& word) { trie.addWordToLexicon(word); }
+
+    // const, so any number of threads may ask at once
+    std::vector<Suggestion> suggest(const std::string& prefix, size_t k = 5) const {
+        std::vector<Suggestion> found;
+        if (hasPhrases) {
+            for (PhraseCompletion& c : phrases.complete(prefix, k, stripAccents))
+                found.push_back({std::move(c.phrase), c.count});
+        } else {
+            for (std::string& w : trie.getSuggestions(prefix, k)) found.push_back({std::move(w), 0});
+        }
+        return found;
+    }
+
+    bool usesPhrases() const { return hasPhrases; }
+    const PhraseIndex& phraseIndex() const { return phrases; }
+    uint64_t trieBytes() const { return trie.memoryBytes(); }
+};
+
+class SearchIndex {
+private:
+    SharedIndex index;
+    DocStore docStore;
+    DocAttributes attributes;
+    bool hasDocs = false;
+    bool hasAttributes = false;
+
+    // Without completions.bin the trie is filled on the first suggest(),
+    // from the words in search_index.bin
+    std::unique_ptr<Suggester> suggester;
+    mutable std::once_flag trieBuilt;
+
+    SearchIndex() = default;
+
+    const TermEntry* lookup(const std::string& word) const {
+        static Histogram& lookupLatency = metrics().histogram("search_lexicon_lookup_seconds", "Looking up one query word");
+        ScopedTimer lookupTimer(lookupLatency);
+        return index.findTerm(word);
+    }
+
+    void searchRanked(SearchResults& results, const SearchOptions& options) const {
+        static Histogram& rankLatency = metrics().histogram("search_rank_seconds", "BM25 top-k of a ranked query");
+
+        std::vector<const TermEntry*> terms;
+        for (const std::string& w : results.terms) {
+            const TermEntry* term = lookup(w);
+            if (!term || term->postingCount == 0) {
+                results.notes.push_back("Word '" + w + "' has no postings, skipped.");
+                continue;
+            }
+            results.notes.push_back("Word '" + w + "' -> " + std::to_string(term->postingCount) + " docs" +
+                                    (term->tierOffset ? ", tier of " + std::to_string(term->tierCount) : ""));
+            index.prefetch(*term);
+            terms.push_back(term);
+        }
+        if (terms.empty()) return;
+
+        TierStats stats;
+        ScopedTimer rankTimer(rankLatency);
+        std::vector<ScoredDoc> ranked = tieredTopK(index, terms, options.k, &stats, options.filter);
+        rankTimer.stop();
+        if (stats.fromTier) {
+            results.notes.push_back("Answered from impact tiers (" + std::to_string(stats.candidates) + " candidates)");
+        } else {
+            results.notes.push_back("Tiers could not prove the top " + std::to_string(options.k) +
+                                    ", used full lists (" + std::to_string(stats.fallback.postingsScored) +
+                                    " postings scored)");
+        }
+
+        for (const ScoredDoc& d : ranked) {
+            SearchHit hit;
+            hit.docID = d.docID;
+            hit.score = d.score;
+            results.hits.push_back(std::move(hit));
+        }
+    }
+
+    // AND of every word; a single word is its own posting list
+    void searchAnd(SearchResults& results, const SearchOptions& options) const {
+        static Histogram& intersectLatency = metrics().histogram("search_intersect_seconds", "Intersecting the lists of an AND query");
+
+        std::vector<Posting> matches;
+        if (results.terms.size() == 1) {
+            const std::string& w = results.terms[0];
+            const TermEntry* term = lookup(w);
+            if (!term) {
+                results.message = "No results found. Word not in lexicon.";
+                return;
+            }
+            results.notes.push_back("Word '" + w + "' maps to:\n - LexID: " + std::to_string(term->lexID) +
+                                    "\n - Barrel: " + std::to_string(term->barrelID));
+            if (term->postingCount == 0) {
+                results.message = "Word exists in lexicon but has no postings.";
+                return;
+            }
+            const Posting* postings = index.postings(*term);
+            for (uint32_t i = 0; i < term->postingCount; i++)
+                if (!options.filter || options.filter->allows(postings[i].docID)) matches.push_back(postings[i]);
+        } else {
+            // Dense terms are intersected through their bitmap containers
+            std::vector<const TermEntry*> found;
+            std::vector<TermDocs> terms;
+            for (const std::string& w : results.terms) {
+                const TermEntry* term = lookup(w);
+                if (!term || term->postingCount == 0) {
+                    results.message = "No results found. '" + w + "' has no postings.";
+                    return;
+                }
+                results.notes.push_back("Word '" + w + "' -> LexID " + std::to_string(term->lexID) +
+                                        ", Barrel " + std::to_string(term->barrelID) + ", " +
+                                        std::to_string(term->postingCount) + " docs" +
+                                        (term->containerOffset ? " (bitmap containers)" : ""));
+                index.prefetch(*term); // every list starts paging in before the first is touched
+                found.push_back(term);
+                terms.push_back(termDocs(index, *term));
+            }
+
+            ScopedTimer intersectTimer(intersectLatency);
+            IntersectStats stats;
+            std::vector<uint32_t> docIDs = intersectTerms(terms, stats, options.filter);
+            matches.reserve(docIDs.size());
+            for (uint32_t d : docIDs) {
+                uint32_t freq = 0;
+                for (const TermEntry* t : found) freq += postingFreq(index.postings(*t), t->postingCount, d);
+                matches.push_back({d, freq});
+            }
+            intersectTimer.stop();
+            results.notes.push_back("Intersections: " + std::to_string(stats.bitmapAnd) + " bitmap AND, " +
+                                    std::to_string(stats.mixed) + " mixed, " +
+                                    std::to_string(stats.galloping) + " galloping");
+        }
+
+        // With a k the most frequent docs come first
+        if (options.k > 0) {
+            std::stable_sort(matches.begin(), matches.end(),
+                             [](const Posting& a, const Posting& b) { return a.freq > b.freq; });
+            if (matches.size() > options.k) matches.resize(options.k);
+        }
+        for (const Posting& p : matches) {
+            SearchHit hit;
+            hit.docID = p.docID;
+            hit.score = p.freq;
+            hit.freq = p.freq;
+            results.hits.push_back(std::move(hit));
+        }
+    }
+
+public:
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    // Files by name; all but indexFile may be empty
+    static std::shared_ptr<SearchIndex> open(const std::string& indexFile, const std::string& docStoreFile,
+                                             const std::string& attributesFile, std::string& error,
+                                             const std::string& phrasesFile = "") {
+        std::shared_ptr<SearchIndex> opened(new SearchIndex());
+        if (!opened->index.open(indexFile, error)) return nullptr;
+        opened->suggester.reset(new Suggester(opened->index.stripAccents()));
+        if (!docStoreFile.empty()) {
+            if (!opened->docStore.open(docStoreFile, error)) return nullptr;
+            opened->hasDocs = true;
+        }
+        if (!attributesFile.empty()) {
+            if (!opened->attributes.open(attributesFile, error)) return nullptr;
+            opened->hasAttributes = true;
+        }
+        if (!phrasesFile.empty() && !opened->suggester->openPhrases(phrasesFile, error)) return nullptr;
+        return opened;
+    }
+
+    // An index directory, as written by IndexWriter
+    static std::shared_ptr<SearchIndex> open(const std::string& dir, std::string& error) {
+        std::filesystem::path root(dir);
+        auto optional = [&](const char* name) {
+            std::error_code ec;
+            return std::filesystem::exists(root / name, ec) ? (root / name).string() : std::string();
+        };
+        return open((root / "search_index.bin").string(), optional("docstore.bin"), optional("docattrs.bin"),
+                    error, optional("completions.bin"));
+    }
+
+    SearchResults search(const std::string& query, size_t k = 10) const {
+        SearchOptions options;
+        options.k = k;
+        return search(query, options);
+    }
+
+    SearchResults search(const std::string& query, const SearchOptions& options) const {
+        SearchResults results;
+        results.terms = queryTerms(query, index.stripAccents());
+        if (results.terms.empty()) {
+            results.message = "No results found. Query has no words.";
+            return results;
+        }
+
+        if (options.mode == SearchOptions::Ranked) searchRanked(results, options);
+        else searchAnd(results, options);
+
+        // One path block and one text block per hit
+        if (options.fetchDocuments && hasDocs) {
+            StoredDocument doc;
+            for (SearchHit& hit : results.hits) {
+                docStore.fetch(hit.docID, doc);
+                hit.path = doc.path;
+                hit.title = doc.title;
+                if (!doc.text.empty()) hit.snippet = makeSnippet(doc.text, results.terms, 200, index.stripAccents());
+            }
+        }
+        return results;
+    }
+
+    // Up to k completions of a partial query: the most frequent phrases
+    // when completions.bin is there, otherwise indexed words, alphabetically
+    std::vector<std::string> suggest(const std::string& prefix, size_t k = 5) const {
+        std::vector<std::string> completions;
+        for (Suggestion& s : suggestions(prefix, k)) completions.push_back(std::move(s.text));
+        return completions;
+    }
+
+    // The same, with phrase counts
+    std::vector<Suggestion> suggestions(const std::string& prefix, size_t k = 5) const {
+        if (!suggester->usesPhrases()) {
+            std::call_once(trieBuilt, [this]() {
+                for (uint32_t lexID = 1; lexID <= index.termCount(); lexID++)
+                    suggester->addWord(index.word(*index.findTermByLexID(lexID)));
+            });
+        }
+        return suggester->suggest(prefix, k);
+    }
+
+    // Bitset for SearchOptions::filter; needs docattrs.bin
+    bool buildFilter(const AttributeFilter& f, DocFilter& filter, std::string& error) const {
+        if (!hasAttributes) {
+            error = "Filters need an attribute file (docattrs.bin)";
+            return false;
+        }
+        filter = attributes.buildFilter(f);
+        return true;
+    }
+
+    uint64_t generation() const { return index.generation(); }
+    const SharedIndex& shared() const { return index; }
+    const DocStore* documents() const { return hasDocs ? &docStore : nullptr; }
+};
+
+// ----------------------------------------------------
+// AND queries over JSON barrels: lexicon.json, barrel_mapping.json and
+// the barrel_<n>.json files of barrel_creation_storage. Nothing is kept
+// between queries; each one reads and parses the barrels its words live
+// in, all of them at once through PostingReader, so this is the format to
+// check a build with, not to serve from. Queries share the one reader and
+// take turns on it.
+// ----------------------------------------------------
+class BarrelIndex {
+private:
+    std::unordered_map<std::string, int> lexMap;    // word → lexID
+    std::vector<uint32_t> df;                       // df[lexID - 1]; empty for older lexicons
+    std::unordered_map<int, int> barrelMap;         // lexID → barrelID
+    std::string barrelsDir;
+    bool folded = false;
+    mutable PostingReader reader;
+    mutable std::mutex readerLock;
+
+    BarrelIndex() = default;
+
+    uint32_t wordDF(int lexID) const {
+        return (size_t)lexID <= df.size() ? df[lexID - 1] : UINT32_MAX;
+    }
+
+    std::string barrelPath(int barrelID) const {
+        return barrelsDir + "/barrel_" + std::to_string(barrelID) + ".json";
+    }
+
+public:
+    BarrelIndex(const BarrelIndex&) = delete;
+    BarrelIndex& operator=(const BarrelIndex&) = delete;
+
+    static std::shared_ptr<BarrelIndex> open(const std::string& lexiconFile, const std::string& mappingFile,
+                                             const std::string& barrelsDir, std::string& error) {
+        std::vector<std::string> words;
+        std::shared_ptr<BarrelIndex> opened(new BarrelIndex());
+        if (!loadLexiconWords(lexiconFile, words, error, &opened->df, &opened->folded) ||
+            !loadBarrelMapping(mappingFile, opened->barrelMap, error))
+            return nullptr;
+        opened->lexMap = lexiconMap(words);
+        opened->barrelsDir = barrelsDir;
+        return opened;
+    }
+
+    // Only SearchOptions::And; JSON barrels carry no BM25 statistics.
+    // Documents are never fetched, there is no document store.
+    SearchResults search(const std::string& query, const SearchOptions& options) const {
+        static Counter& barrelsReadTotal = metrics().counter("search_barrels_read_total", "JSON barrel files read");
+        static Counter& barrelBytesTotal = metrics().counter("search_barrel_bytes_total", "Bytes of JSON barrels read");
+        static Histogram& lookupLatency = metrics().histogram("search_lexicon_lookup_seconds", "Looking up one query word");
+        static Histogram& barrelIOLatency = metrics().histogram("search_barrel_io_seconds", "Reading (or waiting for) one barrel");
+        static Histogram& parseLatency = metrics().histogram("search_parse_seconds", "Parsing one barrel and extracting its lists");
+        static Histogram& intersectLatency = metrics().histogram("search_intersect_seconds", "Intersecting the lists of an AND query");
+
+        SearchResults results;
+        results.terms = queryTerms(query, folded);
+        if (results.terms.empty()) {
+            results.message = "No results found. Query has no words.";
+            return results;
+        }
+        const std::vector<std::string>& words = results.terms;
+
+        // STEP 1: words → lexIDs → the distinct barrels to read
+        std::vector<int> lexIDs;
+        for (const std::string& w : words) {
+            ScopedTimer lookupTimer(lookupLatency);
+            auto it = lexMap.find(w);
+            lookupTimer.stop();
+            if (it == lexMap.end()) {
+                results.message = words.size() == 1 ? "No results found. Word not in lexicon."
+                                                    : "No results found. '" + w + "' not in lexicon.";
+                return results;
+            }
+            lexIDs.push_back(it->second);
+        }
+
+        // Rarest word first, by the lexicon's df, so its barrel is the first
+        // read issued and the shortest list is usually ready first
+        std::vector<size_t> order(words.size());
+        for (size_t w = 0; w < order.size(); w++) order[w] = w;
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return wordDF(lexIDs[a]) < wordDF(lexIDs[b]); });
+
+        std::vector<int> barrelIDs;
+        for (size_t w : order) {
+            int barrelID = barrelMap.at(lexIDs[w]);
+            if (words.size() == 1) {
+                results.notes.push_back("Word '" + words[w] + "' maps to:\n - LexID: " + std::to_string(lexIDs[w]) +
+                                        "\n - Barrel: " + std::to_string(barrelID));
+            } else {
+                results.notes.push_back("Word '" + words[w] + "' -> LexID " + std::to_string(lexIDs[w]) +
+                                        ", Barrel " + std::to_string(barrelID) +
+                                        (wordDF(lexIDs[w]) != UINT32_MAX ? ", df " + std::to_string(wordDF(lexIDs[w])) : ""));
+            }
+            if (std::find(barrelIDs.begin(), barrelIDs.end(), barrelID) == barrelIDs.end())
+                barrelIDs.push_back(barrelID);
+        }
+
+        // STEP 2: issue every barrel read up front
+        std::vector<ReadRequest> reads(barrelIDs.size());
+        for (size_t i = 0; i < barrelIDs.size(); i++) reads[i].path = barrelPath(barrelIDs[i]);
+        std::unique_lock<std::mutex> readerGuard(readerLock);
+        reader.submit(reads);
+
+        // STEP 3: decode each barrel as it lands, keeping only the query's lists
+        // The I/O time of a barrel is how long the loop waited for it
+        std::vector<std::vector<Posting>> lists(words.size());
+        std::vector<bool> found(words.size(), false);
+        auto waitStart = std::chrono::steady_clock::now();
+        for (int done = reader.next(); done >= 0; done = reader.next()) {
+            barrelIOLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - waitStart).count());
+            if (!reads[done].ok) {
+                if (results.error.empty()) results.error = "Cannot open barrel file " + reads[done].path;
+                continue;
+            }
+            barrelsReadTotal.add();
+            barrelBytesTotal.add(reads[done].data.size());
+
+            ScopedTimer parseTimer(parseLatency);
+            nlohmann::json barrel = nlohmann::json::parse(reads[done].data, nullptr, false);
+            reads[done].data = std::string(); // release the raw bytes early
+            if (barrel.is_discarded()) {
+                if (results.error.empty()) results.error = "Corrupt barrel file " + reads[done].path;
+                continue;
+            }
+
+            for (size_t w = 0; w < words.size(); w++) {
+                if (barrelMap.at(lexIDs[w]) != barrelIDs[done]) continue;
+                auto it = barrel.find(std::to_string(lexIDs[w]));
+                if (it == barrel.end()) continue;
+                found[w] = true;
+                for (auto& [docID, freq] : it->items())
+                    lists[w].push_back({(uint32_t)std::stoul(docID), freq.get<uint32_t>()});
+                // JSON keys are ordered as strings, not numbers
+                std::sort(lists[w].begin(), lists[w].end(),
+                          [](const Posting& a, const Posting& b) { return a.docID < b.docID; });
+            }
+            parseTimer.stop();
+            waitStart = std::chrono::steady_clock::now();
+        }
+        if (words.size() > 1)
+            results.notes.push_back("Read " + std::to_string(reads.size()) + " barrel(s) via " + reader.backend());
+        readerGuard.unlock();
+        if (!results.error.empty()) return results;
+        if (words.size() == 1 && !found[0]) {
+            results.message = "Word exists in lexicon but has no postings.";
+            return results;
+        }
+
+        // STEP 4: intersect, summing frequencies; one word is its own list
+        std::vector<Posting> matches;
+        if (words.size() == 1) {
+            for (const Posting& p : lists[0])
+                if (!options.filter || options.filter->allows(p.docID)) matches.push_back(p);
+        } else {
+            ScopedTimer intersectTimer(intersectLatency);
+            std::vector<TermDocs> terms;
+            for (auto& list : lists) terms.push_back({list.data(), (uint32_t)list.size(), ContainerSet()});
+            IntersectStats stats;
+            for (uint32_t d : intersectTerms(terms, stats, options.filter)) {
+                uint32_t freq = 0;
+                for (auto& list : lists) freq += postingFreq(list.data(), list.size(), d);
+                matches.push_back({d, freq});
+            }
+        }
+
+        // With a k the most frequent docs come first
+        if (options.k > 0) {
+            std::stable_sort(matches.begin(), matches.end(),
+                             [](const Posting& a, const Posting& b) { return a.freq > b.freq; });
+            if (matches.size() > options.k) matches.resize(options.k);
+        }
+        for (const Posting& p : matches) {
+            SearchHit hit;
+            hit.docID = p.docID;
+            hit.score = p.freq;
+            hit.freq = p.freq;
+            results.hits.push_back(std::move(hit));
+        }
+        return results;
+    }
+
+    bool stripAccents() const { return folded; }
+    size_t termCount() const { return lexMap.size(); }
+
+    // Heap of the lexicon, df and barrel maps (memory_usage.h)
+    uint64_t memoryBytes() const { return heapBytes(lexMap) + heapBytes(df) + heapBytes(barrelMap); }
+};
+
+// ----------------------------------------------------
+// Builds an index directory in one process: lexicon.json,
+// barrel_mapping.json, search_index.bin, docstore.bin, docattrs.bin and
+// completions.bin, numbered the
+// way build_lexicon / barrel_mapping / build_shared_index would number
+// them. Postings stay in memory until commit(), so this is meant for
+// collections that fit in RAM; the standalone builders checkpoint and
+// stream for the rest.
+//
+//   IndexWriter writer;
+//   writer.open("index_dir", error);
+//   writer.add("notes/a.txt", text);        // or addAll("dataset/")
+//   writer.commit(error);                   // then SearchIndex::open("index_dir", ...)
+// ----------------------------------------------------
+struct IndexWriterOptions {
+    bool cord19Json = true;         // CORD-19 .json: title, abstract and body only
+    bool storeDocuments = true;     // write docstore.bin
+    bool writeAttributes = true;    // write docattrs.bin (extension, directory, year filters)
+    std::string metadataFile;       // CORD-19 metadata.csv for publish years; none = year unknown
+    uint32_t phraseWords = 3;       // completions.bin n-grams up to this long (0 = none)
+    uint32_t phraseMinCount = 3;
+    size_t phraseMaxEntries = 4000000;
+    bool stripAccents = false;      // fold "naïve" to "naive"; recorded in the index
+    SharedIndexOptions shared;      // containers and impact tiers
+};
+
+class IndexWriter {
+private:
+    struct Term {
+        std::string word;
+        uint64_t cf = 0;
+        std::vector<Posting> postings;   // df = postings.size()
+    };
+
+    std::filesystem::path root;
+    IndexWriterOptions options;
+    std::unordered_map<std::string, uint32_t> termSlots;  // word → index in terms
+    std::vector<Term> terms;
+    FlatTermMap<int> termFreq;   // reused, reset per document
+    DocStoreWriter docStore;
+    DocAttributesWriter attributes;
+    std::unordered_map<std::string, uint16_t> publishYears;
+    std::unique_ptr<PhraseCounter> phrases;
+    uint32_t docCount = 0;       // highest docID so far
+    bool isOpen = false;
+
+    // datasetDir names the directory column, as in build_forward_index;
+    // add() passes "", so a relative path gives its first directory
+    void addDocument(uint32_t docID, const std::string& path, const std::string& content,
+                     const std::string& datasetDir) {
+        std::string title, storedText;
+        bool keepText = options.storeDocuments || phrases;
+        termFreq.reset();
+        tokenizeDocument(std::filesystem::path(path), content, options.cord19Json, termFreq,
+                         keepText ? &title : nullptr, keepText ? &storedText : nullptr, options.stripAccents);
+
+        for (auto p : termFreq) {
+            auto it = termSlots.find(std::string(p.first));
+            if (it == termSlots.end()) {
+                it = termSlots.emplace(std::string(p.first), terms.size()).first;
+                terms.push_back({it->first, 0, {}});
+            }
+            Term& t = terms[it->second];
+            t.cf += p.second;
+            t.postings.push_back({docID, static_cast<uint32_t>(p.second)});
+        }
+        if (options.storeDocuments) docStore.add(docID, path, title, storedText);
+        if (options.writeAttributes) {
+            std::string stem = std::filesystem::path(path).filename().string();
+            auto year = publishYears.find(stem.substr(0, stem.find('.')));
+            attributes.add(docID, docExtension(path), docDirectory(path, datasetDir),
+                           year == publishYears.end() ? 0 : year->second);
+        }
+        if (phrases) {
+            phrases->addText(title);
+            phrases->addText(storedText);
+        }
+        docCount = std::max(docCount, docID);
+    }
+
+public:
+    bool open(const std::string& dir, std::string& error, const IndexWriterOptions& opts = IndexWriterOptions()) {
+        root = dir;
+        options = opts;
+        std::error_code ec;
+        std::filesystem::create_directories(root, ec);
+        if (ec) {
+            error = "Cannot create index directory " + dir + ": " + ec.message();
+            return false;
+        }
+        if (options.storeDocuments && !docStore.open((root / "docstore.bin").string())) {
+            error = "Cannot write " + (root / "docstore.bin").string();
+            return false;
+        }
+        if (options.writeAttributes && !attributes.open((root / "docattrs.bin").string())) {
+            error = "Cannot write " + (root / "docattrs.bin").string();
+            return false;
+        }
+        if (!options.metadataFile.empty() && !loadPublishYears(options.metadataFile, publishYears)) {
+            error = "Cannot read sha/publish_time from " + options.metadataFile;
+            return false;
+        }
+        if (options.phraseWords > 0)
+            phrases.reset(new PhraseCounter(options.phraseWords, options.phraseMinCount, options.phraseMaxEntries,
+                                            options.stripAccents));
+        isOpen = true;
+        return true;
+    }
+
+    // One document under the next docID, which is returned
+    uint32_t add(const std::string& path, const std::string& content) {
+        addDocument(docCount + 1, path, content, "");
+        return docCount;
+    }
+
+    // A dataset directory or .tar.gz, with the docIDs build_forward_index
+    // would give it (after any documents already added)
+    bool addAll(const std::string& input, std::string& error) {
+        uint32_t base = docCount;
+        bool ok = forEachDocument(input, false, [&](int docID, const std::string& path, const std::string& content) {
+            addDocument(base + docID, path, content, input);
+        });
+        if (!ok) error = "Cannot read dataset " + input;
+        return ok;
+    }
+
+    uint32_t documents() const { return docCount; }
+    size_t termCount() const { return terms.size(); }
+
+    // Estimated heap of what add() has collected (memory_usage.h)
+    uint64_t memoryBytes() const {
+        uint64_t total = heapBytes(termSlots) + terms.capacity() * sizeof(Term) + termFreq.memoryBytes();
+        for (const Term& t : terms) total += heapBytes(t.word) + heapBytes(t.postings);
+        if (phrases) total += phrases->memoryBytes();
+        total += heapBytes(publishYears);
+        return total;
+    }
+
+    // Writes every file; the writer is spent afterwards
+    bool commit(std::string& error) {
+        if (!isOpen) {
+            error = "Index writer is not open";
+            return false;
+        }
+        isOpen = false;
+
+        // lexIDs by descending cf, then df, then word, as build_lexicon assigns them
+        std::vector<uint32_t> order(terms.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const Term& x = terms[a];
+            const Term& y = terms[b];
+            if (x.cf != y.cf) return x.cf > y.cf;
+            if (x.postings.size() != y.postings.size()) return x.postings.size() > y.postings.size();
+            return x.word < y.word;
+        });
+
+        nlohmann::json lexJson;
+        lexJson["lexicon"] = nlohmann::json::array();
+        lexJson["cf"] = nlohmann::json::array();
+        lexJson["df"] = nlohmann::json::array();
+        lexJson["documents"] = docCount;
+        if (options.stripAccents) lexJson["strip_accents"] = true;
+        std::vector<std::string> words;
+        std::unordered_map<int,int> barrelMap;
+        std::vector<std::vector<uint32_t>> barrelTerms(BARREL_COUNT);  // lexIDs, ascending
+        nlohmann::json mapJson = nlohmann::json::object();
+        for (uint32_t i : order) {
+            const Term& t = terms[i];
+            int lexID = words.size() + 1;
+            int barrelID = barrelOfWord(t.word);
+            words.push_back(t.word);
+            lexJson["lexicon"].push_back(t.word);
+            lexJson["cf"].push_back(t.cf);
+            lexJson["df"].push_back(t.postings.size());
+            barrelMap[lexID] = barrelID;
+            mapJson[std::to_string(lexID)] = barrelID;
+            barrelTerms[barrelID].push_back(lexID);
+        }
+
+        auto writeJson = [&](const char* name, const nlohmann::json& j) {
+            std::ofstream out(root / name);
+            out << j.dump(4);
+            if (!out) error = "Cannot write " + (root / name).string();
+            return static_cast<bool>(out);
+        };
+        if (!writeJson("lexicon.json", lexJson) || !writeJson("barrel_mapping.json", mapJson)) return false;
+
+        auto readBarrel = [&](int b, const std::function<void(uint32_t, std::vector<Posting>&)>& emit,
+                              std::string&) {
+            for (uint32_t lexID : barrelTerms[b]) emit(lexID, terms[order[lexID - 1]].postings);
+            return true;
+        };
+        SharedIndexOptions shared = options.shared;
+        shared.stripAccents = options.stripAccents;
+        if (!writeSharedIndex(words, barrelMap, readBarrel, (root / "search_index.bin").string(),
+                              shared, error))
+            return false;
+
+        if (options.storeDocuments && !docStore.finish()) {
+            error = "Cannot write " + (root / "docstore.bin").string();
+            return false;
+        }
+        if (options.writeAttributes && !attributes.finish()) {
+            error = "Cannot write " + (root / "docattrs.bin").string();
+            return false;
+        }
+        if (phrases && !writePhraseIndex((root / "completions.bin").string(), phrases->frequent(),
+                                         phrases->wordsPerPhrase(), phrases->minimumCount())) {
+            error = "Cannot write " + (root / "completions.bin").string();
+            return false;
+        }
+        return true;
+    }
+};
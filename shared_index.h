@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "mapped_file.h"
+
+// ----------------------------------------------------
+// Binary layout of search_index.bin
+//
+// [SharedIndexHeader]
+// [TermEntry x termCount]      sorted by word, for binary search
+// [BarrelEntry x barrelCount]  barrelID -> its slice of the postings section
+// [u32 x termCount+1]          lexID -> dictionary slot
+// [word bytes]                 not NUL terminated, see TermEntry::wordLength
+// [Posting ...]                grouped by barrel, docIDs ascending per term;
+//                              dense terms are followed by their bitmap/array
+//                              containers (posting_containers.h)
+// [ImpactPosting ...]          per-term high tier, best BM25 impact first
+// [u32 x docCount+1]           docID -> document length in tokens
+//
+// Every reference is a byte offset from the start of the file, never a
+// pointer, so the file can be mapped at any address by any number of
+// search processes at the same time.
+// ----------------------------------------------------
+static const char SHARED_INDEX_MAGIC[8] = {'S','E','I','D','X','0','1','\0'};
+static const uint32_t SHARED_INDEX_VERSION = 6;
+
+// SharedIndexHeader::flags
+static const uint64_t SHARED_INDEX_STRIP_ACCENTS = 1;   // words folded with accents stripped
+
+struct SharedIndexHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t barrelCount;
+    uint64_t generation;      // changes on every build
+    uint64_t termCount;
+    uint64_t termsOffset;
+    uint64_t barrelsOffset;
+    uint64_t lexSlotsOffset;
+    uint64_t stringsOffset;
+    uint64_t postingsOffset;
+    uint64_t docLengthsOffset;
+    uint32_t docCount;        // highest docID
+    uint32_t tierSize;        // 0 when the index has no impact tiers
+    uint64_t indexedDocs;
+    uint64_t totalTokens;
+    double   impactScale;     // quantized impact = ceil(BM25 score * impactScale)
+    uint64_t fileSize;
+    uint64_t flags;           // SHARED_INDEX_* bits: how the words were tokenized
+};
+
+struct TermEntry {
+    uint64_t wordOffset;
+    uint64_t postingsOffset;
+    uint64_t containerOffset;   // 0 when the term only has its posting array
+    uint64_t tierOffset;        // 0 when the whole list fits in one tier
+    uint32_t wordLength;
+    uint32_t lexID;
+    uint32_t barrelID;
+    uint32_t postingCount;
+    uint32_t tierCount;
+    uint32_t restMaxImpact;     // best impact among postings left out of the tier
+    uint32_t df;                // BM25 df: postingCount, or the full index's for pruned barrels
+    uint32_t reserved;
+};
+
+struct BarrelEntry {
+    uint64_t postingsOffset;
+    uint64_t postingsBytes;
+    uint64_t termCount;
+};
+
+struct Posting {
+    uint32_t docID;
+    uint32_t freq;
+};
+
+struct ImpactPosting {
+    uint32_t docID;
+    uint32_t impact;
+};
+
+// ----------------------------------------------------
+// Read-only view over a mapped search_index.bin
+// ----------------------------------------------------
+class SharedIndex {
+private:
+    MappedFile file;
+    const SharedIndexHeader* header = nullptr;
+    const TermEntry* terms = nullptr;
+    const BarrelEntry* barrels = nullptr;
+    const uint32_t* lexSlots = nullptr;
+
+    int compareWord(const TermEntry& t, const std::string& word) const {
+        size_t n = std::min<size_t>(t.wordLength, word.size());
+        int c = std::memcmp(file.data() + t.wordOffset, word.data(), n);
+        if (c != 0) return c;
+        if (t.wordLength == word.size()) return 0;
+        return t.wordLength < word.size() ? -1 : 1;
+    }
+
+public:
+    bool open(const std::string& path, std::string& error) {
+        if (!file.open(path)) {
+            error = "Cannot map shared index file " + path;
+            return false;
+        }
+        if (file.size() < sizeof(SharedIndexHeader)) {
+            error = "Shared index file is truncated";
+            return false;
+        }
+
+        header = reinterpret_cast<const SharedIndexHeader*>(file.data());
+        if (std::memcmp(header->magic, SHARED_INDEX_MAGIC, sizeof(SHARED_INDEX_MAGIC)) != 0 ||
+            header->version != SHARED_INDEX_VERSION) {
+            error = "Not a shared index file (bad magic or version)";
+            return false;
+        }
+        if (header->fileSize != file.size()) {
+            error = "Shared index file size does not match its header";
+            return false;
+        }
+
+        terms   = reinterpret_cast<const TermEntry*>(file.data() + header->termsOffset);
+        barrels = reinterpret_cast<const BarrelEntry*>(file.data() + header->barrelsOffset);
+        lexSlots = reinterpret_cast<const uint32_t*>(file.data() + header->lexSlotsOffset);
+        return true;
+    }
+
+    uint64_t generation() const { return header->generation; }
+    uint64_t termCount() const { return header->termCount; }
+    uint32_t barrelCount() const { return header->barrelCount; }
+    size_t   mappedBytes() const { return file.size(); }
+
+    const BarrelEntry& barrel(uint32_t barrelID) const { return barrels[barrelID]; }
+
+    // Binary search of the sorted dictionary; nullptr when the word is unknown
+    const TermEntry* findTerm(const std::string& word) const {
+        uint64_t lo = 0, hi = header->termCount;
+        while (lo < hi) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            int c = compareWord(terms[mid], word);
+            if (c == 0) return &terms[mid];
+            if (c < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return nullptr;
+    }
+
+    // Direct lookup for callers that already hold lexIDs (forward index)
+    const TermEntry* findTermByLexID(uint32_t lexID) const {
+        if (lexID == 0 || lexID > header->termCount) return nullptr;
+        return &terms[lexSlots[lexID]];
+    }
+
+    std::string word(const TermEntry& t) const {
+        return std::string(file.data() + t.wordOffset, t.wordLength);
+    }
+
+    const Posting* postings(const TermEntry& t) const {
+        return reinterpret_cast<const Posting*>(file.data() + t.postingsOffset);
+    }
+
+    // Starts paging in a term's postings ahead of use
+    void prefetch(const TermEntry& t) const {
+        file.prefetch(t.postingsOffset, uint64_t(t.postingCount) * sizeof(Posting));
+    }
+
+    // High tier of a long list, ordered by descending impact
+    const ImpactPosting* tier(const TermEntry& t) const {
+        return reinterpret_cast<const ImpactPosting*>(file.data() + t.tierOffset);
+    }
+
+    uint32_t docCount() const { return header->docCount; }
+    uint64_t indexedDocs() const { return header->indexedDocs; }
+    uint32_t tierSize() const { return header->tierSize; }
+    double impactScale() const { return header->impactScale; }
+    // Queries must be tokenized with this to match the stored words
+    bool stripAccents() const { return header->flags & SHARED_INDEX_STRIP_ACCENTS; }
+
+    double averageDocLength() const {
+        return header->indexedDocs ? double(header->totalTokens) / header->indexedDocs : 0.0;
+    }
+
+    uint32_t docLength(uint32_t docID) const {
+        if (docID > header->docCount) return 0;
+        return reinterpret_cast<const uint32_t*>(file.data() + header->docLengthsOffset)[docID];
+    }
+
+    // Container block of a dense term (posting_containers.h), nullptr otherwise
+    const char* containerBlock(const TermEntry& t) const {
+        return t.containerOffset ? file.data() + t.containerOffset : nullptr;
+    }
+};
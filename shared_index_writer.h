@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "shared_index.h"
+#include "posting_containers.h"
+#include "ranking.h"
+
+// ----------------------------------------------------
+// Writer for search_index.bin (layout in shared_index.h)
+//
+// Postings come from a BarrelSource, one barrel at a time, so peak
+// memory is the lexicon plus the largest barrel, not the whole index.
+// build_shared_index feeds it JSON barrels; IndexWriter (search_engine.h)
+// feeds it the postings it built in memory.
+// ----------------------------------------------------
+
+// Calls emit(lexID, list) for every term of barrel b, lexIDs ascending.
+// The list may be reordered by the writer. Returns false on error.
+using BarrelSource = std::function<bool(int barrelID,
+                                        const std::function<void(uint32_t, std::vector<Posting>&)>& emit,
+                                        std::string& error)>;
+
+struct SharedIndexOptions {
+    // A 64K docID chunk with more docs than this is stored as a bitmap
+    uint32_t bitmapThreshold = CONTAINER_ARRAY_MAX;
+    // Postings per term kept in the impact-ordered high tier (0 = no tiers)
+    uint32_t tierSize = 1000;
+    // Progress lines ("✓ Barrel 3 packed: ..."); nullptr for none
+    std::ostream* log = nullptr;
+    // Statistics to score with instead of the ones the postings add up
+    // to: pruned barrels keep the full index's document lengths (by docID)
+    // and df (by lexID - 1), from index_stats.json, so BM25 scores of the
+    // postings left stay what they were
+    const std::vector<uint32_t>* docLengths = nullptr;
+    const std::vector<uint32_t>* documentFrequencies = nullptr;
+    // The words were folded with accents stripped; recorded in the header
+    // so queries against the index fold the same way
+    bool stripAccents = false;
+};
+
+inline uint64_t alignUp(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+inline bool writeSharedIndex(
+    const std::vector<std::string>& words,
+    const std::unordered_map<int,int>& barrelMap,
+    const BarrelSource& readBarrel,
+    const std::string& outFile,
+    const SharedIndexOptions& options,
+    std::string& error)
+{
+    std::ostream* log = options.log;
+    uint32_t bitmapThreshold = options.bitmapThreshold;
+    uint32_t tierSize = options.tierSize;
+
+    int barrelCount = 0;
+    for (auto& p : barrelMap) barrelCount = std::max(barrelCount, p.second + 1);
+
+    // Dictionary sorted by word; lexIDs keep their lexicon numbering
+    std::vector<uint32_t> order(words.size());
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return words[a] < words[b]; });
+
+    SharedIndexHeader header{};
+    std::memcpy(header.magic, SHARED_INDEX_MAGIC, sizeof(SHARED_INDEX_MAGIC));
+    header.version     = SHARED_INDEX_VERSION;
+    header.barrelCount = barrelCount;
+    header.generation  = std::chrono::system_clock::now().time_since_epoch().count();
+    header.termCount   = words.size();
+    header.flags       = options.stripAccents ? SHARED_INDEX_STRIP_ACCENTS : 0;
+    header.termsOffset   = sizeof(SharedIndexHeader);
+    header.barrelsOffset = header.termsOffset + words.size() * sizeof(TermEntry);
+    header.lexSlotsOffset = header.barrelsOffset + barrelCount * sizeof(BarrelEntry);
+    header.stringsOffset = header.lexSlotsOffset + (words.size() + 1) * sizeof(uint32_t);
+
+    std::vector<TermEntry> terms(words.size());
+    std::vector<uint32_t> slotOfLexID(words.size() + 1);
+    uint64_t stringPos = header.stringsOffset;
+    for (uint32_t slot = 0; slot < order.size(); slot++) {
+        uint32_t i = order[slot];
+        TermEntry& t = terms[slot];
+        t.lexID      = i + 1;
+        t.wordOffset = stringPos;
+        t.wordLength = words[i].size();
+        auto it = barrelMap.find(t.lexID);
+        t.barrelID   = it == barrelMap.end() ? 0 : it->second;
+        slotOfLexID[t.lexID] = slot;
+        stringPos += t.wordLength;
+    }
+    header.postingsOffset = alignUp(stringPos, 8);
+
+    std::string tmpFile = outFile + ".tmp";
+    std::ofstream fout(tmpFile, std::ios::binary);
+    if (!fout) {
+        error = "Cannot write " + tmpFile;
+        return false;
+    }
+
+    // Postings go first, barrel by barrel, at their final offsets
+    std::vector<BarrelEntry> barrels(barrelCount);
+    uint64_t pos = header.postingsOffset;
+    fout.seekp(pos);
+    uint64_t denseTerms = 0;
+    std::vector<uint32_t> docLengths(1, 0);   // sum of term frequencies per doc
+    bool givenLengths = options.docLengths && !options.docLengths->empty();
+    if (givenLengths) docLengths = *options.docLengths;
+    int current = 0;
+
+    auto emit = [&](uint32_t lexID, std::vector<Posting>& list) {
+        if (lexID < 1 || lexID > words.size()) return;
+        std::sort(list.begin(), list.end(),
+                  [](const Posting& a, const Posting& c) { return a.docID < c.docID; });
+        if (!list.empty() && list.back().docID >= docLengths.size())
+            docLengths.resize(list.back().docID + 1, 0);
+        if (!givenLengths)
+            for (const Posting& p : list) docLengths[p.docID] += p.freq;
+
+        TermEntry& t = terms[slotOfLexID[lexID]];
+        t.postingsOffset = pos;
+        t.postingCount   = list.size();
+        t.df             = list.size();
+        if (options.documentFrequencies)
+            t.df = std::max<uint32_t>(t.df, (*options.documentFrequencies)[lexID - 1]);
+        fout.write(reinterpret_cast<const char*>(list.data()), list.size() * sizeof(Posting));
+        pos += list.size() * sizeof(Posting);
+        barrels[current].termCount++;
+
+        // Dense terms also get Roaring-style containers for fast AND
+        if (needsContainers(list.data(), list.size(), bitmapThreshold)) {
+            std::string block = encodeContainers(list.data(), list.size(), bitmapThreshold);
+            std::string padding(alignUp(pos, 8) - pos, '\0');
+            fout.write(padding.data(), padding.size());
+            pos += padding.size();
+
+            t.containerOffset = pos;
+            fout.write(block.data(), block.size());
+            pos += block.size();
+            denseTerms++;
+        }
+    };
+
+    for (int b = 0; b < barrelCount; b++) {
+        barrels[b].postingsOffset = pos;
+        current = b;
+        if (!readBarrel(b, emit, error)) return false;
+
+        barrels[b].postingsBytes = pos - barrels[b].postingsOffset;
+        if (log) *log << "✓ Barrel " << b << " packed: " << barrels[b].termCount << " terms\n";
+    }
+    if (log) *log << "✓ Dense terms with bitmap containers: " << denseTerms << "\n";
+
+    // BM25 statistics, now that every document's length is known
+    header.docCount = docLengths.size() - 1;
+    for (uint32_t length : docLengths) {
+        if (length == 0) continue;
+        header.indexedDocs++;
+        header.totalTokens += length;
+    }
+    Bm25 bm25;
+    bm25.docCount = header.indexedDocs;
+    bm25.avgDocLength = header.indexedDocs ? double(header.totalTokens) / header.indexedDocs : 1.0;
+
+    // One global scale maps the largest possible term score onto 16 bits,
+    // so impacts of different terms add up on the same footing
+    double maxUpper = 0.0;
+    for (const auto& t : terms)
+        if (t.postingCount) maxUpper = std::max(maxUpper, bm25.maxScore(bm25.idf(t.df)));
+    header.impactScale = maxUpper > 0 ? 65535.0 / maxUpper : 1.0;
+    header.tierSize = tierSize;
+
+    // -------------------- Impact tiers --------------------
+    // Lists longer than the tier get their best postings copied out in
+    // impact order; the docID-ordered list stays the source of truth
+    uint64_t tieredTerms = 0;
+    if (tierSize > 0) {
+        fout.flush();
+        std::ifstream back(tmpFile, std::ios::binary);
+        std::vector<Posting> list;
+        std::vector<ImpactPosting> impacts;
+
+        for (auto& t : terms) {
+            if (t.postingCount <= tierSize) continue;
+
+            list.resize(t.postingCount);
+            back.seekg(t.postingsOffset);
+            back.read(reinterpret_cast<char*>(list.data()), list.size() * sizeof(Posting));
+
+            double idf = bm25.idf(t.df);
+            impacts.clear();
+            for (const Posting& p : list) {
+                double score = bm25.score(p.freq, docLengths[p.docID], idf);
+                impacts.push_back({p.docID, static_cast<uint32_t>(std::ceil(score * header.impactScale))});
+            }
+            std::sort(impacts.begin(), impacts.end(), [](const ImpactPosting& a, const ImpactPosting& c) {
+                return a.impact != c.impact ? a.impact > c.impact : a.docID < c.docID;
+            });
+
+            t.tierOffset    = pos;
+            t.tierCount     = tierSize;
+            t.restMaxImpact = impacts[tierSize].impact;
+            fout.write(reinterpret_cast<const char*>(impacts.data()), tierSize * sizeof(ImpactPosting));
+            pos += tierSize * sizeof(ImpactPosting);
+            tieredTerms++;
+        }
+        if (!back) {
+            error = "Cannot read back postings from " + tmpFile;
+            return false;
+        }
+    }
+    if (log) *log << "✓ Terms with an impact tier of " << tierSize << ": " << tieredTerms << "\n";
+
+    header.docLengthsOffset = pos;
+    fout.write(reinterpret_cast<const char*>(docLengths.data()), docLengths.size() * sizeof(uint32_t));
+    pos += docLengths.size() * sizeof(uint32_t);
+    header.fileSize = pos;
+
+    // Terms with no postings point at an empty range
+    for (auto& t : terms)
+        if (t.postingCount == 0) t.postingsOffset = header.postingsOffset;
+
+    fout.seekp(0);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(terms.data()), terms.size() * sizeof(TermEntry));
+    fout.write(reinterpret_cast<const char*>(barrels.data()), barrels.size() * sizeof(BarrelEntry));
+    fout.write(reinterpret_cast<const char*>(slotOfLexID.data()), slotOfLexID.size() * sizeof(uint32_t));
+    for (uint32_t i : order) fout.write(words[i].data(), words[i].size());
+    std::string padding(header.postingsOffset - stringPos, '\0');
+    fout.write(padding.data(), padding.size());
+    fout.close();
+
+    if (!fout) {
+        error = "Failed while writing " + tmpFile;
+        return false;
+    }
+
+    // Rename over the old file so attached workers keep their old mapping
+    // (Windows refuses to rename onto an existing file, so retry after removing it)
+    if (std::rename(tmpFile.c_str(), outFile.c_str()) != 0 &&
+        (std::remove(outFile.c_str()) != 0 || std::rename(tmpFile.c_str(), outFile.c_str()) != 0)) {
+        error = "Cannot rename " + tmpFile + " to " + outFile;
+        return false;
+    }
+
+    if (log) *log << "✓ Shared index saved: " << outFile
+                  << " (" << header.fileSize << " bytes, generation "
+                  << header.generation << ")\n";
+    return true;
+}
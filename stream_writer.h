@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ----------------------------------------------------
+// Buffered file writer
+// Collects output in one large page-aligned buffer and hands it to the
+// OS in full-buffer chunks, instead of many small stream insertions.
+// ----------------------------------------------------
+class BufferedWriter {
+private:
+    static constexpr size_t ALIGNMENT = 4096;
+
+    std::FILE* file = nullptr;
+    char* buffer = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    uint64_t written = 0;
+    bool failed = false;
+
+public:
+    explicit BufferedWriter(size_t bufferBytes = 1 << 20) : capacity(bufferBytes) {
+        buffer = static_cast<char*>(::operator new(capacity, std::align_val_t(ALIGNMENT)));
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter() {
+        close();
+        ::operator delete(buffer, std::align_val_t(ALIGNMENT));
+    }
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        std::setvbuf(file, nullptr, _IONBF, 0); // our buffer is the only one
+        used = 0;
+        written = 0;
+        failed = false;
+        return true;
+    }
+
+    void write(const char* data, size_t n) {
+        while (n > 0) {
+            size_t room = capacity - used;
+            size_t take = n < room ? n : room;
+            std::memcpy(buffer + used, data, take);
+            used += take;
+            data += take;
+            n -= take;
+            if (used == capacity) flush();
+        }
+    }
+
+    void write(std::string_view s) { write(s.data(), s.size()); }
+
+    void put(char c) {
+        buffer[used++] = c;
+        if (used == capacity) flush();
+    }
+
+    void flush() {
+        if (!file || used == 0) return;
+        if (std::fwrite(buffer, 1, used, file) != used) failed = true;
+        written += used;
+        used = 0;
+    }
+
+    // Returns false if any write failed
+    bool close() {
+        if (!file) return !failed;
+        flush();
+        if (std::fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+
+    uint64_t bytesWritten() const { return written + used; }
+};
+
+// ----------------------------------------------------
+// Record-at-a-time output for the index builders
+//
+// Pretty  - same layout as json::dump(4)
+// Compact - JSON without whitespace
+// MsgPack - MessagePack; containers need their element count up front
+// ----------------------------------------------------
+enum class OutputFormat { Pretty, Compact, MsgPack };
+
+class RecordWriter {
+private:
+    BufferedWriter& out;
+    OutputFormat format;
+    std::vector<bool> hasElements; // one entry per open JSON container
+    bool afterKey = false;
+
+    void indent() {
+        out.put('\n');
+        for (size_t i = 0; i < hasElements.size(); i++) out.write("    ", 4);
+    }
+
+    // Comma / newline handling before any JSON value or key
+    void beginElement() {
+        if (afterKey) { afterKey = false; return; }
+        if (hasElements.empty()) return;
+        if (hasElements.back()) out.put(',');
+        hasElements.back() = true;
+        if (format == OutputFormat::Pretty) indent();
+    }
+
+    void endContainer(char close) {
+        bool any = hasElements.back();
+        hasElements.pop_back();
+        if (any && format == OutputFormat::Pretty) indent();
+        out.put(close);
+    }
+
+    void packHeader(uint8_t fix, uint8_t fixLimit, uint8_t op16, size_t count) {
+        if (count < fixLimit) {
+            out.put(static_cast<char>(fix | count));
+        } else if (count <= 0xFFFF) {
+            out.put(static_cast<char>(op16));
+            packBigEndian(count, 2);
+        } else {
+            out.put(static_cast<char>(op16 + 1));
+            packBigEndian(count, 4);
+        }
+    }
+
+    void packBigEndian(uint64_t v, int bytes) {
+        for (int i = bytes - 1; i >= 0; i--) out.put(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+
+    void writeEscaped(std::string_view s) {
+        out.put('"');
+        for (unsigned char c : s) {
+            switch (c) {
+                case '"':  out.write("\\\"", 2); break;
+                case '\\': out.write("\\\\", 2); break;
+                case '\n': out.write("\\n", 2); break;
+                case '\r': out.write("\\r", 2); break;
+                case '\t': out.write("\\t", 2); break;
+                case '\b': out.write("\\b", 2); break;
+                case '\f': out.write("\\f", 2); break;
+                default:
+                    if (c < 0x20) {
+                        static const char hex[] = "0123456789abcdef";
+                        char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                        out.write(esc, 6);
+                    } else {
+                        out.put(static_cast<char>(c));
+                    }
+            }
+        }
+        out.put('"');
+    }
+
+public:
+    RecordWriter(BufferedWriter& writer, OutputFormat fmt) : out(writer), format(fmt) {}
+
+    OutputFormat outputFormat() const { return format; }
+
+    void beginObject(size_t count = 0) {
+        if (format == OutputFormat::MsgPack) { packHeader(0x80, 16, 0xde, count); return; }
+        beginElement();
+        out.put('{');
+        hasElements.push_back(false);
+    }
+
+    void endObject() {
+        if (format != OutputFormat::MsgPack) endContainer('}');
+    }
+
+    void beginArray(size_t count = 0) {
+        if (format == OutputFormat::MsgPack) { packHeader(0x90, 16, 0xdc, count); return; }
+        beginElement();
+        out.put('[');
+        hasElements.push_back(false);
+    }
+
+    void endArray() {
+        if (format != OutputFormat::MsgPack) endContainer(']');
+    }
+
+    void key(std::string_view k) {
+        if (format == OutputFormat::MsgPack) { value(k); return; }
+        beginElement();
+        writeEscaped(k);
+        if (format == OutputFormat::Pretty) out.write(": ", 2);
+        else out.put(':');
+        afterKey = true;
+    }
+
+    // JSON object keys are strings, so integer keys are written as text
+    void key(int64_t k) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), k);
+        key(std::string_view(buf, res.ptr - buf));
+    }
+
+    void value(int64_t v) {
+        if (format == OutputFormat::MsgPack) {
+            if (v >= 0 && v < 128) { out.put(static_cast<char>(v)); }
+            else if (v >= 0 && v <= 0xFFFFFFFFLL) { out.put(static_cast<char>(0xce)); packBigEndian(v, 4); }
+            else { out.put(static_cast<char>(0xd3)); packBigEndian(static_cast<uint64_t>(v), 8); }
+            return;
+        }
+        beginElement();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out.write(buf, res.ptr - buf);
+    }
+
+    void value(std::string_view s) {
+        if (format == OutputFormat::MsgPack) {
+            if (s.size() < 32) out.put(static_cast<char>(0xa0 | s.size()));
+            else if (s.size() <= 0xFF) { out.put(static_cast<char>(0xd9)); packBigEndian(s.size(), 1); }
+            else if (s.size() <= 0xFFFF) { out.put(static_cast<char>(0xda)); packBigEndian(s.size(), 2); }
+            else { out.put(static_cast<char>(0xdb)); packBigEndian(s.size(), 4); }
+            out.write(s);
+            return;
+        }
+        beginElement();
+        writeEscaped(s);
+    }
+};
+
+// -------------------- Output format flags --------------------
+// --compact and --binary may follow the positional arguments of a builder
+inline OutputFormat parseOutputFormat(int argc, char* argv[], int firstOption) {
+    OutputFormat fmt = OutputFormat::Pretty;
+    for (int i = firstOption; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt == "--compact") fmt = OutputFormat::Compact;
+        else if (opt == "--binary") fmt = OutputFormat::MsgPack;
+    }
+    return fmt;
+}
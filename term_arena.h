@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "unicode_text.h"
+
+// ----------------------------------------------------
+// Bump arena for term bytes
+// Allocation is a pointer increment inside 64 KiB blocks. reset() only
+// rewinds to the first block; the blocks themselves are reused, so a
+// warmed-up arena never touches the heap again.
+// ----------------------------------------------------
+class TermArena {
+private:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;
+
+    struct Block {
+        std::unique_ptr<char[]> bytes;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;         // block being filled
+    size_t used = 0;            // bytes used in that block
+
+public:
+    const char* store(std::string_view s) {
+        while (current < blocks.size() && used + s.size() > blocks[current].size) {
+            current++;
+            used = 0;
+        }
+        if (current == blocks.size()) {
+            size_t size = std::max(BLOCK_BYTES, s.size());
+            blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+            used = 0;
+        }
+        char* p = blocks[current].bytes.get() + used;
+        std::memcpy(p, s.data(), s.size());
+        used += s.size();
+        return p;
+    }
+
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+    size_t reservedBytes() const {
+        size_t total = 0;
+        for (auto& b : blocks) total += b.size;
+        return total;
+    }
+};
+
+inline uint64_t hashTerm(std::string_view s) {
+    uint64_t h = 0xCBF29CE484222325ull;    // FNV-1a
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h ^ (h >> 29);
+}
+
+// ----------------------------------------------------
+// Open-addressing hash map from interned terms to values
+//
+// Keys are string_views into the map's own arena, so lookups take any
+// string_view (no std::string is built to search). Linear probing over
+// a power-of-two table; every slot carries the epoch it was written in,
+// so reset() empties the map in O(1) by bumping the epoch. Iteration
+// follows insertion order.
+// ----------------------------------------------------
+template <typename Value>
+class FlatTermMap {
+private:
+    struct Slot {
+        const char* key = nullptr;
+        uint32_t length = 0;
+        uint32_t epoch = 0;
+        uint64_t hash = 0;
+        Value value{};
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> order;    // occupied slots, insertion order
+    uint32_t epoch = 1;
+    size_t mask = 0;
+    TermArena arena;
+
+    size_t probe(std::string_view key, uint64_t hash) const {
+        size_t i = hash & mask;
+        while (slots[i].epoch == epoch) {
+            if (slots[i].hash == hash && slots[i].length == key.size() &&
+                std::memcmp(slots[i].key, key.data(), key.size()) == 0)
+                return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(old.empty() ? 64 : old.size() * 2);
+        mask = slots.size() - 1;
+        for (uint32_t& index : order) {
+            Slot& s = old[index];
+            size_t i = s.hash & mask;
+            while (slots[i].epoch == epoch) i = (i + 1) & mask;
+            slots[i] = std::move(s);
+            index = static_cast<uint32_t>(i);
+        }
+    }
+
+public:
+    FlatTermMap() { grow(); }
+
+    // Value for key, value-initialized on first use
+    Value& operator[](std::string_view key) {
+        if ((order.size() + 1) * 4 > slots.size() * 3) grow();
+        uint64_t hash = hashTerm(key);
+        size_t i = probe(key, hash);
+        Slot& s = slots[i];
+        if (s.epoch != epoch) {
+            s.key    = arena.store(key);
+            s.length = static_cast<uint32_t>(key.size());
+            s.epoch  = epoch;
+            s.hash   = hash;
+            s.value  = Value{};
+            order.push_back(static_cast<uint32_t>(i));
+        }
+        return s.value;
+    }
+
+    const Value* find(std::string_view key) const {
+        size_t i = probe(key, hashTerm(key));
+        return slots[i].epoch == epoch ? &slots[i].value : nullptr;
+    }
+
+    size_t size() const { return order.size(); }
+    bool empty() const { return order.empty(); }
+
+    // Slots, insertion order and key bytes; a Value's own heap is not counted
+    size_t memoryBytes() const {
+        return slots.capacity() * sizeof(Slot) + order.capacity() * sizeof(uint32_t) + arena.reservedBytes();
+    }
+
+    // O(1): stale slots are recognised by their epoch
+    void reset() {
+        order.clear();
+        arena.reset();
+        if (++epoch == 0) { // wrapped: stale epochs could collide again
+            for (auto& s : slots) s.epoch = 0;
+            epoch = 1;
+        }
+    }
+
+    // -------------------- Iteration --------------------
+    class iterator {
+    private:
+        FlatTermMap* map;
+        size_t pos;
+    public:
+        iterator(FlatTermMap* m, size_t p) : map(m), pos(p) {}
+        std::pair<std::string_view, Value&> operator*() const {
+            Slot& s = map->slots[map->order[pos]];
+            return {std::string_view(s.key, s.length), s.value};
+        }
+        iterator& operator++() { pos++; return *this; }
+        bool operator!=(const iterator& other) const { return pos != other.pos; }
+    };
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, order.size()); }
+};
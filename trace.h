@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+// ----------------------------------------------------
+// Span tracing in Chrome trace-event format
+//
+// A TraceSpan records its begin timestamp and duration when it goes out
+// of scope. The event goes into a ring buffer owned by the recording
+// thread. Only that thread writes its ring, so recording takes no lock
+// and no atomic read-modify-write. When a ring is full the oldest events
+// are overwritten and counted as dropped.
+//
+// Tracing is off until Tracer::start(). While it is off, a span costs a
+// single relaxed load and branch, so spans can stay in hot loops.
+//
+// Tracer::write() emits { "traceEvents": [...] } with complete ("X")
+// events and thread names. The file opens in ui.perfetto.dev or
+// chrome://tracing. Call it after the traced threads have finished.
+// ----------------------------------------------------
+struct TraceEvent {
+    const char* name = nullptr;     // string literals only
+    const char* category = nullptr;
+    uint64_t start = 0;             // ns since Tracer::start()
+    uint64_t duration = 0;
+    char detail[96];                // e.g. the document path; tail kept if longer,
+                                    // which may split a UTF-8 sequence
+};
+
+class TraceRing {
+private:
+    std::vector<TraceEvent> events;
+    size_t mask;
+    std::atomic<uint64_t> head{0};
+
+public:
+    uint32_t tid;
+    std::string threadName;
+
+    // capacity is rounded up to a power of two
+    TraceRing(size_t capacity, uint32_t id) : tid(id) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        events.resize(n);
+        mask = n - 1;
+    }
+
+    void push(const TraceEvent& e) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & mask] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    uint64_t recorded() const { return head.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return recorded() > events.size() ? recorded() - events.size() : 0; }
+
+    // Surviving events, oldest first
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        uint64_t h = recorded();
+        for (uint64_t i = h - std::min<uint64_t>(h, events.size()); i < h; i++) fn(events[i & mask]);
+    }
+};
+
+class Tracer {
+private:
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point origin;
+    size_t ringCapacity = 1 << 16;
+    std::mutex lock;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+
+public:
+    // Events kept per thread, sizeof(TraceEvent) each: 128 bytes with
+    // 64-bit pointers, so 125 KiB per 1000 events and 8 MiB at the default
+    void start(size_t eventsPerThread = 1 << 16) {
+        ringCapacity = eventsPerThread;
+        origin = std::chrono::steady_clock::now();
+        enabled.store(true, std::memory_order_release);
+    }
+
+    bool active() const { return enabled.load(std::memory_order_relaxed); }
+
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // The calling thread's ring, registered on its first event
+    TraceRing& ring() {
+        thread_local TraceRing* mine = nullptr;
+        if (!mine) {
+            std::lock_guard<std::mutex> guard(lock);
+            rings.push_back(std::make_unique<TraceRing>(ringCapacity, (uint32_t)rings.size() + 1));
+            mine = rings.back().get();
+            mine->threadName = mine->tid == 1 ? "main" : "thread " + std::to_string(mine->tid);
+        }
+        return *mine;
+    }
+
+    // Label for the calling thread in the trace viewer
+    void nameThread(const std::string& name) {
+        if (active()) ring().threadName = name;
+    }
+
+    bool write(const std::string& path, uint64_t* eventsWritten = nullptr, uint64_t* eventsDropped = nullptr) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::ofstream out(path);
+        if (!out) return false;
+
+        uint64_t written = 0, dropped = 0;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        auto separate = [&]() { out << (first ? "" : ",\n"); first = false; };
+        for (auto& r : rings) {
+            separate();
+            out << nlohmann::json{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", r->tid},
+                                  {"args", {{"name", r->threadName}}}}.dump();
+            r->forEach([&](const TraceEvent& e) {
+                separate();
+                char head[160];
+                std::snprintf(head, sizeof(head),
+                              "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                              e.name, e.category, r->tid, e.start / 1e3, e.duration / 1e3);
+                out << head;
+                if (e.detail[0]) out << ",\"args\":{\"detail\":" << nlohmann::json(e.detail).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << "}";
+                out << "}";
+                written++;
+            });
+            dropped += r->dropped();
+        }
+        out << "\n]}\n";
+        if (eventsWritten) *eventsWritten = written;
+        if (eventsDropped) *eventsDropped = dropped;
+        return static_cast<bool>(out);
+    }
+};
+
+inline Tracer& tracer() {
+    static Tracer instance;
+    return instance;
+}
+
+// -------------------- Scoped span --------------------
+class TraceSpan {
+private:
+    TraceEvent event;
+    bool recording;
+
+public:
+    explicit TraceSpan(const char* name, const char* category = "build")
+        : recording(tracer().active()) {
+        if (!recording) return;
+        event.name = name;
+        event.category = category;
+        event.detail[0] = '\0';
+        event.start = tracer().now();
+    }
+
+    TraceSpan(const char* name, const char* category, const std::string& detail)
+        : TraceSpan(name, category) {
+        if (!recording) return;
+        size_t n = std::min(detail.size(), sizeof(event.detail) - 1);
+        std::memcpy(event.detail, detail.data() + detail.size() - n, n);
+        event.detail[n] = '\0';
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    ~TraceSpan() { end(); }
+
+    void end() {
+        if (!recording) return;
+        event.duration = tracer().now() - event.start;
+        tracer().ring().push(event);
+        recording = false;
+    }
+};
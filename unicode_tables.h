@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cstdint>
+
+// ----------------------------------------------------
+// Character tables for the tokenizer (unicode_text.h)
+//
+// Generated from the Unicode 14.0.0 character database:
+//  - UNICODE_SEPARATORS: code points from U+0080 up that end a word,
+//    i.e. punctuation, symbols, spaces, controls, surrogates and private
+//    use (P*, S*, Z*, C* but Cn). Soft hyphen, word joiner and BOM are
+//    IGNORABLE: skipped without splitting the word. Letters, marks,
+//    numbers, ZWJ/ZWNJ and unassigned code points are word characters.
+//  - UNICODE_CASE_FOLDS: simple case folding (CaseFolding.txt C+S) as
+//    runs of one delta, stride 2 for alternating upper/lower pairs;
+//    U+0130 folds to 'i'.
+//  - UNICODE_ACCENT_BASES: for folded Latin and Greek letters, the base
+//    letter of their canonical decomposition when the rest is
+//    combining marks, plus the stroked letters (ø ł đ ħ ŧ ı ...). A base
+//    of 0 drops a combining mark.
+// ----------------------------------------------------
+
+enum UnicodeRangeKind : uint8_t { SEPARATOR = 1, IGNORABLE = 2 };
+
+struct UnicodeRange {
+    uint32_t first, last;
+    UnicodeRangeKind kind;
+};
+
+struct UnicodeFold {
+    uint32_t first, last;
+    int32_t delta;
+    uint32_t stride;
+};
+
+struct UnicodeBase {
+    uint16_t code, base;
+};
+
+static const UnicodeRange UNICODE_SEPARATORS[] = {
+    {0x0080, 0x00A9, SEPARATOR}, {0x00AB, 0x00AC, SEPARATOR}, {0x00AD, 0x00AD, IGNORABLE}, {0x00AE, 0x00B1, SEPARATOR},
+    {0x00B4, 0x00B4, SEPARATOR}, {0x00B6, 0x00B8, SEPARATOR}, {0x00BB, 0x00BB, SEPARATOR}, {0x00BF, 0x00BF, SEPARATOR},
+    {0x00D7, 0x00D7, SEPARATOR}, {0x00F7, 0x00F7, SEPARATOR}, {0x02C2, 0x02C5, SEPARATOR}, {0x02D2, 0x02DF, SEPARATOR},
+    {0x02E5, 0x02EB, SEPARATOR}, {0x02ED, 0x02ED, SEPARATOR}, {0x02EF, 0x02FF, SEPARATOR}, {0x0375, 0x0375, SEPARATOR},
+    {0x037E, 0x037E, SEPARATOR}, {0x0384, 0x0385, SEPARATOR}, {0x0387, 0x0387, SEPARATOR}, {0x03F6, 0x03F6, SEPARATOR},
+    {0x0482, 0x0482, SEPARATOR}, {0x055A, 0x055F, SEPARATOR}, {0x0589, 0x058A, SEPARATOR}, {0x058D, 0x058F, SEPARATOR},
+    {0x05BE, 0x05BE, SEPARATOR}, {0x05C0, 0x05C0, SEPARATOR}, {0x05C3, 0x05C3, SEPARATOR}, {0x05C6, 0x05C6, SEPARATOR},
+    {0x05F3, 0x05F4, SEPARATOR}, {0x0600, 0x060F, SEPARATOR}, {0x061B, 0x061F, SEPARATOR}, {0x066A, 0x066D, SEPARATOR},
+    {0x06D4, 0x06D4, SEPARATOR}, {0x06DD, 0x06DE, SEPARATOR}, {0x06E9, 0x06E9, SEPARATOR}, {0x06FD, 0x06FE, SEPARATOR},
+    {0x0700, 0x070D, SEPARATOR}, {0x070F, 0x070F, SEPARATOR}, {0x07F6, 0x07F9, SEPARATOR}, {0x07FE, 0x07FF, SEPARATOR},
+    {0x0830, 0x083E, SEPARATOR}, {0x085E, 0x085E, SEPARATOR}, {0x0888, 0x0888, SEPARATOR}, {0x0890, 0x0891, SEPARATOR},
+    {0x08E2, 0x08E2, SEPARATOR}, {0x0964, 0x0965, SEPARATOR}, {0x0970, 0x0970, SEPARATOR}, {0x09F2, 0x09F3, SEPARATOR},
+    {0x09FA, 0x09FB, SEPARATOR}, {0x09FD, 0x09FD, SEPARATOR}, {0x0A76, 0x0A76, SEPARATOR}, {0x0AF0, 0x0AF1, SEPARATOR},
+    {0x0B70, 0x0B70, SEPARATOR}, {0x0BF3, 0x0BFA, SEPARATOR}, {0x0C77, 0x0C77, SEPARATOR}, {0x0C7F, 0x0C7F, SEPARATOR},
+    {0x0C84, 0x0C84, SEPARATOR}, {0x0D4F, 0x0D4F, SEPARATOR}, {0x0D79, 0x0D79, SEPARATOR}, {0x0DF4, 0x0DF4, SEPARATOR},
+    {0x0E3F, 0x0E3F, SEPARATOR}, {0x0E4F, 0x0E4F, SEPARATOR}, {0x0E5A, 0x0E5B, SEPARATOR}, {0x0F01, 0x0F17, SEPARATOR},
+    {0x0F1A, 0x0F1F, SEPARATOR}, {0x0F34, 0x0F34, SEPARATOR}, {0x0F36, 0x0F36, SEPARATOR}, {0x0F38, 0x0F38, SEPARATOR},
+    {0x0F3A, 0x0F3D, SEPARATOR}, {0x0F85, 0x0F85, SEPARATOR}, {0x0FBE, 0x0FC5, SEPARATOR}, {0x0FC7, 0x0FCC, SEPARATOR},
+    {0x0FCE, 0x0FDA, SEPARATOR}, {0x104A, 0x104F, SEPARATOR}, {0x109E, 0x109F, SEPARATOR}, {0x10FB, 0x10FB, SEPARATOR},
+    {0x1360, 0x1368, SEPARATOR}, {0x1390, 0x1399, SEPARATOR}, {0x1400, 0x1400, SEPARATOR}, {0x166D, 0x166E, SEPARATOR},
+    {0x1680, 0x1680, SEPARATOR}, {0x169B, 0x169C, SEPARATOR}, {0x16EB, 0x16ED, SEPARATOR}, {0x1735, 0x1736, SEPARATOR},
+    {0x17D4, 0x17D6, SEPARATOR}, {0x17D8, 0x17DB, SEPARATOR}, {0x1800, 0x180A, SEPARATOR}, {0x180E, 0x180E, SEPARATOR},
+    {0x1940, 0x1940, SEPARATOR}, {0x1944, 0x1945, SEPARATOR}, {0x19DE, 0x19FF, SEPARATOR}, {0x1A1E, 0x1A1F, SEPARATOR},
+    {0x1AA0, 0x1AA6, SEPARATOR}, {0x1AA8, 0x1AAD, SEPARATOR}, {0x1B5A, 0x1B6A, SEPARATOR}, {0x1B74, 0x1B7E, SEPARATOR},
+    {0x1BFC, 0x1BFF, SEPARATOR}, {0x1C3B, 0x1C3F, SEPARATOR}, {0x1C7E, 0x1C7F, SEPARATOR}, {0x1CC0, 0x1CC7, SEPARATOR},
+    {0x1CD3, 0x1CD3, SEPARATOR}, {0x1FBD, 0x1FBD, SEPARATOR}, {0x1FBF, 0x1FC1, SEPARATOR}, {0x1FCD, 0x1FCF, SEPARATOR},
+    {0x1FDD, 0x1FDF, SEPARATOR}, {0x1FED, 0x1FEF, SEPARATOR}, {0x1FFD, 0x1FFE, SEPARATOR}, {0x2000, 0x200B, SEPARATOR},
+    {0x200E, 0x205F, SEPARATOR}, {0x2060, 0x2060, IGNORABLE}, {0x2061, 0x2064, SEPARATOR}, {0x2066, 0x206F, SEPARATOR},
+    {0x207A, 0x207E, SEPARATOR}, {0x208A, 0x208E, SEPARATOR}, {0x20A0, 0x20C0, SEPARATOR}, {0x2100, 0x2101, SEPARATOR},
+    {0x2103, 0x2106, SEPARATOR}, {0x2108, 0x2109, SEPARATOR}, {0x2114, 0x2114, SEPARATOR}, {0x2116, 0x2118, SEPARATOR},
+    {0x211E, 0x2123, SEPARATOR}, {0x2125, 0x2125, SEPARATOR}, {0x2127, 0x2127, SEPARATOR}, {0x2129, 0x2129, SEPARATOR},
+    {0x212E, 0x212E, SEPARATOR}, {0x213A, 0x213B, SEPARATOR}, {0x2140, 0x2144, SEPARATOR}, {0x214A, 0x214D, SEPARATOR},
+    {0x214F, 0x214F, SEPARATOR}, {0x218A, 0x218B, SEPARATOR}, {0x2190, 0x2426, SEPARATOR}, {0x2440, 0x244A, SEPARATOR},
+    {0x249C, 0x24E9, SEPARATOR}, {0x2500, 0x2775, SEPARATOR}, {0x2794, 0x2B73, SEPARATOR}, {0x2B76, 0x2B95, SEPARATOR},
+    {0x2B97, 0x2BFF, SEPARATOR}, {0x2CE5, 0x2CEA, SEPARATOR}, {0x2CF9, 0x2CFC, SEPARATOR}, {0x2CFE, 0x2CFF, SEPARATOR},
+    {0x2D70, 0x2D70, SEPARATOR}, {0x2E00, 0x2E2E, SEPARATOR}, {0x2E30, 0x2E5D, SEPARATOR}, {0x2E80, 0x2E99, SEPARATOR},
+    {0x2E9B, 0x2EF3, SEPARATOR}, {0x2F00, 0x2FD5, SEPARATOR}, {0x2FF0, 0x2FFB, SEPARATOR}, {0x3000, 0x3004, SEPARATOR},
+    {0x3008, 0x3020, SEPARATOR}, {0x3030, 0x3030, SEPARATOR}, {0x3036, 0x3037, SEPARATOR}, {0x303D, 0x303F, SEPARATOR},
+    {0x309B, 0x309C, SEPARATOR}, {0x30A0, 0x30A0, SEPARATOR}, {0x30FB, 0x30FB, SEPARATOR}, {0x3190, 0x3191, SEPARATOR},
+    {0x3196, 0x319F, SEPARATOR}, {0x31C0, 0x31E3, SEPARATOR}, {0x3200, 0x321E, SEPARATOR}, {0x322A, 0x3247, SEPARATOR},
+    {0x3250, 0x3250, SEPARATOR}, {0x3260, 0x327F, SEPARATOR}, {0x328A, 0x32B0, SEPARATOR}, {0x32C0, 0x33FF, SEPARATOR},
+    {0x4DC0, 0x4DFF, SEPARATOR}, {0xA490, 0xA4C6, SEPARATOR}, {0xA4FE, 0xA4FF, SEPARATOR}, {0xA60D, 0xA60F, SEPARATOR},
+    {0xA673, 0xA673, SEPARATOR}, {0xA67E, 0xA67E, SEPARATOR}, {0xA6F2, 0xA6F7, SEPARATOR}, {0xA700, 0xA716, SEPARATOR},
+    {0xA720, 0xA721, SEPARATOR}, {0xA789, 0xA78A, SEPARATOR}, {0xA828, 0xA82B, SEPARATOR}, {0xA836, 0xA839, SEPARATOR},
+    {0xA874, 0xA877, SEPARATOR}, {0xA8CE, 0xA8CF, SEPARATOR}, {0xA8F8, 0xA8FA, SEPARATOR}, {0xA8FC, 0xA8FC, SEPARATOR},
+    {0xA92E, 0xA92F, SEPARATOR}, {0xA95F, 0xA95F, SEPARATOR}, {0xA9C1, 0xA9CD, SEPARATOR}, {0xA9DE, 0xA9DF, SEPARATOR},
+    {0xAA5C, 0xAA5F, SEPARATOR}, {0xAA77, 0xAA79, SEPARATOR}, {0xAADE, 0xAADF, SEPARATOR}, {0xAAF0, 0xAAF1, SEPARATOR},
+    {0xAB5B, 0xAB5B, SEPARATOR}, {0xAB6A, 0xAB6B, SEPARATOR}, {0xABEB, 0xABEB, SEPARATOR}, {0xD800, 0xF8FF, SEPARATOR},
+    {0xFB29, 0xFB29, SEPARATOR}, {0xFBB2, 0xFBC2, SEPARATOR}, {0xFD3E, 0xFD4F, SEPARATOR}, {0xFDCF, 0xFDCF, SEPARATOR},
+    {0xFDFC, 0xFDFF, SEPARATOR}, {0xFE10, 0xFE19, SEPARATOR}, {0xFE30, 0xFE52, SEPARATOR}, {0xFE54, 0xFE66, SEPARATOR},
+    {0xFE68, 0xFE6B, SEPARATOR}, {0xFEFF, 0xFEFF, IGNORABLE}, {0xFF01, 0xFF0F, SEPARATOR}, {0xFF1A, 0xFF20, SEPARATOR},
+    {0xFF3B, 0xFF40, SEPARATOR}, {0xFF5B, 0xFF65, SEPARATOR}, {0xFFE0, 0xFFE6, SEPARATOR}, {0xFFE8, 0xFFEE, SEPARATOR},
+    {0xFFF9, 0xFFFD, SEPARATOR}, {0x10100, 0x10102, SEPARATOR}, {0x10137, 0x1013F, SEPARATOR}, {0x10179, 0x10189, SEPARATOR},
+    {0x1018C, 0x1018E, SEPARATOR}, {0x10190, 0x1019C, SEPARATOR}, {0x101A0, 0x101A0, SEPARATOR}, {0x101D0, 0x101FC, SEPARATOR},
+    {0x1039F, 0x1039F, SEPARATOR}, {0x103D0, 0x103D0, SEPARATOR}, {0x1056F, 0x1056F, SEPARATOR}, {0x10857, 0x10857, SEPARATOR},
+    {0x10877, 0x10878, SEPARATOR}, {0x1091F, 0x1091F, SEPARATOR}, {0x1093F, 0x1093F, SEPARATOR}, {0x10A50, 0x10A58, SEPARATOR},
+    {0x10A7F, 0x10A7F, SEPARATOR}, {0x10AC8, 0x10AC8, SEPARATOR}, {0x10AF0, 0x10AF6, SEPARATOR}, {0x10B39, 0x10B3F, SEPARATOR},
+    {0x10B99, 0x10B9C, SEPARATOR}, {0x10EAD, 0x10EAD, SEPARATOR}, {0x10F55, 0x10F59, SEPARATOR}, {0x10F86, 0x10F89, SEPARATOR},
+    {0x11047, 0x1104D, SEPARATOR}, {0x110BB, 0x110C1, SEPARATOR}, {0x110CD, 0x110CD, SEPARATOR}, {0x11140, 0x11143, SEPARATOR},
+    {0x11174, 0x11175, SEPARATOR}, {0x111C5, 0x111C8, SEPARATOR}, {0x111CD, 0x111CD, SEPARATOR}, {0x111DB, 0x111DB, SEPARATOR},
+    {0x111DD, 0x111DF, SEPARATOR}, {0x11238, 0x1123D, SEPARATOR}, {0x112A9, 0x112A9, SEPARATOR}, {0x1144B, 0x1144F, SEPARATOR},
+    {0x1145A, 0x1145B, SEPARATOR}, {0x1145D, 0x1145D, SEPARATOR}, {0x114C6, 0x114C6, SEPARATOR}, {0x115C1, 0x115D7, SEPARATOR},
+    {0x11641, 0x11643, SEPARATOR}, {0x11660, 0x1166C, SEPARATOR}, {0x116B9, 0x116B9, SEPARATOR}, {0x1173C, 0x1173F, SEPARATOR},
+    {0x1183B, 0x1183B, SEPARATOR}, {0x11944, 0x11946, SEPARATOR}, {0x119E2, 0x119E2, SEPARATOR}, {0x11A3F, 0x11A46, SEPARATOR},
+    {0x11A9A, 0x11A9C, SEPARATOR}, {0x11A9E, 0x11AA2, SEPARATOR}, {0x11C41, 0x11C45, SEPARATOR}, {0x11C70, 0x11C71, SEPARATOR},
+    {0x11EF7, 0x11EF8, SEPARATOR}, {0x11FD5, 0x11FF1, SEPARATOR}, {0x11FFF, 0x11FFF, SEPARATOR}, {0x12470, 0x12474, SEPARATOR},
+    {0x12FF1, 0x12FF2, SEPARATOR}, {0x13430, 0x13438, SEPARATOR}, {0x16A6E, 0x16A6F, SEPARATOR}, {0x16AF5, 0x16AF5, SEPARATOR},
+    {0x16B37, 0x16B3F, SEPARATOR}, {0x16B44, 0x16B45, SEPARATOR}, {0x16E97, 0x16E9A, SEPARATOR}, {0x16FE2, 0x16FE2, SEPARATOR},
+    {0x1BC9C, 0x1BC9C, SEPARATOR}, {0x1BC9F, 0x1BCA3, SEPARATOR}, {0x1CF50, 0x1CFC3, SEPARATOR}, {0x1D000, 0x1D0F5, SEPARATOR},
+    {0x1D100, 0x1D126, SEPARATOR}, {0x1D129, 0x1D164, SEPARATOR}, {0x1D16A, 0x1D16C, SEPARATOR}, {0x1D173, 0x1D17A, SEPARATOR},
+    {0x1D183, 0x1D184, SEPARATOR}, {0x1D18C, 0x1D1A9, SEPARATOR}, {0x1D1AE, 0x1D1EA, SEPARATOR}, {0x1D200, 0x1D241, SEPARATOR},
+    {0x1D245, 0x1D245, SEPARATOR}, {0x1D300, 0x1D356, SEPARATOR}, {0x1D6C1, 0x1D6C1, SEPARATOR}, {0x1D6DB, 0x1D6DB, SEPARATOR},
+    {0x1D6FB, 0x1D6FB, SEPARATOR}, {0x1D715, 0x1D715, SEPARATOR}, {0x1D735, 0x1D735, SEPARATOR}, {0x1D74F, 0x1D74F, SEPARATOR},
+    {0x1D76F, 0x1D76F, SEPARATOR}, {0x1D789, 0x1D789, SEPARATOR}, {0x1D7A9, 0x1D7A9, SEPARATOR}, {0x1D7C3, 0x1D7C3, SEPARATOR},
+    {0x1D800, 0x1D9FF, SEPARATOR}, {0x1DA37, 0x1DA3A, SEPARATOR}, {0x1DA6D, 0x1DA74, SEPARATOR}, {0x1DA76, 0x1DA83, SEPARATOR},
+    {0x1DA85, 0x1DA8B, SEPARATOR}, {0x1E14F, 0x1E14F, SEPARATOR}, {0x1E2FF, 0x1E2FF, SEPARATOR}, {0x1E95E, 0x1E95F, SEPARATOR},
+    {0x1ECAC, 0x1ECAC, SEPARATOR}, {0x1ECB0, 0x1ECB0, SEPARATOR}, {0x1ED2E, 0x1ED2E, SEPARATOR}, {0x1EEF0, 0x1EEF1, SEPARATOR},
+    {0x1F000, 0x1F02B, SEPARATOR}, {0x1F030, 0x1F093, SEPARATOR}, {0x1F0A0, 0x1F0AE, SEPARATOR}, {0x1F0B1, 0x1F0BF, SEPARATOR},
+    {0x1F0C1, 0x1F0CF, SEPARATOR}, {0x1F0D1, 0x1F0F5, SEPARATOR}, {0x1F10D, 0x1F1AD, SEPARATOR}, {0x1F1E6, 0x1F202, SEPARATOR},
+    {0x1F210, 0x1F23B, SEPARATOR}, {0x1F240, 0x1F248, SEPARATOR}, {0x1F250, 0x1F251, SEPARATOR}, {0x1F260, 0x1F265, SEPARATOR},
+    {0x1F300, 0x1F6D7, SEPARATOR}, {0x1F6DD, 0x1F6EC, SEPARATOR}, {0x1F6F0, 0x1F6FC, SEPARATOR}, {0x1F700, 0x1F773, SEPARATOR},
+    {0x1F780, 0x1F7D8, SEPARATOR}, {0x1F7E0, 0x1F7EB, SEPARATOR}, {0x1F7F0, 0x1F7F0, SEPARATOR}, {0x1F800, 0x1F80B, SEPARATOR},
+    {0x1F810, 0x1F847, SEPARATOR}, {0x1F850, 0x1F859, SEPARATOR}, {0x1F860, 0x1F887, SEPARATOR}, {0x1F890, 0x1F8AD, SEPARATOR},
+    {0x1F8B0, 0x1F8B1, SEPARATOR}, {0x1F900, 0x1FA53, SEPARATOR}, {0x1FA60, 0x1FA6D, SEPARATOR}, {0x1FA70, 0x1FA74, SEPARATOR},
+    {0x1FA78, 0x1FA7C, SEPARATOR}, {0x1FA80, 0x1FA86, SEPARATOR}, {0x1FA90, 0x1FAAC, SEPARATOR}, {0x1FAB0, 0x1FABA, SEPARATOR},
+    {0x1FAC0, 0x1FAC5, SEPARATOR}, {0x1FAD0, 0x1FAD9, SEPARATOR}, {0x1FAE0, 0x1FAE7, SEPARATOR}, {0x1FAF0, 0x1FAF6, SEPARATOR},
+    {0x1FB00, 0x1FB92, SEPARATOR}, {0x1FB94, 0x1FBCA, SEPARATOR}, {0xE0001, 0xE0001, SEPARATOR}, {0xE0020, 0xE007F, SEPARATOR},
+    {0xF0000, 0xFFFFD, SEPARATOR}, {0x100000, 0x10FFFD, SEPARATOR},
+};
+static const UnicodeFold UNICODE_CASE_FOLDS[] = {
+    {0x00B5, 0x00B5, 775, 1}, {0x00C0, 0x00D6, 32, 1}, {0x00D8, 0x00DE, 32, 1},
+    {0x0100, 0x012E, 1, 2}, {0x0130, 0x0130, -199, 1}, {0x0132, 0x0136, 1, 2},
+    {0x0139, 0x0147, 1, 2}, {0x014A, 0x0176, 1, 2}, {0x0178, 0x0178, -121, 1},
+    {0x0179, 0x017D, 1, 2}, {0x017F, 0x017F, -268, 1}, {0x0181, 0x0181, 210, 1},
+    {0x0182, 0x0184, 1, 2}, {0x0186, 0x0186, 206, 1}, {0x0187, 0x0187, 1, 1},
+    {0x0189, 0x018A, 205, 1}, {0x018B, 0x018B, 1, 1}, {0x018E, 0x018E, 79, 1},
+    {0x018F, 0x018F, 202, 1}, {0x0190, 0x0190, 203, 1}, {0x0191, 0x0191, 1, 1},
+    {0x0193, 0x0193, 205, 1}, {0x0194, 0x0194, 207, 1}, {0x0196, 0x0196, 211, 1},
+    {0x0197, 0x0197, 209, 1}, {0x0198, 0x0198, 1, 1}, {0x019C, 0x019C, 211, 1},
+    {0x019D, 0x019D, 213, 1}, {0x019F, 0x019F, 214, 1}, {0x01A0, 0x01A4, 1, 2},
+    {0x01A6, 0x01A6, 218, 1}, {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 218, 1},
+    {0x01AC, 0x01AC, 1, 1}, {0x01AE, 0x01AE, 218, 1}, {0x01AF, 0x01AF, 1, 1},
+    {0x01B1, 0x01B2, 217, 1}, {0x01B3, 0x01B5, 1, 2}, {0x01B7, 0x01B7, 219, 1},
+    {0x01B8, 0x01B8, 1, 1}, {0x01BC, 0x01BC, 1, 1}, {0x01C4, 0x01C4, 2, 1},
+    {0x01C5, 0x01C5, 1, 1}, {0x01C7, 0x01C7, 2, 1}, {0x01C8, 0x01C8, 1, 1},
+    {0x01CA, 0x01CA, 2, 1}, {0x01CB, 0x01DB, 1, 2}, {0x01DE, 0x01EE, 1, 2},
+    {0x01F1, 0x01F1, 2, 1}, {0x01F2, 0x01F4, 1, 2}, {0x01F6, 0x01F6, -97, 1},
+    {0x01F7, 0x01F7, -56, 1}, {0x01F8, 0x021E, 1, 2}, {0x0220, 0x0220, -130, 1},
+    {0x0222, 0x0232, 1, 2}, {0x023A, 0x023A, 10795, 1}, {0x023B, 0x023B, 1, 1},
+    {0x023D, 0x023D, -163, 1}, {0x023E, 0x023E, 10792, 1}, {0x0241, 0x0241, 1, 1},
+    {0x0243, 0x0243, -195, 1}, {0x0244, 0x0244, 69, 1}, {0x0245, 0x0245, 71, 1},
+    {0x0246, 0x024E, 1, 2}, {0x0345, 0x0345, 116, 1}, {0x0370, 0x0372, 1, 2},
+    {0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 116, 1}, {0x0386, 0x0386, 38, 1},
+    {0x0388, 0x038A, 37, 1}, {0x038C, 0x038C, 64, 1}, {0x038E, 0x038F, 63, 1},
+    {0x0391, 0x03A1, 32, 1}, {0x03A3, 0x03AB, 32, 1}, {0x03C2, 0x03C2, 1, 1},
+    {0x03CF, 0x03CF, 8, 1}, {0x03D0, 0x03D0, -30, 1}, {0x03D1, 0x03D1, -25, 1},
+    {0x03D5, 0x03D5, -15, 1}, {0x03D6, 0x03D6, -22, 1}, {0x03D8, 0x03EE, 1, 2},
+    {0x03F0, 0x03F0, -54, 1}, {0x03F1, 0x03F1, -48, 1}, {0x03F4, 0x03F4, -60, 1},
+    {0x03F5, 0x03F5, -64, 1}, {0x03F7, 0x03F7, 1, 1}, {0x03F9, 0x03F9, -7, 1},
+    {0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, -130, 1}, {0x0400, 0x040F, 80, 1},
+    {0x0410, 0x042F, 32, 1}, {0x0460, 0x0480, 1, 2}, {0x048A, 0x04BE, 1, 2},
+    {0x04C0, 0x04C0, 15, 1}, {0x04C1, 0x04CD, 1, 2}, {0x04D0, 0x052E, 1, 2},
+    {0x0531, 0x0556, 48, 1}, {0x10A0, 0x10C5, 7264, 1}, {0x10C7, 0x10C7, 7264, 1},
+    {0x10CD, 0x10CD, 7264, 1}, {0x13F8, 0x13FD, -8, 1}, {0x1C80, 0x1C80, -6222, 1},
+    {0x1C81, 0x1C81, -6221, 1}, {0x1C82, 0x1C82, -6212, 1}, {0x1C83, 0x1C84, -6210, 1},
+    {0x1C85, 0x1C85, -6211, 1}, {0x1C86, 0x1C86, -6204, 1}, {0x1C87, 0x1C87, -6180, 1},
+    {0x1C88, 0x1C88, 35267, 1}, {0x1C90, 0x1CBA, -3008, 1}, {0x1CBD, 0x1CBF, -3008, 1},
+    {0x1E00, 0x1E94, 1, 2}, {0x1E9B, 0x1E9B, -58, 1}, {0x1E9E, 0x1E9E, -7615, 1},
+    {0x1EA0, 0x1EFE, 1, 2}, {0x1F08, 0x1F0F, -8, 1}, {0x1F18, 0x1F1D, -8, 1},
+    {0x1F28, 0x1F2F, -8, 1}, {0x1F38, 0x1F3F, -8, 1}, {0x1F48, 0x1F4D, -8, 1},
+    {0x1F59, 0x1F5F, -8, 2}, {0x1F68, 0x1F6F, -8, 1}, {0x1F88, 0x1F8F, -8, 1},
+    {0x1F98, 0x1F9F, -8, 1}, {0x1FA8, 0x1FAF, -8, 1}, {0x1FB8, 0x1FB9, -8, 1},
+    {0x1FBA, 0x1FBB, -74, 1}, {0x1FBC, 0x1FBC, -9, 1}, {0x1FBE, 0x1FBE, -7173, 1},
+    {0x1FC8, 0x1FCB, -86, 1}, {0x1FCC, 0x1FCC, -9, 1}, {0x1FD8, 0x1FD9, -8, 1},
+    {0x1FDA, 0x1FDB, -100, 1}, {0x1FE8, 0x1FE9, -8, 1}, {0x1FEA, 0x1FEB, -112, 1},
+    {0x1FEC, 0x1FEC, -7, 1}, {0x1FF8, 0x1FF9, -128, 1}, {0x1FFA, 0x1FFB, -126, 1},
+    {0x1FFC, 0x1FFC, -9, 1}, {0x2126, 0x2126, -7517, 1}, {0x212A, 0x212A, -8383, 1},
+    {0x212B, 0x212B, -8262, 1}, {0x2132, 0x2132, 28, 1}, {0x2160, 0x216F, 16, 1},
+    {0x2183, 0x2183, 1, 1}, {0x24B6, 0x24CF, 26, 1}, {0x2C00, 0x2C2F, 48, 1},
+    {0x2C60, 0x2C60, 1, 1}, {0x2C62, 0x2C62, -10743, 1}, {0x2C63, 0x2C63, -3814, 1},
+    {0x2C64, 0x2C64, -10727, 1}, {0x2C67, 0x2C6B, 1, 2}, {0x2C6D, 0x2C6D, -10780, 1},
+    {0x2C6E, 0x2C6E, -10749, 1}, {0x2C6F, 0x2C6F, -10783, 1}, {0x2C70, 0x2C70, -10782, 1},
+    {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, -10815, 1},
+    {0x2C80, 0x2CE2, 1, 2}, {0x2CEB, 0x2CED, 1, 2}, {0x2CF2, 0x2CF2, 1, 1},
+    {0xA640, 0xA66C, 1, 2}, {0xA680, 0xA69A, 1, 2}, {0xA722, 0xA72E, 1, 2},
+    {0xA732, 0xA76E, 1, 2}, {0xA779, 0xA77B, 1, 2}, {0xA77D, 0xA77D, -35332, 1},
+    {0xA77E, 0xA786, 1, 2}, {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, -42280, 1},
+    {0xA790, 0xA792, 1, 2}, {0xA796, 0xA7A8, 1, 2}, {0xA7AA, 0xA7AA, -42308, 1},
+    {0xA7AB, 0xA7AB, -42319, 1}, {0xA7AC, 0xA7AC, -42315, 1}, {0xA7AD, 0xA7AD, -42305, 1},
+    {0xA7AE, 0xA7AE, -42308, 1}, {0xA7B0, 0xA7B0, -42258, 1}, {0xA7B1, 0xA7B1, -42282, 1},
+    {0xA7B2, 0xA7B2, -42261, 1}, {0xA7B3, 0xA7B3, 928, 1}, {0xA7B4, 0xA7C2, 1, 2},
+    {0xA7C4, 0xA7C4, -48, 1}, {0xA7C5, 0xA7C5, -42307, 1}, {0xA7C6, 0xA7C6, -35384, 1},
+    {0xA7C7, 0xA7C9, 1, 2}, {0xA7D0, 0xA7D0, 1, 1}, {0xA7D6, 0xA7D8, 1, 2},
+    {0xA7F5, 0xA7F5, 1, 1}, {0xAB70, 0xABBF, -38864, 1}, {0xFF21, 0xFF3A, 32, 1},
+    {0x10400, 0x10427, 40, 1}, {0x104B0, 0x104D3, 40, 1}, {0x10570, 0x1057A, 39, 1},
+    {0x1057C, 0x1058A, 39, 1}, {0x1058C, 0x10592, 39, 1}, {0x10594, 0x10595, 39, 1},
+    {0x10C80, 0x10CB2, 64, 1}, {0x118A0, 0x118BF, 32, 1}, {0x16E40, 0x16E5F, 32, 1},
+    {0x1E900, 0x1E921, 34, 1},
+};
+static const UnicodeBase UNICODE_ACCENT_BASES[] = {
+    {0x00E0, 0x0061}, {0x00E1, 0x0061}, {0x00E2, 0x0061}, {0x00E3, 0x0061}, {0x00E4, 0x0061}, {0x00E5, 0x0061},
+    {0x00E7, 0x0063}, {0x00E8, 0x0065}, {0x00E9, 0x0065}, {0x00EA, 0x0065}, {0x00EB, 0x0065}, {0x00EC, 0x0069},
+    {0x00ED, 0x0069}, {0x00EE, 0x0069}, {0x00EF, 0x0069}, {0x00F1, 0x006E}, {0x00F2, 0x006F}, {0x00F3, 0x006F},
+    {0x00F4, 0x006F}, {0x00F5, 0x006F}, {0x00F6, 0x006F}, {0x00F8, 0x006F}, {0x00F9, 0x0075}, {0x00FA, 0x0075},
+    {0x00FB, 0x0075}, {0x00FC, 0x0075}, {0x00FD, 0x0079}, {0x00FF, 0x0079}, {0x0101, 0x0061}, {0x0103, 0x0061},
+    {0x0105, 0x0061}, {0x0107, 0x0063}, {0x0109, 0x0063}, {0x010B, 0x0063}, {0x010D, 0x0063}, {0x010F, 0x0064},
+    {0x0111, 0x0064}, {0x0113, 0x0065}, {0x0115, 0x0065}, {0x0117, 0x0065}, {0x0119, 0x0065}, {0x011B, 0x0065},
+    {0x011D, 0x0067}, {0x011F, 0x0067}, {0x0121, 0x0067}, {0x0123, 0x0067}, {0x0125, 0x0068}, {0x0127, 0x0068},
+    {0x0129, 0x0069}, {0x012B, 0x0069}, {0x012D, 0x0069}, {0x012F, 0x0069}, {0x0131, 0x0069}, {0x0135, 0x006A},
+    {0x0137, 0x006B}, {0x013A, 0x006C}, {0x013C, 0x006C}, {0x013E, 0x006C}, {0x0142, 0x006C}, {0x0144, 0x006E},
+    {0x0146, 0x006E}, {0x0148, 0x006E}, {0x014D, 0x006F}, {0x014F, 0x006F}, {0x0151, 0x006F}, {0x0155, 0x0072},
+    {0x0157, 0x0072}, {0x0159, 0x0072}, {0x015B, 0x0073}, {0x015D, 0x0073}, {0x015F, 0x0073}, {0x0161, 0x0073},
+    {0x0163, 0x0074}, {0x0165, 0x0074}, {0x0167, 0x0074}, {0x0169, 0x0075}, {0x016B, 0x0075}, {0x016D, 0x0075},
+    {0x016F, 0x0075}, {0x0171, 0x0075}, {0x0173, 0x0075}, {0x0175, 0x0077}, {0x0177, 0x0079}, {0x017A, 0x007A},
+    {0x017C, 0x007A}, {0x017E, 0x007A}, {0x0180, 0x0062}, {0x01A1, 0x006F}, {0x01B0, 0x0075}, {0x01B6, 0x007A},
+    {0x01CE, 0x0061}, {0x01D0, 0x0069}, {0x01D2, 0x006F}, {0x01D4, 0x0075}, {0x01D6, 0x0075}, {0x01D8, 0x0075},
+    {0x01DA, 0x0075}, {0x01DC, 0x0075}, {0x01DF, 0x0061}, {0x01E1, 0x0061}, {0x01E3, 0x00E6}, {0x01E7, 0x0067},
+    {0x01E9, 0x006B}, {0x01EB, 0x006F}, {0x01ED, 0x006F}, {0x01EF, 0x0292}, {0x01F0, 0x006A}, {0x01F5, 0x0067},
+    {0x01F9, 0x006E}, {0x01FB, 0x0061}, {0x01FD, 0x00E6}, {0x01FF, 0x00F8}, {0x0201, 0x0061}, {0x0203, 0x0061},
+    {0x0205, 0x0065}, {0x0207, 0x0065}, {0x0209, 0x0069}, {0x020B, 0x0069}, {0x020D, 0x006F}, {0x020F, 0x006F},
+    {0x0211, 0x0072}, {0x0213, 0x0072}, {0x0215, 0x0075}, {0x0217, 0x0075}, {0x0219, 0x0073}, {0x021B, 0x0074},
+    {0x021F, 0x0068}, {0x0227, 0x0061}, {0x0229, 0x0065}, {0x022B, 0x006F}, {0x022D, 0x006F}, {0x022F, 0x006F},
+    {0x0231, 0x006F}, {0x0233, 0x0079}, {0x0268, 0x0069}, {0x0289, 0x0075}, {0x0300, 0x0000}, {0x0301, 0x0000},
+    {0x0302, 0x0000}, {0x0303, 0x0000}, {0x0304, 0x0000}, {0x0305, 0x0000}, {0x0306, 0x0000}, {0x0307, 0x0000},
+    {0x0308, 0x0000}, {0x0309, 0x0000}, {0x030A, 0x0000}, {0x030B, 0x0000}, {0x030C, 0x0000}, {0x030D, 0x0000},
+    {0x030E, 0x0000}, {0x030F, 0x0000}, {0x0310, 0x0000}, {0x0311, 0x0000}, {0x0312, 0x0000}, {0x0313, 0x0000},
+    {0x0314, 0x0000}, {0x0315, 0x0000}, {0x0316, 0x0000}, {0x0317, 0x0000}, {0x0318, 0x0000}, {0x0319, 0x0000},
+    {0x031A, 0x0000}, {0x031B, 0x0000}, {0x031C, 0x0000}, {0x031D, 0x0000}, {0x031E, 0x0000}, {0x031F, 0x0000},
+    {0x0320, 0x0000}, {0x0321, 0x0000}, {0x0322, 0x0000}, {0x0323, 0x0000}, {0x0324, 0x0000}, {0x0325, 0x0000},
+    {0x0326, 0x0000}, {0x0327, 0x0000}, {0x0328, 0x0000}, {0x0329, 0x0000}, {0x032A, 0x0000}, {0x032B, 0x0000},
+    {0x032C, 0x0000}, {0x032D, 0x0000}, {0x032E, 0x0000}, {0x032F, 0x0000}, {0x0330, 0x0000}, {0x0331, 0x0000},
+    {0x0332, 0x0000}, {0x0333, 0x0000}, {0x0334, 0x0000}, {0x0335, 0x0000}, {0x0336, 0x0000}, {0x0337, 0x0000},
+    {0x0338, 0x0000}, {0x0339, 0x0000}, {0x033A, 0x0000}, {0x033B, 0x0000}, {0x033C, 0x0000}, {0x033D, 0x0000},
+    {0x033E, 0x0000}, {0x033F, 0x0000}, {0x0340, 0x0000}, {0x0341, 0x0000}, {0x0342, 0x0000}, {0x0343, 0x0000},
+    {0x0344, 0x0000}, {0x0345, 0x0000}, {0x0346, 0x0000}, {0x0347, 0x0000}, {0x0348, 0x0000}, {0x0349, 0x0000},
+    {0x034A, 0x0000}, {0x034B, 0x0000}, {0x034C, 0x0000}, {0x034D, 0x0000}, {0x034E, 0x0000}, {0x034F, 0x0000},
+    {0x0350, 0x0000}, {0x0351, 0x0000}, {0x0352, 0x0000}, {0x0353, 0x0000}, {0x0354, 0x0000}, {0x0355, 0x0000},
+    {0x0356, 0x0000}, {0x0357, 0x0000}, {0x0358, 0x0000}, {0x0359, 0x0000}, {0x035A, 0x0000}, {0x035B, 0x0000},
+    {0x035C, 0x0000}, {0x035D, 0x0000}, {0x035E, 0x0000}, {0x035F, 0x0000}, {0x0360, 0x0000}, {0x0361, 0x0000},
+    {0x0362, 0x0000}, {0x0363, 0x0000}, {0x0364, 0x0000}, {0x0365, 0x0000}, {0x0366, 0x0000}, {0x0367, 0x0000},
+    {0x0368, 0x0000}, {0x0369, 0x0000}, {0x036A, 0x0000}, {0x036B, 0x0000}, {0x036C, 0x0000}, {0x036D, 0x0000},
+    {0x036E, 0x0000}, {0x036F, 0x0000}, {0x0390, 0x03B9}, {0x03AC, 0x03B1}, {0x03AD, 0x03B5}, {0x03AE, 0x03B7},
+    {0x03AF, 0x03B9}, {0x03B0, 0x03C5}, {0x03CA, 0x03B9}, {0x03CB, 0x03C5}, {0x03CC, 0x03BF}, {0x03CD, 0x03C5},
+    {0x03CE, 0x03C9}, {0x03D3, 0x03D2}, {0x03D4, 0x03D2}, {0x1AB0, 0x0000}, {0x1AB1, 0x0000}, {0x1AB2, 0x0000},
+    {0x1AB3, 0x0000}, {0x1AB4, 0x0000}, {0x1AB5, 0x0000}, {0x1AB6, 0x0000}, {0x1AB7, 0x0000}, {0x1AB8, 0x0000},
+    {0x1AB9, 0x0000}, {0x1ABA, 0x0000}, {0x1ABB, 0x0000}, {0x1ABC, 0x0000}, {0x1ABD, 0x0000}, {0x1ABF, 0x0000},
+    {0x1AC0, 0x0000}, {0x1AC1, 0x0000}, {0x1AC2, 0x0000}, {0x1AC3, 0x0000}, {0x1AC4, 0x0000}, {0x1AC5, 0x0000},
+    {0x1AC6, 0x0000}, {0x1AC7, 0x0000}, {0x1AC8, 0x0000}, {0x1AC9, 0x0000}, {0x1ACA, 0x0000}, {0x1ACB, 0x0000},
+    {0x1ACC, 0x0000}, {0x1ACD, 0x0000}, {0x1ACE, 0x0000}, {0x1DC0, 0x0000}, {0x1DC1, 0x0000}, {0x1DC2, 0x0000},
+    {0x1DC3, 0x0000}, {0x1DC4, 0x0000}, {0x1DC5, 0x0000}, {0x1DC6, 0x0000}, {0x1DC7, 0x0000}, {0x1DC8, 0x0000},
+    {0x1DC9, 0x0000}, {0x1DCA, 0x0000}, {0x1DCB, 0x0000}, {0x1DCC, 0x0000}, {0x1DCD, 0x0000}, {0x1DCE, 0x0000},
+    {0x1DCF, 0x0000}, {0x1DD0, 0x0000}, {0x1DD1, 0x0000}, {0x1DD2, 0x0000}, {0x1DD3, 0x0000}, {0x1DD4, 0x0000},
+    {0x1DD5, 0x0000}, {0x1DD6, 0x0000}, {0x1DD7, 0x0000}, {0x1DD8, 0x0000}, {0x1DD9, 0x0000}, {0x1DDA, 0x0000},
+    {0x1DDB, 0x0000}, {0x1DDC, 0x0000}, {0x1DDD, 0x0000}, {0x1DDE, 0x0000}, {0x1DDF, 0x0000}, {0x1DE0, 0x0000},
+    {0x1DE1, 0x0000}, {0x1DE2, 0x0000}, {0x1DE3, 0x0000}, {0x1DE4, 0x0000}, {0x1DE5, 0x0000}, {0x1DE6, 0x0000},
+    {0x1DE7, 0x0000}, {0x1DE8, 0x0000}, {0x1DE9, 0x0000}, {0x1DEA, 0x0000}, {0x1DEB, 0x0000}, {0x1DEC, 0x0000},
+    {0x1DED, 0x0000}, {0x1DEE, 0x0000}, {0x1DEF, 0x0000}, {0x1DF0, 0x0000}, {0x1DF1, 0x0000}, {0x1DF2, 0x0000},
+    {0x1DF3, 0x0000}, {0x1DF4, 0x0000}, {0x1DF5, 0x0000}, {0x1DF6, 0x0000}, {0x1DF7, 0x0000}, {0x1DF8, 0x0000},
+    {0x1DF9, 0x0000}, {0x1DFA, 0x0000}, {0x1DFB, 0x0000}, {0x1DFC, 0x0000}, {0x1DFD, 0x0000}, {0x1DFE, 0x0000},
+    {0x1DFF, 0x0000}, {0x1E01, 0x0061}, {0x1E03, 0x0062}, {0x1E05, 0x0062}, {0x1E07, 0x0062}, {0x1E09, 0x0063},
+    {0x1E0B, 0x0064}, {0x1E0D, 0x0064}, {0x1E0F, 0x0064}, {0x1E11, 0x0064}, {0x1E13, 0x0064}, {0x1E15, 0x0065},
+    {0x1E17, 0x0065}, {0x1E19, 0x0065}, {0x1E1B, 0x0065}, {0x1E1D, 0x0065}, {0x1E1F, 0x0066}, {0x1E21, 0x0067},
+    {0x1E23, 0x0068}, {0x1E25, 0x0068}, {0x1E27, 0x0068}, {0x1E29, 0x0068}, {0x1E2B, 0x0068}, {0x1E2D, 0x0069},
+    {0x1E2F, 0x0069}, {0x1E31, 0x006B}, {0x1E33, 0x006B}, {0x1E35, 0x006B}, {0x1E37, 0x006C}, {0x1E39, 0x006C},
+    {0x1E3B, 0x006C}, {0x1E3D, 0x006C}, {0x1E3F, 0x006D}, {0x1E41, 0x006D}, {0x1E43, 0x006D}, {0x1E45, 0x006E},
+    {0x1E47, 0x006E}, {0x1E49, 0x006E}, {0x1E4B, 0x006E}, {0x1E4D, 0x006F}, {0x1E4F, 0x006F}, {0x1E51, 0x006F},
+    {0x1E53, 0x006F}, {0x1E55, 0x0070}, {0x1E57, 0x0070}, {0x1E59, 0x0072}, {0x1E5B, 0x0072}, {0x1E5D, 0x0072},
+    {0x1E5F, 0x0072}, {0x1E61, 0x0073}, {0x1E63, 0x0073}, {0x1E65, 0x0073}, {0x1E67, 0x0073}, {0x1E69, 0x0073},
+    {0x1E6B, 0x0074}, {0x1E6D, 0x0074}, {0x1E6F, 0x0074}, {0x1E71, 0x0074}, {0x1E73, 0x0075}, {0x1E75, 0x0075},
+    {0x1E77, 0x0075}, {0x1E79, 0x0075}, {0x1E7B, 0x0075}, {0x1E7D, 0x0076}, {0x1E7F, 0x0076}, {0x1E81, 0x0077},
+    {0x1E83, 0x0077}, {0x1E85, 0x0077}, {0x1E87, 0x0077}, {0x1E89, 0x0077}, {0x1E8B, 0x0078}, {0x1E8D, 0x0078},
+    {0x1E8F, 0x0079}, {0x1E91, 0x007A}, {0x1E93, 0x007A}, {0x1E95, 0x007A}, {0x1E96, 0x0068}, {0x1E97, 0x0074},
+    {0x1E98, 0x0077}, {0x1E99, 0x0079}, {0x1E9B, 0x0073}, {0x1EA1, 0x0061}, {0x1EA3, 0x0061}, {0x1EA5, 0x0061},
+    {0x1EA7, 0x0061}, {0x1EA9, 0x0061}, {0x1EAB, 0x0061}, {0x1EAD, 0x0061}, {0x1EAF, 0x0061}, {0x1EB1, 0x0061},
+    {0x1EB3, 0x0061}, {0x1EB5, 0x0061}, {0x1EB7, 0x0061}, {0x1EB9, 0x0065}, {0x1EBB, 0x0065}, {0x1EBD, 0x0065},
+    {0x1EBF, 0x0065}, {0x1EC1, 0x0065}, {0x1EC3, 0x0065}, {0x1EC5, 0x0065}, {0x1EC7, 0x0065}, {0x1EC9, 0x0069},
+    {0x1ECB, 0x0069}, {0x1ECD, 0x006F}, {0x1ECF, 0x006F}, {0x1ED1, 0x006F}, {0x1ED3, 0x006F}, {0x1ED5, 0x006F},
+    {0x1ED7, 0x006F}, {0x1ED9, 0x006F}, {0x1EDB, 0x006F}, {0x1EDD, 0x006F}, {0x1EDF, 0x006F}, {0x1EE1, 0x006F},
+    {0x1EE3, 0x006F}, {0x1EE5, 0x0075}, {0x1EE7, 0x0075}, {0x1EE9, 0x0075}, {0x1EEB, 0x0075}, {0x1EED, 0x0075},
+    {0x1EEF, 0x0075}, {0x1EF1, 0x0075}, {0x1EF3, 0x0079}, {0x1EF5, 0x0079}, {0x1EF7, 0x0079}, {0x1EF9, 0x0079},
+    {0x1F00, 0x03B1}, {0x1F01, 0x03B1}, {0x1F02, 0x03B1}, {0x1F03, 0x03B1}, {0x1F04, 0x03B1}, {0x1F05, 0x03B1},
+    {0x1F06, 0x03B1}, {0x1F07, 0x03B1}, {0x1F10, 0x03B5}, {0x1F11, 0x03B5}, {0x1F12, 0x03B5}, {0x1F13, 0x03B5},
+    {0x1F14, 0x03B5}, {0x1F15, 0x03B5}, {0x1F20, 0x03B7}, {0x1F21, 0x03B7}, {0x1F22, 0x03B7}, {0x1F23, 0x03B7},
+    {0x1F24, 0x03B7}, {0x1F25, 0x03B7}, {0x1F26, 0x03B7}, {0x1F27, 0x03B7}, {0x1F30, 0x03B9}, {0x1F31, 0x03B9},
+    {0x1F32, 0x03B9}, {0x1F33, 0x03B9}, {0x1F34, 0x03B9}, {0x1F35, 0x03B9}, {0x1F36, 0x03B9}, {0x1F37, 0x03B9},
+    {0x1F40, 0x03BF}, {0x1F41, 0x03BF}, {0x1F42, 0x03BF}, {0x1F43, 0x03BF}, {0x1F44, 0x03BF}, {0x1F45, 0x03BF},
+    {0x1F50, 0x03C5}, {0x1F51, 0x03C5}, {0x1F52, 0x03C5}, {0x1F53, 0x03C5}, {0x1F54, 0x03C5}, {0x1F55, 0x03C5},
+    {0x1F56, 0x03C5}, {0x1F57, 0x03C5}, {0x1F60, 0x03C9}, {0x1F61, 0x03C9}, {0x1F62, 0x03C9}, {0x1F63, 0x03C9},
+    {0x1F64, 0x03C9}, {0x1F65, 0x03C9}, {0x1F66, 0x03C9}, {0x1F67, 0x03C9}, {0x1F70, 0x03B1}, {0x1F71, 0x03B1},
+    {0x1F72, 0x03B5}, {0x1F73, 0x03B5}, {0x1F74, 0x03B7}, {0x1F75, 0x03B7}, {0x1F76, 0x03B9}, {0x1F77, 0x03B9},
+    {0x1F78, 0x03BF}, {0x1F79, 0x03BF}, {0x1F7A, 0x03C5}, {0x1F7B, 0x03C5}, {0x1F7C, 0x03C9}, {0x1F7D, 0x03C9},
+    {0x1F80, 0x03B1}, {0x1F81, 0x03B1}, {0x1F82, 0x03B1}, {0x1F83, 0x03B1}, {0x1F84, 0x03B1}, {0x1F85, 0x03B1},
+    {0x1F86, 0x03B1}, {0x1F87, 0x03B1}, {0x1F90, 0x03B7}, {0x1F91, 0x03B7}, {0x1F92, 0x03B7}, {0x1F93, 0x03B7},
+    {0x1F94, 0x03B7}, {0x1F95, 0x03B7}, {0x1F96, 0x03B7}, {0x1F97, 0x03B7}, {0x1FA0, 0x03C9}, {0x1FA1, 0x03C9},
+    {0x1FA2, 0x03C9}, {0x1FA3, 0x03C9}, {0x1FA4, 0x03C9}, {0x1FA5, 0x03C9}, {0x1FA6, 0x03C9}, {0x1FA7, 0x03C9},
+    {0x1FB0, 0x03B1}, {0x1FB1, 0x03B1}, {0x1FB2, 0x03B1}, {0x1FB3, 0x03B1}, {0x1FB4, 0x03B1}, {0x1FB6, 0x03B1},
+    {0x1FB7, 0x03B1}, {0x1FC2, 0x03B7}, {0x1FC3, 0x03B7}, {0x1FC4, 0x03B7}, {0x1FC6, 0x03B7}, {0x1FC7, 0x03B7},
+    {0x1FD0, 0x03B9}, {0x1FD1, 0x03B9}, {0x1FD2, 0x03B9}, {0x1FD3, 0x03B9}, {0x1FD6, 0x03B9}, {0x1FD7, 0x03B9},
+    {0x1FE0, 0x03C5}, {0x1FE1, 0x03C5}, {0x1FE2, 0x03C5}, {0x1FE3, 0x03C5}, {0x1FE4, 0x03C1}, {0x1FE5, 0x03C1},
+    {0x1FE6, 0x03C5}, {0x1FE7, 0x03C5}, {0x1FF2, 0x03C9}, {0x1FF3, 0x03C9}, {0x1FF4, 0x03C9}, {0x1FF6, 0x03C9},
+    {0x1FF7, 0x03C9}, {0x20D0, 0x0000}, {0x20D1, 0x0000}, {0x20D2, 0x0000}, {0x20D3, 0x0000}, {0x20D4, 0x0000},
+    {0x20D5, 0x0000}, {0x20D6, 0x0000}, {0x20D7, 0x0000}, {0x20D8, 0x0000}, {0x20D9, 0x0000}, {0x20DA, 0x0000},
+    {0x20DB, 0x0000}, {0x20DC, 0x0000}, {0x20E1, 0x0000}, {0x20E5, 0x0000}, {0x20E6, 0x0000}, {0x20E7, 0x0000},
+    {0x20E8, 0x0000}, {0x20E9, 0x0000}, {0x20EA, 0x0000}, {0x20EB, 0x0000}, {0x20EC, 0x0000}, {0x20ED, 0x0000},
+    {0x20EE, 0x0000}, {0x20EF, 0x0000}, {0x20F0, 0x0000}, {0xFE20, 0x0000}, {0xFE21, 0x0000}, {0xFE22, 0x0000},
+    {0xFE23, 0x0000}, {0xFE24, 0x0000}, {0xFE25, 0x0000}, {0xFE26, 0x0000}, {0xFE27, 0x0000}, {0xFE28, 0x0000},
+    {0xFE29, 0x0000}, {0xFE2A, 0x0000}, {0xFE2B, 0x0000}, {0xFE2C, 0x0000}, {0xFE2D, 0x0000}, {0xFE2E, 0x0000},
+    {0xFE2F, 0x0000},
+};
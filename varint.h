@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// -------------------- Varints --------------------
+// LEB128: 7 bits per byte, high bit set on every byte but the last
+inline void putVarint(std::string& out, uint32_t v) {
+    while (v >= 0x80) { out.push_back(static_cast<char>(v | 0x80)); v >>= 7; }
+    out.push_back(static_cast<char>(v));
+}
+
+inline uint32_t getVarint(const char*& p) {
+    uint32_t v = 0;
+    int shift = 0;
+    while (static_cast<unsigned char>(*p) & 0x80) {
+        v |= (static_cast<unsigned char>(*p++) & 0x7F) << shift;
+        shift += 7;
+    }
+    v |= static_cast<unsigned char>(*p++) << shift;
+    return v;
+}